@@ -6,6 +6,7 @@
 #include "plugin/PluginMetaInformationFactory.h"
 #include "utils/ElfUtils.h"
 #include "utils/StringTools.h"
+#include "utils/storage/StorageUtils.h"
 #include "utils/utils.h"
 #include <coreinit/cache.h>
 #include <coreinit/dynload.h>
@@ -22,6 +23,10 @@ PluginManagement::loadPlugins(const std::set<std::shared_ptr<PluginData>> &plugi
 
         auto metaInfo = PluginMetaInformationFactory::loadPlugin(*pluginData, error);
         if (metaInfo && error == PLUGIN_PARSE_ERROR_NONE) {
+            if (metaInfo->getWUPSVersion() >= WUPSVersion(0, 8, 0)) {
+                // Read the storage in the background while the plugin gets loaded.
+                StorageUtils::API::Internal::PrefetchStorage(metaInfo->getStorageId());
+            }
             auto info = PluginInformationFactory::load(*pluginData, trampolineData, trampolineID++);
             if (!info) {
                 auto errMsg = string_format("Failed to load plugin: %s", pluginData->getSource().c_str());
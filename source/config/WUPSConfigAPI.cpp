@@ -8,84 +8,129 @@
 #include "plugin/PluginConfigData.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
-#include <algorithm>
 #include <memory>
-#include <vector>
+#include <mutex>
+#include <unordered_map>
 #include <wums/exports.h>
 #include <wups/config.h>
 #include <wups/config_api.h>
 
 namespace WUPSConfigAPIBackend {
-    std::vector<std::unique_ptr<WUPSConfig>> sConfigs;
-    std::mutex sConfigsMutex;
+    struct AddedCategory {
+        WUPSConfigCategory *category;
+        // Handle of the category or config the category has been added to
+        const void *parent;
+    };
+
+    // All maps are keyed by the handle (the address of the object) and protected by sHandlesMutex.
+    // Objects which haven't been added to a parent yet are owned by these maps.
+    std::unordered_map<const void *, std::unique_ptr<WUPSConfig>> sConfigs;
+    std::unordered_map<const void *, std::unique_ptr<WUPSConfigCategory>> sConfigCategories;
+    std::unordered_map<const void *, std::unique_ptr<WUPSConfigItem>> sConfigItems;
+    // Categories which have been added to a parent, owned by the parent.
+    std::unordered_map<const void *, AddedCategory> sAddedCategories;
+    std::mutex sHandlesMutex;
+
+    namespace {
+        /**
+         * Returns the config the category belongs to or nullptr if it's not (yet) part of a config in sConfigs.
+         * Expects sHandlesMutex to be locked.
+         */
+        WUPSConfig *FindRootConfig(const void *handle) {
+            // The depth is limited by the menu structure, so this is much cheaper than searching all configs.
+            for (auto itr = sAddedCategories.find(handle); itr != sAddedCategories.end(); itr = sAddedCategories.find(handle)) {
+                handle = itr->second.parent;
+            }
+            auto configItr = sConfigs.find(handle);
+            if (configItr == sConfigs.end()) {
+                return nullptr;
+            }
+            return configItr->second.get();
+        }
 
-    std::vector<std::unique_ptr<WUPSConfigCategory>> sConfigCategories;
-    std::mutex sConfigCategoryMutex;
+        /**
+         * Removes the children of a category from sAddedCategories, needs to be called when the category leaves the
+         * backend. Expects sHandlesMutex to be locked.
+         */
+        void RemoveAddedChildren(const WUPSConfigCategory &category) {
+            for (const auto &cat : category.getCategories()) {
+                RemoveAddedChildren(*cat);
+                sAddedCategories.erase(cat.get());
+            }
+        }
 
-    std::vector<std::unique_ptr<WUPSConfigItem>> sConfigItems;
-    std::mutex sConfigItemsMutex;
+        template<typename T>
+        std::unique_ptr<T> ExtractByHandle(std::unordered_map<const void *, std::unique_ptr<T>> &map, const void *handle) {
+            auto itr = map.find(handle);
+            if (itr == map.end()) {
+                return {};
+            }
+            auto res = std::move(itr->second);
+            map.erase(itr);
+            return res;
+        }
+    } // namespace
 
     namespace Intern {
         WUPSConfig *GetConfigByHandle(WUPSConfigHandle handle) {
-            std::lock_guard lock(sConfigsMutex);
-            auto itr = std::find_if(sConfigs.begin(), sConfigs.end(), [&handle](auto &cur) { return handle == cur.get(); });
+            std::lock_guard lock(sHandlesMutex);
+            auto itr = sConfigs.find(handle.handle);
             if (itr == sConfigs.end()) {
                 return nullptr;
             }
-            return itr->get();
+            return itr->second.get();
         }
 
         std::unique_ptr<WUPSConfig> PopConfigByHandle(WUPSConfigHandle handle) {
-            return pop_locked_first_if(sConfigsMutex, sConfigs, [&handle](auto &cur) { return handle == cur.get(); });
-        }
-
-        static WUPSConfigCategory *GetCategoryByHandleRecursive(WUPSConfigCategory *category, WUPSConfigCategoryHandle handle) {
-            if (handle == category) {
-                return category;
+            std::lock_guard lock(sHandlesMutex);
+            auto config = ExtractByHandle(sConfigs, handle.handle);
+            if (config) {
+                RemoveAddedChildren(*config);
             }
-            for (const auto &cat : category->getCategories()) {
-                auto res = GetCategoryByHandleRecursive(cat.get(), handle);
-                if (res) {
-                    return res;
-                }
-            }
-            return nullptr;
+            return config;
         }
 
         WUPSConfigCategory *GetCategoryByHandle(WUPSConfigCategoryHandle handle, bool checkRecursive) {
-            std::lock_guard lock(sConfigCategoryMutex);
-            auto itr = std::find_if(sConfigCategories.begin(), sConfigCategories.end(), [&handle](auto &cur) { return handle == cur.get(); });
-            if (itr == sConfigCategories.end()) {
-                if (checkRecursive) {
-                    std::lock_guard config_lock(sConfigsMutex);
-                    for (const auto &curConfig : sConfigs) {
-                        auto *category = Intern::GetCategoryByHandleRecursive(curConfig.get(), handle);
-                        if (category) {
-                            return category;
-                        }
-                    }
+            std::lock_guard lock(sHandlesMutex);
+            auto itr = sConfigCategories.find(handle.handle);
+            if (itr != sConfigCategories.end()) {
+                return itr->second.get();
+            }
+            if (checkRecursive) {
+                auto addedItr = sAddedCategories.find(handle.handle);
+                if (addedItr != sAddedCategories.end()) {
+                    return FindRootConfig(handle.handle) ? addedItr->second.category : nullptr;
+                }
+                // The root category of a config
+                auto configItr = sConfigs.find(handle.handle);
+                if (configItr != sConfigs.end()) {
+                    return configItr->second.get();
                 }
-                return nullptr;
             }
-            return itr->get();
+            return nullptr;
         }
 
-
         std::unique_ptr<WUPSConfigCategory> PopCategoryByHandle(WUPSConfigCategoryHandle handle) {
-            return pop_locked_first_if(sConfigCategoryMutex, sConfigCategories, [&handle](auto &cur) { return handle == cur.get(); });
+            std::lock_guard lock(sHandlesMutex);
+            auto category = ExtractByHandle(sConfigCategories, handle.handle);
+            if (category) {
+                RemoveAddedChildren(*category);
+            }
+            return category;
         }
 
         WUPSConfigItem *GetItemByHandle(WUPSConfigItemHandle handle) {
-            std::lock_guard lock(sConfigItemsMutex);
-            auto itr = std::find_if(sConfigItems.begin(), sConfigItems.end(), [&handle](auto &cur) { return handle == cur.get(); });
+            std::lock_guard lock(sHandlesMutex);
+            auto itr = sConfigItems.find(handle.handle);
             if (itr == sConfigItems.end()) {
                 return nullptr;
             }
-            return itr->get();
+            return itr->second.get();
         }
 
         std::unique_ptr<WUPSConfigItem> PopItemByHandle(WUPSConfigItemHandle handle) {
-            return pop_locked_first_if(sConfigItemsMutex, sConfigItems, [&handle](auto &cur) { return handle == cur.get(); });
+            std::lock_guard lock(sHandlesMutex);
+            return ExtractByHandle(sConfigItems, handle.handle);
         }
 
         WUPSConfigAPIStatus CreateConfig(const char *name, WUPSConfigHandle *out) {
@@ -99,16 +144,15 @@ namespace WUPSConfigAPIBackend {
                 DEBUG_FUNCTION_LINE_ERR("Failed to allocate WUPSConfig");
                 return WUPSCONFIG_API_RESULT_OUT_OF_MEMORY;
             }
-            std::lock_guard lock(sConfigsMutex);
+            std::lock_guard lock(sHandlesMutex);
             *out = WUPSConfigHandle(config.get());
-            sConfigs.push_back(std::move(config));
+            sConfigs[config.get()] = std::move(config);
             return WUPSCONFIG_API_RESULT_SUCCESS;
         }
 
         void CleanAllHandles() {
-            std::lock_guard lock(sConfigsMutex);
-            std::lock_guard lock1(sConfigCategoryMutex);
-            std::lock_guard lock2(sConfigItemsMutex);
+            std::lock_guard lock(sHandlesMutex);
+            sAddedCategories.clear();
             sConfigs.clear();
             sConfigCategories.clear();
             sConfigItems.clear();
@@ -135,7 +179,7 @@ namespace WUPSConfigAPIBackend {
      *         - WUPSCONFIG_API_RESULT_UNSUPPORTED_VERSION: The specified `options.version` is not supported.
      *         - WUPSCONFIG_API_RESULT_NOT_FOUND: The plugin with the given identifier was not found.
      */
-    WUPSConfigAPIStatus InitEx(uint32_t pluginIdentifier, WUPSConfigAPIOptions options, WUPSConfigAPI_MenuOpenedCallback openedCallback, WUPSConfigAPI_MenuClosedCallback closedCallback) {
+    WUPSConfigAPIStatus InitEx(uintptr_t pluginIdentifier, WUPSConfigAPIOptions options, WUPSConfigAPI_MenuOpenedCallback openedCallback, WUPSConfigAPI_MenuClosedCallback closedCallback) {
         if (openedCallback == nullptr || closedCallback == nullptr) {
             return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
         }
@@ -172,9 +216,9 @@ namespace WUPSConfigAPIBackend {
                 return WUPSCONFIG_API_RESULT_OUT_OF_MEMORY;
             }
 
-            std::lock_guard lock(sConfigCategoryMutex);
+            std::lock_guard lock(sHandlesMutex);
             *out = WUPSConfigCategoryHandle(category.get());
-            sConfigCategories.push_back(std::move(category));
+            sConfigCategories[category.get()] = std::move(category);
             return WUPSCONFIG_API_RESULT_SUCCESS;
         }
 
@@ -184,17 +228,17 @@ namespace WUPSConfigAPIBackend {
                 return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
             }
 
-            if (!remove_locked_first_if(sConfigCategoryMutex, sConfigCategories, [&handle](auto &cur) { return handle == cur.get(); })) {
-                {
-                    // Ignore any attempts to destroy the root item.
-                    std::lock_guard lock(sConfigsMutex);
-                    if (std::any_of(sConfigs.begin(), sConfigs.end(), [&handle](auto &cur) { return handle == cur.get(); })) {
-                        return WUPSCONFIG_API_RESULT_SUCCESS;
-                    }
+            std::lock_guard lock(sHandlesMutex);
+            auto category = ExtractByHandle(sConfigCategories, handle.handle);
+            if (!category) {
+                // Ignore any attempts to destroy the root item.
+                if (sConfigs.contains(handle.handle)) {
+                    return WUPSCONFIG_API_RESULT_SUCCESS;
                 }
                 DEBUG_FUNCTION_LINE_WARN("Failed to destroy WUPSConfigCategory (for handle: \"%08X\")", handle.handle);
                 return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
+            RemoveAddedChildren(*category);
             return WUPSCONFIG_API_RESULT_SUCCESS;
         }
 
@@ -203,28 +247,35 @@ namespace WUPSConfigAPIBackend {
                 DEBUG_FUNCTION_LINE("Invalid param: \"parentHandle\" or \"categoryHandle\" was NULL");
                 return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
             }
-            std::lock_guard lockConfigs(sConfigsMutex);
-            std::lock_guard lockCats(sConfigCategoryMutex);
-            WUPSConfigCategory *parentCat = Intern::GetConfigByHandle(WUPSConfigHandle(parentHandle.handle));
-            if (!parentCat) {
-                parentCat = Intern::GetCategoryByHandle(parentHandle);
-                if (!parentCat) {
-                    DEBUG_FUNCTION_LINE_WARN("Failed to find parent for handle %08X", parentHandle.handle);
-                    return WUPSCONFIG_API_RESULT_NOT_FOUND;
-                }
+            if (parentHandle.handle == categoryHandle.handle) {
+                DEBUG_FUNCTION_LINE_WARN("Can't add category %08X to itself", categoryHandle.handle);
+                return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
+            }
+            std::lock_guard lock(sHandlesMutex);
+            WUPSConfigCategory *parentCat = nullptr;
+            if (auto configItr = sConfigs.find(parentHandle.handle); configItr != sConfigs.end()) {
+                parentCat = configItr->second.get();
+            } else if (auto catItr = sConfigCategories.find(parentHandle.handle); catItr != sConfigCategories.end()) {
+                parentCat = catItr->second.get();
+            } else {
+                DEBUG_FUNCTION_LINE_WARN("Failed to find parent for handle %08X", parentHandle.handle);
+                return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
 
-            auto category = Intern::PopCategoryByHandle(categoryHandle);
+            // The children of the category stay registered, they are moved along with it.
+            auto category = ExtractByHandle(sConfigCategories, categoryHandle.handle);
             if (!category) {
                 DEBUG_FUNCTION_LINE_WARN("Failed to find category. parentHandle: %08X categoryHandle: %08X", parentHandle.handle, categoryHandle.handle);
                 return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
 
+            auto *categoryPtr = category.get();
             if (!parentCat->addCategory(category)) {
-                sConfigCategories.push_back(std::move(category));
+                sConfigCategories[categoryPtr] = std::move(category);
                 DEBUG_FUNCTION_LINE_WARN("Failed to add category to parent. parentHandle: %08X categoryHandle: %08X", parentHandle.handle, categoryHandle.handle);
                 return WUPSCONFIG_API_RESULT_UNKNOWN_ERROR; // TODO!!!
             }
+            sAddedCategories[categoryPtr] = {.category = categoryPtr, .parent = parentHandle.handle};
             return WUPSCONFIG_API_RESULT_SUCCESS;
         }
 
@@ -234,26 +285,28 @@ namespace WUPSConfigAPIBackend {
                 return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
             }
 
-            std::lock_guard lockConfigs(sConfigsMutex);
-            std::lock_guard lockCats(sConfigCategoryMutex);
-            WUPSConfigCategory *parentCat = Intern::GetConfigByHandle(WUPSConfigHandle(parentHandle.handle));
-            if (!parentCat) {
-                parentCat = Intern::GetCategoryByHandle(parentHandle, true);
-                if (!parentCat) {
-                    DEBUG_FUNCTION_LINE_WARN("Failed to find parent for handle %08X", parentHandle.handle);
-                    return WUPSCONFIG_API_RESULT_NOT_FOUND;
-                }
+            std::lock_guard lock(sHandlesMutex);
+            WUPSConfigCategory *parentCat = nullptr;
+            if (auto configItr = sConfigs.find(parentHandle.handle); configItr != sConfigs.end()) {
+                parentCat = configItr->second.get();
+            } else if (auto catItr = sConfigCategories.find(parentHandle.handle); catItr != sConfigCategories.end()) {
+                parentCat = catItr->second.get();
+            } else if (auto addedItr = sAddedCategories.find(parentHandle.handle); addedItr != sAddedCategories.end() && FindRootConfig(parentHandle.handle)) {
+                parentCat = addedItr->second.category;
+            } else {
+                DEBUG_FUNCTION_LINE_WARN("Failed to find parent for handle %08X", parentHandle.handle);
+                return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
 
-            auto item = Intern::PopItemByHandle(itemHandle);
+            auto item = ExtractByHandle(sConfigItems, itemHandle.handle);
             if (!item) {
                 DEBUG_FUNCTION_LINE_ERR("Failed to get item for handle %08X", itemHandle.handle);
                 return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
 
+            auto *itemPtr = item.get();
             if (!parentCat->addItem(item)) {
-                std::lock_guard lockItems(sConfigItemsMutex);
-                sConfigItems.push_back(std::move(item));
+                sConfigItems[itemPtr] = std::move(item);
                 DEBUG_FUNCTION_LINE_ERR("Failed to add item %08X to category %08X", itemHandle.handle, parentHandle.handle);
                 return WUPSCONFIG_API_RESULT_UNKNOWN_ERROR; // TODO
             }
@@ -283,9 +336,9 @@ namespace WUPSConfigAPIBackend {
                 DEBUG_FUNCTION_LINE_ERR("Failed to allocate WUPSConfigItem");
                 return WUPSCONFIG_API_RESULT_OUT_OF_MEMORY;
             }
-            std::lock_guard lock(sConfigItemsMutex);
+            std::lock_guard lock(sHandlesMutex);
             *out = WUPSConfigItemHandle(item.get());
-            sConfigItems.push_back(std::move(item));
+            sConfigItems[item.get()] = std::move(item);
             return WUPSCONFIG_API_RESULT_SUCCESS;
         }
 
@@ -295,7 +348,7 @@ namespace WUPSConfigAPIBackend {
                 return WUPSCONFIG_API_RESULT_INVALID_ARGUMENT;
             }
 
-            if (!remove_locked_first_if(sConfigItemsMutex, sConfigItems, [&handle](auto &cur) { return cur.get() == handle; })) {
+            if (!Intern::PopItemByHandle(handle)) {
                 DEBUG_FUNCTION_LINE_WARN("Failed to destroy WUPSConfigItem (handle: \"%08X\")", handle);
                 return WUPSCONFIG_API_RESULT_NOT_FOUND;
             }
@@ -10,21 +10,22 @@ namespace WUPSConfigAPIBackend {
         /**
          * @brief Retrieves a WUPSConfig pointer based on a given handle.
          *
-         * This function searches for a WUPSConfig within a list of WUPSConfig objects based on a handle.
+         * This function looks up a WUPSConfig by its handle.
          * If a matching handle is found, a pointer to the WUPSConfig object is returned. Otherwise, nullptr is returned.
          *
          * @param handle The handle used to identify the desired WUPSConfig object.
          * @return A pointer to the WUPSConfig object with the matching handle, or nullptr if not found.
          *
-         * @note This function locks the sConfigsMutex during the search operation to ensure thread safety.
+         * @note This function locks the sHandlesMutex during the lookup to ensure thread safety.
          */
         WUPSConfig *GetConfigByHandle(WUPSConfigHandle handle);
 
         /**
-         * @brief Pop a WUPSConfig object from the sConfigs vector based on the provided handle.
+         * @brief Pop a WUPSConfig object from the sConfigs map based on the provided handle.
          *
-         * This function retrieves a WUPSConfig object from the sConfigs vector based on the given handle.
-         * It locks the sConfigsMutex to ensure thread safety during the operation.
+         * This function retrieves a WUPSConfig object from the sConfigs map based on the given handle.
+         * The categories of the config can't be found via GetCategoryByHandle afterwards.
+         * It locks the sHandlesMutex to ensure thread safety during the operation.
          *
          * @param handle The handle of the WUPSConfig object to be retrieved.
          * @return A std::unique_ptr to the WUPSConfig object if found, nullptr otherwise.
@@ -35,8 +36,9 @@ namespace WUPSConfigAPIBackend {
          * @brief Get a WUPSConfigCategory object by its handle
          *
          * This function searches for a WUPSConfigCategory object with the given handle.
-         * If the 'checkRecursive' flag is set to true, the function also searches recursively
-         * through all the WUPSConfig objects for the requested category.
+         * If the 'checkRecursive' flag is set to true, the function also returns categories which have been added
+         * to a category of a WUPSConfig object (or the WUPSConfig itself). Added categories are tracked with their parent,
+         * so this only walks up the parents of the requested category.
          *
          * @param handle The handle of the desired WUPSConfigCategory
          * @param checkRecursive Flag to indicate whether recursive search is required
@@ -59,8 +61,8 @@ namespace WUPSConfigAPIBackend {
         /**
          * @brief Retrieves a WUPSConfigItem object by its handle.
          *
-         * This function searches for a WUPSConfigItem object in the sConfigItems vector
-         * with a matching handle. It acquires a lock on the sConfigItemsMutex
+         * This function searches for a WUPSConfigItem object in the sConfigItems map
+         * with a matching handle. It acquires a lock on the sHandlesMutex
          * to ensure thread safety during the search operation. If a matching object is found,
          * a pointer to the object is returned. Otherwise, nullptr is returned.
          *
@@ -72,18 +74,16 @@ namespace WUPSConfigAPIBackend {
         /**
          * @brief Removes and returns an item from the configuration items list based on its handle.
          *
-         * This function pops and returns an item from the `sConfigItems` vector based on its handle.
-         * The handle is used to match the item in the vector using a predicate. If a matching item is found,
-         * it is moved to the returned unique_ptr and removed from the vector.
+         * This function pops and returns an item from the `sConfigItems` map based on its handle.
+         * If a matching item is found, it is moved to the returned unique_ptr and removed from the map.
          *
          * @param handle The handle of the item to be popped.
          * @return A unique_ptr to the popped item. If no matching item is found, returns a nullptr.
          *
-         * @note The function locks the `sConfigItemsMutex` mutex to ensure thread safety while performing the operation.
+         * @note The function locks the `sHandlesMutex` mutex to ensure thread safety while performing the operation.
          *
          * @see WUPSConfigItem
-         * @see pop_locked_first_if
-         * @see sConfigItemsMutex
+         * @see sHandlesMutex
          * @see sConfigItems
          */
         std::unique_ptr<WUPSConfigItem> PopItemByHandle(WUPSConfigItemHandle handle);
@@ -92,7 +92,7 @@ namespace WUPSConfigAPIBackend {
          * @brief Creates a new configuration with the given name.
          *
          * This function creates a new configuration with the specified name. The configuration is allocated dynamically
-         * using `make_unique_nothrow` and added to the `sConfigs` vector.
+         * using `make_unique_nothrow` and added to the `sConfigs` map.
          *
          * @param name The name of the configuration.
          * @param out A pointer to a `WUPSConfigHandle` where the created configuration will be stored.
@@ -110,18 +110,15 @@ namespace WUPSConfigAPIBackend {
         /**
          * @brief Cleans all handles and clears the configuration data.
          *
-         * This function acquires locks on three different mutexes: `sConfigsMutex`, `sConfigCategoryMutex`, and `sConfigItemsMutex`.
-         * It then clears the vectors `sConfigs`, `sConfigCategories`, and `sConfigItems`, effectively cleaning all handles and
-         * removing all configuration data.
+         * This function acquires the lock on `sHandlesMutex`.
+         * It then clears the maps `sConfigs`, `sConfigCategories`, `sConfigItems` and `sAddedCategories`, effectively
+         * cleaning all handles and removing all configuration data.
          *
-         * @note This function assumes that the mutexes and vectors are already defined and initialized.
-         *
-         * @see sConfigsMutex
-         * @see sConfigCategoryMutex
-         * @see sConfigItemsMutex
+         * @see sHandlesMutex
          * @see sConfigs
          * @see sConfigCategories
          * @see sConfigItems
+         * @see sAddedCategories
          */
         void CleanAllHandles();
     } // namespace Intern
@@ -170,7 +167,7 @@ namespace WUPSConfigAPIBackend {
          * @param categoryHandle The handle of the category to be added.
          * @return The status of the operation. Possible values are:
          *         - WUPSCONFIG_API_RESULT_SUCCESS: The category was added successfully.
-         *         - WUPSCONFIG_API_RESULT_INVALID_ARGUMENT: One or both of the input handles were NULL.
+         *         - WUPSCONFIG_API_RESULT_INVALID_ARGUMENT: One or both of the input handles were NULL or both handles are the same.
          *         - WUPSCONFIG_API_RESULT_NOT_FOUND: The parent category or the specified category was not found.
          *         - WUPSCONFIG_API_RESULT_UNKNOWN_ERROR: Failed to add the category to the parent.
          */
@@ -64,6 +64,13 @@ namespace WUPSConfigAPIBackend {
 
         virtual void onInputEx(WUPSConfigComplexPadData) const {}
 
+        /**
+         * Whether onInputEx() does anything, the complex pad data is only collected for items that use it.
+         */
+        [[nodiscard]] virtual bool hasInputEx() const {
+            return false;
+        }
+
     protected:
         std::string mDisplayName;
         std::string mStubConfigId;
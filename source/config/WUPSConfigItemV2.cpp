@@ -66,6 +66,10 @@ namespace WUPSConfigAPIBackend {
         this->mCallbacks.onInputEx(mContext, input);
     }
 
+    bool WUPSConfigItemV2::hasInputEx() const {
+        return this->mCallbacks.onInputEx != nullptr;
+    }
+
     bool WUPSConfigItemV2::isMovementAllowed() const {
         if (this->mCallbacks.isMovementAllowed == nullptr) {
             DEBUG_FUNCTION_LINE_VERBOSE("isMovementAllowed callback not implemented. [%s]", mDisplayName.c_str());
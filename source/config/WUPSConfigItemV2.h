@@ -21,6 +21,8 @@ namespace WUPSConfigAPIBackend {
 
         void onInputEx(WUPSConfigComplexPadData input) const override;
 
+        [[nodiscard]] bool hasInputEx() const override;
+
         [[nodiscard]] bool isMovementAllowed() const override;
 
         void restoreDefault() const override;
@@ -5,6 +5,7 @@
 #include "hooks.h"
 #include "patcher/hooks_patcher_static.h"
 #include "plugin/PluginDataFactory.h"
+#include "utils/storage/StorageUtils.h"
 #include "utils/utils.h"
 #include <coreinit/debug.h>
 #include <notifications/notifications.h>
@@ -185,6 +186,9 @@ WUMS_APPLICATION_STARTS() {
 
         CallHook(gLoadedPlugins, WUPS_LOADER_HOOK_APPLICATION_STARTS);
     }
+
+    // Drop prefetched storages of plugins which failed to load.
+    StorageUtils::API::Internal::FinishPrefetch();
 }
 
 void CheckCleanupCallbackUsage(const std::vector<PluginContainer> &plugins) {
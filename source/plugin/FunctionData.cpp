@@ -50,9 +50,9 @@ bool FunctionData::AddPatch() {
         function_replacement_data_t functionData = {
                 .version       = FUNCTION_REPLACEMENT_DATA_STRUCT_VERSION,
                 .type          = FUNCTION_PATCHER_REPLACE_BY_LIB_OR_ADDRESS,
-                .physicalAddr  = reinterpret_cast<uint32_t>(this->paddress),
-                .virtualAddr   = reinterpret_cast<uint32_t>(this->vaddress),
-                .replaceAddr   = reinterpret_cast<uint32_t>(this->replaceAddr),
+                .physicalAddr  = reinterpret_cast<uintptr_t>(this->paddress),
+                .virtualAddr   = reinterpret_cast<uintptr_t>(this->vaddress),
+                .replaceAddr   = reinterpret_cast<uintptr_t>(this->replaceAddr),
                 .replaceCall   = static_cast<uint32_t *>(this->replaceCall),
                 .targetProcess = this->targetProcess,
                 .ReplaceInRPL  = {
@@ -30,7 +30,7 @@ public:
     }
 
     bool operator<(const FunctionSymbolData &rhs) const {
-        return (uint32_t) mAddress < (uint32_t) rhs.mAddress;
+        return (uintptr_t) mAddress < (uintptr_t) rhs.mAddress;
     }
 
     virtual ~FunctionSymbolData() = default;
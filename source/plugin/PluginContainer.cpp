@@ -45,8 +45,8 @@ std::shared_ptr<PluginData> PluginContainer::getPluginDataCopy() const {
     return mPluginData;
 }
 
-uint32_t PluginContainer::getHandle() const {
-    return (uint32_t) this;
+uintptr_t PluginContainer::getHandle() const {
+    return (uintptr_t) this;
 }
 
 const std::optional<PluginConfigData> &PluginContainer::getConfigData() const {
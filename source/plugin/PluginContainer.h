@@ -46,7 +46,7 @@ public:
 
     [[nodiscard]] std::shared_ptr<PluginData> getPluginDataCopy() const;
 
-    [[nodiscard]] uint32_t getHandle() const;
+    [[nodiscard]] uintptr_t getHandle() const;
 
     [[nodiscard]] const std::optional<PluginConfigData> &getConfigData() const;
 
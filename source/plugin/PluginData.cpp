@@ -1,7 +1,7 @@
 #include "PluginData.h"
 
-uint32_t PluginData::getHandle() const {
-    return (uint32_t) this;
+uintptr_t PluginData::getHandle() const {
+    return (uintptr_t) this;
 }
 
 std::span<const uint8_t> PluginData::getBuffer() const {
@@ -33,7 +33,7 @@ public:
     explicit PluginData(std::span<uint8_t> buffer, std::string_view source) : mBuffer(buffer.begin(), buffer.end()), mSource(source) {
     }
 
-    [[nodiscard]] uint32_t getHandle() const;
+    [[nodiscard]] uintptr_t getHandle() const;
 
     [[nodiscard]] std::span<uint8_t const> getBuffer() const;
 
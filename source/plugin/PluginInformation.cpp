@@ -88,10 +88,10 @@ const FunctionSymbolData *PluginInformation::getNearestFunctionSymbolData(uint32
 
     bool foundHit = false;
     for (auto &cur : mSymbolDataList) {
-        if (foundHit && address < (uint32_t) cur.getAddress()) {
+        if (foundHit && address < (uintptr_t) cur.getAddress()) {
             break;
         }
-        if (address >= (uint32_t) cur.getAddress()) {
+        if (address >= (uintptr_t) cur.getAddress()) {
             result   = &cur;
             foundHit = true;
         }
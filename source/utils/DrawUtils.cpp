@@ -1,186 +1,356 @@
 #include "DrawUtils.h"
 
-#include "dc.h"
+#include "GlyphCache.h"
+#include "ImageCache.h"
 #include "logger.h"
 #include "utils.h"
-#include <avm/tv.h>
+#include <algorithm>
 #include <coreinit/cache.h>
 #include <coreinit/memory.h>
-#include <coreinit/screen.h>
 #include <cstdlib>
 #include <png.h>
 
-// buffer width
-#define DRC_WIDTH 0x380
+#define MAX_TV_WIDTH 1920
 
+ScreenBackend *DrawUtils::backend = nullptr;
 bool DrawUtils::isBackBuffer;
 
-uint8_t *DrawUtils::tvBuffer    = nullptr;
-uint32_t DrawUtils::tvSize      = 0;
-uint8_t *DrawUtils::drcBuffer   = nullptr;
-uint32_t DrawUtils::drcSize     = 0;
-uint32_t DrawUtils::usedTVWidth = 1280;
-float DrawUtils::usedTVScale    = 1.5f;
-static SFT pFont                = {};
+uint8_t *DrawUtils::tvBuffer       = nullptr;
+uint32_t DrawUtils::tvSize         = 0;
+uint8_t *DrawUtils::drcBuffer      = nullptr;
+uint32_t DrawUtils::drcSize        = 0;
+uint32_t DrawUtils::drcPitch       = 0;
+uint32_t DrawUtils::usedTVWidth    = 1280;
+float DrawUtils::usedTVScale       = 1.5f;
+uint32_t DrawUtils::usedTVHeight   = 720;
+uint32_t DrawUtils::clipX0         = 0;
+uint32_t DrawUtils::clipY0         = 0;
+uint32_t DrawUtils::clipX1         = UINT32_MAX;
+uint32_t DrawUtils::clipY1         = UINT32_MAX;
+uint64_t DrawUtils::frameStartTime = 0;
+uint32_t DrawUtils::lastFrameTime  = 0;
+static SFT pFont                   = {};
+static GlyphCache glyphCache;
+static ImageCache imageCache;
 
 static Color font_col(0xFFFFFFFF);
 
-void DrawUtils::initBuffers(void *tvBuffer_, uint32_t tvSize_, void *drcBuffer_, uint32_t drcSize_) {
-    DrawUtils::tvBuffer  = (uint8_t *) tvBuffer_;
-    DrawUtils::tvSize    = tvSize_;
-    DrawUtils::drcBuffer = (uint8_t *) drcBuffer_;
-    DrawUtils::drcSize   = drcSize_;
-
-    bool bigScale = true;
-    switch (TVEGetCurrentPort()) {
-        case TVE_PORT_HDMI:
-            bigScale = true;
-            break;
-        case TVE_PORT_COMPONENT:
-        case TVE_PORT_COMPOSITE:
-        case TVE_PORT_SCART:
-            bigScale = false;
-            break;
-    }
-
-    AVMTvResolution tvResolution = AVM_TV_RESOLUTION_720P;
-    if (AVMGetTVScanMode(&tvResolution)) {
-        switch (tvResolution) {
-            case AVM_TV_RESOLUTION_480P:
-            case AVM_TV_RESOLUTION_720P:
-            case AVM_TV_RESOLUTION_720P_3D:
-            case AVM_TV_RESOLUTION_1080I:
-            case AVM_TV_RESOLUTION_1080P:
-            case AVM_TV_RESOLUTION_576P:
-            case AVM_TV_RESOLUTION_720P_50HZ:
-            case AVM_TV_RESOLUTION_1080I_50HZ:
-            case AVM_TV_RESOLUTION_1080P_50HZ:
-                bigScale = true;
-                break;
-            case AVM_TV_RESOLUTION_576I:
-            case AVM_TV_RESOLUTION_480I:
-            case AVM_TV_RESOLUTION_480I_PAL60:
-                break;
+// TV pixels [start, end) covered by a screen column/row
+static uint16_t tvColumnStart[SCREEN_WIDTH];
+static uint16_t tvColumnEnd[SCREEN_WIDTH];
+static uint16_t tvRowStart[SCREEN_HEIGHT];
+static uint16_t tvRowEnd[SCREEN_HEIGHT];
+// Screen column a TV column is copied from
+static uint16_t tvColumnSource[MAX_TV_WIDTH];
+// Blocks of DIRTY_BLOCK_WIDTH columns of a screen row that have been drawn since beginDraw(), one bit per block
+#define DIRTY_BLOCK_WIDTH 32
+static_assert((SCREEN_WIDTH + DIRTY_BLOCK_WIDTH - 1) / DIRTY_BLOCK_WIDTH < 32);
+static uint32_t dirtyBlocks[SCREEN_HEIGHT];
+// Rows [start, end) containing dirty columns
+static uint32_t dirtyRowStart = SCREEN_HEIGHT;
+static uint32_t dirtyRowEnd   = 0;
+// Whether the back buffers have been cleared since beginDraw()
+static bool wasCleared = false;
+
+// Rounded division by 255 for values up to 255 * 255
+static inline uint32_t div255(uint32_t value) {
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+// Blends two packed pixels, all channels are blended in two steps of two channels each.
+static inline uint32_t blendPixel(uint32_t dst, uint32_t src, uint32_t alpha) {
+    uint32_t invAlpha = 255 - alpha;
+    uint32_t rb       = (src & 0x00FF00FF) * alpha + (dst & 0x00FF00FF) * invAlpha + 0x00800080;
+    uint32_t ga       = ((src >> 8) & 0x00FF00FF) * alpha + ((dst >> 8) & 0x00FF00FF) * invAlpha + 0x00800080;
+    rb                = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    ga                = (ga + ((ga >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+    return rb | ga;
+}
+
+// Blends a pixel with premultiplied alpha, invAlpha is 255 - alpha of src.
+static inline uint32_t blendPremultipliedPixel(uint32_t dst, uint32_t src, uint32_t invAlpha) {
+    uint32_t rb = (dst & 0x00FF00FF) * invAlpha + 0x00800080;
+    uint32_t ga = ((dst >> 8) & 0x00FF00FF) * invAlpha + 0x00800080;
+    rb          = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    ga          = (ga + ((ga >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+    return src + (rb | ga);
+}
+
+// Blends col into count pixels, the alpha of col is scaled by the coverage of each pixel.
+static inline void blendMaskRow(uint32_t *dst, const uint8_t *coverage, uint32_t count, Color col) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t alpha = coverage[i];
+        if (alpha == 0) {
+            continue;
+        }
+        if (col.a != 0xFF) {
+            alpha = div255(alpha * col.a);
+        }
+        if (alpha == 0xFF) {
+            dst[i] = col.color;
+        } else if (alpha != 0) {
+            dst[i] = blendPixel(dst[i], col.color, alpha);
         }
     }
+}
 
-    auto tvScanBufferWidth = DCReadReg32(SCREEN_TV, D1GRPH_X_END_REG);
-
-    if (tvScanBufferWidth == 640) { // 480i/480p/576i 4:3
-        DrawUtils::usedTVWidth = 640;
-        SetDCPitchReg(SCREEN_TV, 640);
-        DrawUtils::usedTVScale = bigScale ? 0.75 : 0.75f;
-    } else if (tvScanBufferWidth == 854) { // 480i/480p/576i 16:9
-        DrawUtils::usedTVWidth = 896;
-        SetDCPitchReg(SCREEN_TV, 896);
-        DrawUtils::usedTVScale = bigScale ? 1.0 : 1.0f;
-    } else if (tvScanBufferWidth == 1280) { // 720p 16:9
-        DrawUtils::usedTVWidth = 1280;
-        SetDCPitchReg(SCREEN_TV, 1280);
-        if (bigScale) {
-            DrawUtils::usedTVScale = 1.5;
-        } else {
-            DrawUtils::usedTVScale = 0.75f;
-            if (tvResolution == AVM_TV_RESOLUTION_480I_PAL60 || tvResolution == AVM_TV_RESOLUTION_480I) {
-                AVMTvAspectRatio tvAspectRatio;
-                if (AVMGetTVAspectRatio(&tvAspectRatio) && tvAspectRatio == AVM_TV_ASPECT_RATIO_16_9) {
-                    DEBUG_FUNCTION_LINE_WARN("force big scaling for 480i + 16:9");
-                    DrawUtils::usedTVScale = 1.5;
-                }
-            }
+void DrawUtils::initBackend(ScreenBackend *backend_) {
+    DrawUtils::backend = backend_;
+
+    auto tv              = backend->getTVSurface();
+    auto drc             = backend->getDRCSurface();
+    DrawUtils::tvBuffer  = tv.buffer;
+    DrawUtils::tvSize    = tv.size;
+    DrawUtils::drcBuffer = drc.buffer;
+    DrawUtils::drcSize   = drc.size;
+    DrawUtils::drcPitch  = drc.pitch;
+
+    DrawUtils::usedTVWidth  = tv.pitch;
+    DrawUtils::usedTVHeight = tv.height;
+    DrawUtils::usedTVScale  = backend->getTVScale();
+
+    initTVScaling();
+}
+
+void DrawUtils::initTVScaling() {
+    uint32_t tvWidth = usedTVWidth < MAX_TV_WIDTH ? usedTVWidth : MAX_TV_WIDTH;
+
+    // Same mapping as scaling each pixel on its own: a pixel covers [x * scale, x * scale + (uint32_t) scale)
+    auto getRange = [](uint32_t pos, uint32_t max, uint16_t &outStart, uint16_t &outEnd) {
+        auto start = (uint32_t) (pos * usedTVScale);
+        auto limit = (pos * usedTVScale) + (uint32_t) usedTVScale;
+        auto end   = start;
+        while (end < limit) {
+            end++;
         }
-    } else if (tvScanBufferWidth == 1920) { // 1080i/1080p 16:9
-        DrawUtils::usedTVWidth = 1920;
-        SetDCPitchReg(SCREEN_TV, 1920);
-        DrawUtils::usedTVScale = bigScale ? 2.25 : 1.125f;
-    } else {
-        DrawUtils::usedTVWidth = tvScanBufferWidth;
-        SetDCPitchReg(SCREEN_TV, tvScanBufferWidth);
-        DrawUtils::usedTVScale = 1.0f;
-        DEBUG_FUNCTION_LINE_WARN("Unknown tv width detected, config menu might not show properly");
+        outStart = start < max ? start : max;
+        outEnd   = end < max ? end : max;
+    };
+    for (uint32_t x = 0; x < SCREEN_WIDTH; x++) {
+        getRange(x, tvWidth, tvColumnStart[x], tvColumnEnd[x]);
+        for (uint32_t xx = tvColumnStart[x]; xx < tvColumnEnd[x]; xx++) {
+            tvColumnSource[xx] = x;
+        }
+    }
+    for (uint32_t y = 0; y < SCREEN_HEIGHT; y++) {
+        getRange(y, usedTVHeight, tvRowStart[y], tvRowEnd[y]);
+        dirtyBlocks[y] = 0;
     }
+    // Like the columns, a TV row shared by two rows (at 1080p) belongs to the lower one. Otherwise it would depend on
+    // which of the rows has been redrawn last.
+    for (uint32_t y = 0; y + 1 < SCREEN_HEIGHT; y++) {
+        if (tvRowEnd[y] > tvRowStart[y + 1]) {
+            tvRowEnd[y] = tvRowStart[y + 1];
+        }
+    }
+    dirtyRowStart = SCREEN_HEIGHT;
+    dirtyRowEnd   = 0;
 }
 
 void DrawUtils::beginDraw() {
-    uint32_t pixel = *(uint32_t *) tvBuffer;
+    frameStartTime = backend->getTime();
+    isBackBuffer   = backend->getBackBufferIndex() == 1;
+    wasCleared     = false;
+}
 
-    // check which buffer is currently used
-    OSScreenPutPixelEx(SCREEN_TV, 0, 0, 0xABCDEF90);
-    if (*(uint32_t *) tvBuffer == 0xABCDEF90) {
-        isBackBuffer = false;
-    } else {
-        isBackBuffer = true;
+void DrawUtils::endDraw() {
+    ScreenBackend::RowRange tvRows  = {0, 0};
+    ScreenBackend::RowRange drcRows = {dirtyRowStart, dirtyRowEnd};
+    if (dirtyRowStart < dirtyRowEnd) {
+        tvRows = {tvRowStart[dirtyRowStart], tvRowEnd[dirtyRowEnd - 1]};
+    }
+    for (uint32_t y = dirtyRowStart; y < dirtyRowEnd; y++) {
+        // Copy each run of dirty blocks, the highest bit is never set so every run ends before it.
+        uint32_t blocks = dirtyBlocks[y];
+        while (blocks != 0) {
+            uint32_t first = __builtin_ctz(blocks);
+            uint32_t count = __builtin_ctz(~(blocks >> first));
+            uint32_t x1    = (first + count) * DIRTY_BLOCK_WIDTH;
+            scaleRectToTV(first * DIRTY_BLOCK_WIDTH, x1 < SCREEN_WIDTH ? x1 : SCREEN_WIDTH, y, y + 1);
+            blocks &= ~(((1u << count) - 1) << first);
+        }
+        dirtyBlocks[y] = 0;
+    }
+    dirtyRowStart = SCREEN_HEIGHT;
+    dirtyRowEnd   = 0;
+    if (wasCleared) {
+        tvRows  = {0, usedTVHeight};
+        drcRows = {0, SCREEN_HEIGHT};
     }
 
-    // restore the pixel we used for checking
-    *(uint32_t *) tvBuffer = pixel;
+    backend->present(tvRows, drcRows);
+    lastFrameTime = (uint32_t) (backend->getTime() - frameStartTime);
 }
 
-void DrawUtils::endDraw() {
-    // OSScreenFlipBuffersEx already flushes the cache?
-    // DCFlushRange(tvBuffer, tvSize);
-    // DCFlushRange(drcBuffer, drcSize);
+void DrawUtils::waitForVSync() {
+    backend->waitForVSync();
+}
+
+void DrawUtils::setClipRect(const DrawRect &rect) {
+    clipX0 = rect.x;
+    clipY0 = rect.y;
+    clipX1 = rect.x + rect.w;
+    clipY1 = rect.y + rect.h;
+}
 
-    OSScreenFlipBuffersEx(SCREEN_DRC);
-    OSScreenFlipBuffersEx(SCREEN_TV);
+void DrawUtils::resetClipRect() {
+    clipX0 = 0;
+    clipY0 = 0;
+    clipX1 = UINT32_MAX;
+    clipY1 = UINT32_MAX;
 }
 
 void DrawUtils::clear(Color col) {
-    OSScreenClearBufferEx(SCREEN_TV, col.color);
-    OSScreenClearBufferEx(SCREEN_DRC, col.color);
+    // Clears the TV as well, only what gets drawn afterward needs to be scaled.
+    backend->clear(col.color);
+    wasCleared = true;
 }
 
-void DrawUtils::drawPixel(uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-    if (a == 0) {
+uint32_t *DrawUtils::getDRCRow(uint32_t y) {
+    return (uint32_t *) (drcBuffer + (isBackBuffer ? drcSize / 2 : 0)) + y * drcPitch;
+}
+
+uint32_t *DrawUtils::getTVRow(uint32_t y) {
+    return (uint32_t *) (tvBuffer + (isBackBuffer ? tvSize / 2 : 0)) + y * usedTVWidth;
+}
+
+bool DrawUtils::clipSpan(uint32_t &x0, uint32_t &x1, uint32_t y) {
+    if (y < clipY0 || y >= clipY1 || y >= SCREEN_HEIGHT) {
+        return false;
+    }
+    if (x0 < clipX0) {
+        x0 = clipX0;
+    }
+    if (x1 > clipX1) {
+        x1 = clipX1;
+    }
+    if (x1 > SCREEN_WIDTH) {
+        x1 = SCREEN_WIDTH;
+    }
+    return x0 < x1;
+}
+
+void DrawUtils::scaleRectToTV(uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) {
+    uint32_t tvX0 = tvColumnStart[x0];
+    uint32_t tvX1 = tvColumnEnd[x1 - 1];
+    if (tvX0 >= tvX1) {
         return;
     }
 
-    float opacity = a / 255.0f;
+    for (uint32_t y = y0; y < y1; y++) {
+        uint32_t tvY0 = tvRowStart[y];
+        uint32_t tvY1 = tvRowEnd[y];
+        if (tvY0 >= tvY1) {
+            continue;
+        }
 
-    // put pixel in the drc buffer
-    uint32_t i = (x + y * DRC_WIDTH) * 4;
-    if (i + 3 < drcSize / 2) {
-        if (isBackBuffer) {
-            i += drcSize / 2;
+        const uint32_t *src = getDRCRow(y);
+        uint32_t *dst       = getTVRow(tvY0);
+        for (uint32_t xx = tvX0; xx < tvX1; xx++) {
+            // Neighbouring columns may overlap on the TV, don't copy pixels outside of the span.
+            uint32_t srcX = tvColumnSource[xx];
+            dst[xx]       = src[srcX < x1 ? srcX : x1 - 1];
         }
-        if (a == 0xFF) {
-            drcBuffer[i]     = r;
-            drcBuffer[i + 1] = g;
-            drcBuffer[i + 2] = b;
-        } else {
-            drcBuffer[i]     = r * opacity + drcBuffer[i] * (1 - opacity);
-            drcBuffer[i + 1] = g * opacity + drcBuffer[i + 1] * (1 - opacity);
-            drcBuffer[i + 2] = b * opacity + drcBuffer[i + 2] * (1 - opacity);
+        for (uint32_t yy = tvY0 + 1; yy < tvY1; yy++) {
+            memcpy(getTVRow(yy) + tvX0, dst + tvX0, (tvX1 - tvX0) * 4);
         }
     }
+}
 
-    // scale and put pixel in the tv buffer
-    for (uint32_t yy = (y * DrawUtils::usedTVScale); yy < ((y * DrawUtils::usedTVScale) + (uint32_t) DrawUtils::usedTVScale); yy++) {
-        for (uint32_t xx = (x * DrawUtils::usedTVScale); xx < ((x * DrawUtils::usedTVScale) + (uint32_t) DrawUtils::usedTVScale); xx++) {
-            uint32_t i = (xx + yy * DrawUtils::usedTVWidth) * 4;
-            if (i + 3 < tvSize / 2) {
-                if (isBackBuffer) {
-                    i += tvSize / 2;
-                }
-                if (a == 0xFF) {
-                    tvBuffer[i]     = r;
-                    tvBuffer[i + 1] = g;
-                    tvBuffer[i + 2] = b;
-                } else {
-                    tvBuffer[i]     = r * opacity + tvBuffer[i] * (1 - opacity);
-                    tvBuffer[i + 1] = g * opacity + tvBuffer[i + 1] * (1 - opacity);
-                    tvBuffer[i + 2] = b * opacity + tvBuffer[i + 2] * (1 - opacity);
-                }
-            }
+void DrawUtils::markDirty(uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) {
+    uint32_t firstBlock = x0 / DIRTY_BLOCK_WIDTH;
+    uint32_t lastBlock  = (x1 - 1) / DIRTY_BLOCK_WIDTH;
+    uint32_t blocks     = ((2u << lastBlock) - 1) & ~((1u << firstBlock) - 1);
+    for (uint32_t y = y0; y < y1; y++) {
+        dirtyBlocks[y] |= blocks;
+    }
+    if (y0 < dirtyRowStart) {
+        dirtyRowStart = y0;
+    }
+    if (y1 > dirtyRowEnd) {
+        dirtyRowEnd = y1;
+    }
+}
+
+void DrawUtils::drawPixel(uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    fillSpan(x, x + 1, y, Color(r, g, b, a));
+}
+
+void DrawUtils::fillSpan(uint32_t x0, uint32_t x1, uint32_t y, Color col) {
+    if (col.a == 0 || !clipSpan(x0, x1, y)) {
+        return;
+    }
+
+    uint32_t *row = getDRCRow(y);
+    if (col.a == 0xFF) {
+        for (uint32_t x = x0; x < x1; x++) {
+            row[x] = col.color;
+        }
+    } else {
+        for (uint32_t x = x0; x < x1; x++) {
+            row[x] = blendPixel(row[x], col.color, col.a);
         }
     }
+    markDirty(x0, x1, y, y + 1);
+}
+
+void DrawUtils::blendSpan(uint32_t x, uint32_t y, const Color *pixels, uint32_t count) {
+    uint32_t x0 = x;
+    uint32_t x1 = x + count;
+    if (!clipSpan(x0, x1, y)) {
+        return;
+    }
+
+    uint32_t *row = getDRCRow(y);
+    pixels -= x;
+    for (uint32_t xx = x0; xx < x1; xx++) {
+        auto alpha = pixels[xx].a;
+        if (alpha == 0xFF) {
+            row[xx] = pixels[xx].color;
+        } else if (alpha != 0) {
+            row[xx] = blendPixel(row[xx], pixels[xx].color, alpha);
+        }
+    }
+    markDirty(x0, x1, y, y + 1);
+}
+
+void DrawUtils::blendMaskSpan(uint32_t x, uint32_t y, const uint8_t *coverage, uint32_t count, Color col) {
+    uint32_t x0 = x;
+    uint32_t x1 = x + count;
+    if (col.a == 0 || !clipSpan(x0, x1, y)) {
+        return;
+    }
+
+    blendMaskRow(getDRCRow(y) + x0, coverage + (x0 - x), x1 - x0, col);
+    markDirty(x0, x1, y, y + 1);
+}
+
+void DrawUtils::drawMask(int32_t x, int32_t y, const uint8_t *coverage, uint32_t width, uint32_t height, Color col) {
+    // Clip the whole mask once
+    auto left   = (int32_t) std::min<uint32_t>(clipX0, SCREEN_WIDTH);
+    auto top    = (int32_t) std::min<uint32_t>(clipY0, SCREEN_HEIGHT);
+    auto right  = (int32_t) std::min<uint32_t>(clipX1, SCREEN_WIDTH);
+    auto bottom = (int32_t) std::min<uint32_t>(clipY1, SCREEN_HEIGHT);
+    int32_t x0  = std::max(x, left);
+    int32_t y0  = std::max(y, top);
+    int32_t x1  = std::min(x + (int32_t) width, right);
+    int32_t y1  = std::min(y + (int32_t) height, bottom);
+    if (col.a == 0 || x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    coverage += (y0 - y) * width + (x0 - x);
+    for (int32_t yy = y0; yy < y1; yy++) {
+        blendMaskRow(getDRCRow(yy) + x0, coverage, x1 - x0, col);
+        coverage += width;
+    }
+    markDirty(x0, x1, y0, y1);
 }
 
 void DrawUtils::drawRectFilled(uint32_t x, uint32_t y, uint32_t w, uint32_t h, Color col) {
     for (uint32_t yy = y; yy < y + h; yy++) {
-        for (uint32_t xx = x; xx < x + w; xx++) {
-            drawPixel(xx, yy, col);
-        }
+        fillSpan(x, x + w, yy, col);
     }
 }
 
@@ -192,9 +362,69 @@ void DrawUtils::drawRect(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_
 }
 
 void DrawUtils::drawBitmap(uint32_t x, uint32_t y, uint32_t target_width, uint32_t target_height, const uint8_t *data) {
+    auto *image = imageCache.find(data, target_width, target_height);
+    if (!image) {
+        auto pixels = decodeBitmap(data, target_width, target_height);
+        if (!pixels) {
+            return;
+        }
+        image = imageCache.insert(data, target_width, target_height, std::move(pixels), target_width, target_height);
+    }
+    drawImage(x, y, image->width, image->height, image->pixels);
+}
+
+void DrawUtils::drawPNG(uint32_t x, uint32_t y, const uint8_t *data) {
+    auto *image = imageCache.find(data, 0, 0);
+    if (!image) {
+        uint32_t width  = 0;
+        uint32_t height = 0;
+        auto pixels     = decodePNG(data, width, height);
+        if (!pixels) {
+            return;
+        }
+        image = imageCache.insert(data, 0, 0, std::move(pixels), width, height);
+    }
+    drawImage(x, y, image->width, image->height, image->pixels);
+}
+
+void DrawUtils::invalidateImage(const uint8_t *data) {
+    imageCache.invalidate(data);
+}
+
+void DrawUtils::clearImageCache() {
+    imageCache.clear();
+}
+
+void DrawUtils::drawImage(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const Color *pixels) {
+    // Clip the whole image once
+    uint32_t x0 = std::max(x, clipX0);
+    uint32_t y0 = std::max(y, clipY0);
+    uint32_t x1 = std::min({x + width, clipX1, (uint32_t) SCREEN_WIDTH});
+    uint32_t y1 = std::min({y + height, clipY1, (uint32_t) SCREEN_HEIGHT});
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    const Color *src = pixels + (y0 - y) * width + (x0 - x);
+    for (uint32_t yy = y0; yy < y1; yy++) {
+        uint32_t *row = getDRCRow(yy) + x0;
+        for (uint32_t i = 0; i < x1 - x0; i++) {
+            auto alpha = src[i].a;
+            if (alpha == 0xFF) {
+                row[i] = src[i].color;
+            } else if (alpha != 0) {
+                row[i] = blendPremultipliedPixel(row[i], src[i].color, 0xFF - alpha);
+            }
+        }
+        src += width;
+    }
+    markDirty(x0, x1, y0, y1);
+}
+
+std::unique_ptr<Color[]> DrawUtils::decodeBitmap(const uint8_t *data, uint32_t target_width, uint32_t target_height) {
     if (data[0] != 'B' || data[1] != 'M') {
         // invalid header
-        return;
+        return {};
     }
 
     uint32_t dataPos = __builtin_bswap32(*(uint32_t *) &(data[0x0A]));
@@ -207,14 +437,21 @@ void DrawUtils::drawBitmap(uint32_t x, uint32_t y, uint32_t target_width, uint32
 
     data += dataPos;
 
-    // TODO flip image since bitmaps are stored upside down
+    auto pixels = make_unique_nothrow<Color[]>((size_t) target_width * target_height);
+    if (!pixels) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to allocate memory for bitmap");
+        return {};
+    }
 
-    for (uint32_t yy = y; yy < y + target_height; yy++) {
-        for (uint32_t xx = x; xx < x + target_width; xx++) {
-            uint32_t i = (((xx - x) * width / target_width) + ((yy - y) * height / target_height) * width) * 3;
-            drawPixel(xx, yy, data[i + 2], data[i + 1], data[i], 0xFF);
+    // TODO flip image since bitmaps are stored upside down
+    auto *out = pixels.get();
+    for (uint32_t yy = 0; yy < target_height; yy++) {
+        for (uint32_t xx = 0; xx < target_width; xx++) {
+            uint32_t i = ((xx * width / target_width) + (yy * height / target_height) * width) * 3;
+            *out++     = Color(data[i + 2], data[i + 1], data[i], 0xFF);
         }
     }
+    return pixels;
 }
 
 static void png_read_data(png_structp png_ptr, png_bytep outBytes, png_size_t byteCountToRead) {
@@ -224,16 +461,16 @@ static void png_read_data(png_structp png_ptr, png_bytep outBytes, png_size_t by
     *((uint8_t **) data) += byteCountToRead;
 }
 
-void DrawUtils::drawPNG(uint32_t x, uint32_t y, const uint8_t *data) {
+std::unique_ptr<Color[]> DrawUtils::decodePNG(const uint8_t *data, uint32_t &outWidth, uint32_t &outHeight) {
     png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if (png_ptr == nullptr) {
-        return;
+        return {};
     }
 
     png_infop info_ptr = png_create_info_struct(png_ptr);
     if (info_ptr == nullptr) {
         png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-        return;
+        return {};
     }
 
     png_set_read_fn(png_ptr, (void *) &data, png_read_data);
@@ -246,28 +483,45 @@ void DrawUtils::drawPNG(uint32_t x, uint32_t y, const uint8_t *data) {
     int colorType   = -1;
     uint32_t retval = png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &colorType, nullptr, nullptr, nullptr);
     if (retval != 1) {
-        return;
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        return {};
     }
 
     uint32_t bytesPerRow = png_get_rowbytes(png_ptr, info_ptr);
-    auto *rowData        = new uint8_t[bytesPerRow];
-
-    for (uint32_t yy = y; yy < y + height; yy++) {
-        png_read_row(png_ptr, (png_bytep) rowData, nullptr);
-
-        for (uint32_t xx = x; xx < x + width; xx++) {
-            if (colorType == PNG_COLOR_TYPE_RGB_ALPHA) {
-                uint32_t i = (xx - x) * 4;
-                drawPixel(xx, yy, rowData[i], rowData[i + 1], rowData[i + 2], rowData[i + 3]);
-            } else if (colorType == PNG_COLOR_TYPE_RGB) {
-                uint32_t i = (xx - x) * 3;
-                drawPixel(xx, yy, rowData[i], rowData[i + 1], rowData[i + 2], 0xFF);
+    auto rowData         = make_unique_nothrow<uint8_t[]>((size_t) bytesPerRow);
+    // Rows with an unsupported color type stay transparent.
+    auto pixels = make_unique_nothrow<Color[]>((size_t) width * height);
+    if (!rowData || !pixels) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to allocate memory for png");
+        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+        return {};
+    }
+
+    for (uint32_t yy = 0; yy < height; yy++) {
+        png_read_row(png_ptr, (png_bytep) rowData.get(), nullptr);
+
+        auto *row = &pixels[yy * width];
+        if (colorType == PNG_COLOR_TYPE_RGB_ALPHA) {
+            for (uint32_t xx = 0; xx < width; xx++) {
+                uint32_t i = xx * 4;
+                row[xx]    = Color(rowData[i], rowData[i + 1], rowData[i + 2], rowData[i + 3]);
+            }
+        } else if (colorType == PNG_COLOR_TYPE_RGB) {
+            for (uint32_t xx = 0; xx < width; xx++) {
+                uint32_t i = xx * 3;
+                row[xx]    = Color(rowData[i], rowData[i + 1], rowData[i + 2], 0xFF);
+            }
+        } else {
+            for (uint32_t xx = 0; xx < width; xx++) {
+                row[xx] = Color(0);
             }
         }
     }
 
-    delete[] rowData;
     png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    outWidth  = width;
+    outHeight = height;
+    return pixels;
 }
 
 bool DrawUtils::initFont() {
@@ -283,6 +537,7 @@ bool DrawUtils::initFont() {
         if (!pFont.font) {
             return false;
         }
+        glyphCache.init();
         OSMemoryBarrier();
         return true;
     }
@@ -290,6 +545,7 @@ bool DrawUtils::initFont() {
 }
 
 void DrawUtils::deinitFont() {
+    glyphCache.deinit();
     sft_freefont(pFont.font);
     pFont.font = nullptr;
     pFont      = {};
@@ -306,26 +562,6 @@ void DrawUtils::setFontColor(Color col) {
     font_col = col;
 }
 
-static void draw_freetype_bitmap(SFT_Image *bmp, int32_t x, int32_t y) {
-    int32_t i, j, p, q;
-
-    int32_t x_max = x + bmp->width;
-    int32_t y_max = y + bmp->height;
-
-    auto *src = (uint8_t *) bmp->pixels;
-
-    for (i = x, p = 0; i < x_max; i++, p++) {
-        for (j = y, q = 0; j < y_max; j++, q++) {
-            if (i < 0 || j < 0 || i >= SCREEN_WIDTH || j >= SCREEN_HEIGHT) {
-                continue;
-            }
-
-            float opacity = src[q * bmp->width + p] / 255.0f;
-            DrawUtils::drawPixel(i, j, font_col.r, font_col.g, font_col.b, font_col.a * opacity);
-        }
-    }
-}
-
 void DrawUtils::print(uint32_t x, uint32_t y, const char *string, bool alignRight) {
     auto *buffer = new wchar_t[strlen(string) + 1];
 
@@ -350,52 +586,23 @@ void DrawUtils::print(uint32_t x, uint32_t y, const wchar_t *string, bool alignR
         penX -= getTextWidth(string);
     }
 
-    uint16_t textureWidth = 0, textureHeight = 0;
     for (; *string; string++) {
-        SFT_Glyph gid; //  unsigned long gid;
-        if (sft_lookup(&pFont, *string, &gid) >= 0) {
-            SFT_GMetrics mtx;
-            if (sft_gmetrics(&pFont, gid, &mtx) < 0) {
-                DEBUG_FUNCTION_LINE_ERR("Failed to get glyph metrics");
-                return;
-            }
-
-            if (*string == '\n') {
-                penY += mtx.minHeight;
-                penX = x;
-                continue;
-            }
-
-            textureWidth  = (mtx.minWidth + 3) & ~3;
-            textureHeight = mtx.minHeight;
-
-            if (textureWidth == 0) {
-                textureWidth = 4;
-            }
-            if (textureHeight == 0) {
-                textureHeight = 4;
-            }
-
-            SFT_Image img = {
-                    .pixels = nullptr,
-                    .width  = textureWidth,
-                    .height = textureHeight,
-            };
+        auto *glyph = glyphCache.get(pFont, *string);
+        if (!glyph) {
+            return;
+        }
+        if (!glyph->exists) {
+            continue;
+        }
 
-            auto buffer = make_unique_nothrow<uint8_t[]>((uint32_t) (img.width * img.height));
-            if (!buffer) {
-                DEBUG_FUNCTION_LINE_ERR("Failed to allocate memory for glyph");
-                return;
-            }
-            img.pixels = buffer.get();
-            if (sft_render(&pFont, gid, img) < 0) {
-                DEBUG_FUNCTION_LINE_ERR("Failed to render glyph");
-                return;
-            } else {
-                draw_freetype_bitmap(&img, (int32_t) (penX + mtx.leftSideBearing), (int32_t) (penY + mtx.yOffset));
-                penX += (int32_t) mtx.advanceWidth;
-            }
+        if (*string == '\n') {
+            penY += glyph->minHeight;
+            penX = x;
+            continue;
         }
+
+        drawMask((int32_t) (penX + glyph->leftSideBearing), (int32_t) (penY + glyph->yOffset), glyph->pixels, glyph->width, glyph->height, font_col);
+        penX += (int32_t) glyph->advanceWidth;
     }
 }
 
@@ -421,13 +628,9 @@ uint32_t DrawUtils::getTextWidth(const wchar_t *string) {
     uint32_t width = 0;
 
     for (; *string; string++) {
-        SFT_Glyph gid; //  unsigned long gid;
-        if (sft_lookup(&pFont, *string, &gid) >= 0) {
-            SFT_GMetrics mtx;
-            if (sft_gmetrics(&pFont, gid, &mtx) < 0) {
-                DEBUG_FUNCTION_LINE_ERR("bad glyph metrics");
-            }
-            width += (int32_t) mtx.advanceWidth;
+        auto *glyph = glyphCache.get(pFont, *string);
+        if (glyph && glyph->exists) {
+            width += (int32_t) glyph->advanceWidth;
         }
     }
 
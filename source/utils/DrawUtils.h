@@ -1,13 +1,17 @@
 #pragma once
 
+#include "ScreenBackend.h"
 #include "schrift.h"
 #include <cstdint>
+#include <memory>
 
 // visible screen sizes
 #define SCREEN_WIDTH  854
 #define SCREEN_HEIGHT 480
 
 union Color {
+    Color() = default;
+
     explicit Color(uint32_t color) {
         this->color = color;
     }
@@ -28,14 +32,58 @@ union Color {
     };
 };
 
+struct DrawRect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+
+    [[nodiscard]] bool intersects(const DrawRect &other) const {
+        return x < other.x + other.w && other.x < x + w && y < other.y + other.h && other.y < y + h;
+    }
+
+    [[nodiscard]] bool contains(const DrawRect &other) const {
+        return other.x >= x && other.y >= y && other.x + other.w <= x + w && other.y + other.h <= y + h;
+    }
+};
+
 class DrawUtils {
 public:
-    static void initBuffers(void *tvBuffer, uint32_t tvSize, void *drcBuffer, uint32_t drcSize);
+    /**
+     * Sets the screens to draw to, the backend needs to stay valid as long as DrawUtils is used.
+     */
+    static void initBackend(ScreenBackend *backend);
 
     static void beginDraw();
 
     static void endDraw();
 
+    /**
+     * Blocks until the next vertical blank, a frame presented right after it is shown with the next one.
+     */
+    static void waitForVSync();
+
+    /**
+     * Time in microseconds between the last beginDraw() and endDraw(), including presenting the frame.
+     */
+    static uint32_t getLastFrameTime() {
+        return lastFrameTime;
+    }
+
+    /**
+     * Index (0 or 1) of the buffer that is drawn to, only valid between beginDraw() and endDraw().
+     */
+    static uint32_t getBackBufferIndex() {
+        return isBackBuffer ? 1 : 0;
+    }
+
+    /**
+     * Pixels outside of the clip rect are not drawn. Doesn't affect clear().
+     */
+    static void setClipRect(const DrawRect &rect);
+
+    static void resetClipRect();
+
     static void clear(Color col);
 
     static void drawPixel(uint32_t x, uint32_t y, Color col) { drawPixel(x, y, col.r, col.g, col.b, col.a); }
@@ -44,12 +92,40 @@ public:
 
     static void drawRectFilled(uint32_t x, uint32_t y, uint32_t w, uint32_t h, Color col);
 
+    /**
+     * Fills the pixels [x0, x1) of row y with col, blended if col isn't opaque.
+     */
+    static void fillSpan(uint32_t x0, uint32_t x1, uint32_t y, Color col);
+
+    /**
+     * Draws count pixels starting at (x, y), each pixel is blended with its own alpha.
+     */
+    static void blendSpan(uint32_t x, uint32_t y, const Color *pixels, uint32_t count);
+
+    /**
+     * Draws count pixels of col starting at (x, y), the alpha of col is scaled by the coverage of each pixel.
+     */
+    static void blendMaskSpan(uint32_t x, uint32_t y, const uint8_t *coverage, uint32_t count, Color col);
+
+    /**
+     * Draws col through a coverage mask of width * height bytes (e.g. a glyph), the mask may be partially off-screen.
+     */
+    static void drawMask(int32_t x, int32_t y, const uint8_t *coverage, uint32_t width, uint32_t height, Color col);
+
     static void drawRect(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t borderSize, Color col);
 
     static void drawBitmap(uint32_t x, uint32_t y, uint32_t target_width, uint32_t target_height, const uint8_t *data);
 
     static void drawPNG(uint32_t x, uint32_t y, const uint8_t *data);
 
+    /**
+     * drawBitmap() and drawPNG() cache the decoded images by the address of data, this needs to be called before data
+     * gets modified or freed.
+     */
+    static void invalidateImage(const uint8_t *data);
+
+    static void clearImageCache();
+
     static bool initFont();
 
     static void deinitFont();
@@ -67,12 +143,52 @@ public:
     static uint32_t getTextWidth(const wchar_t *string);
 
 private:
+    static void initTVScaling();
+
+    /**
+     * Clips the span to the screen and the clip rect. Returns false if nothing is left.
+     */
+    static bool clipSpan(uint32_t &x0, uint32_t &x1, uint32_t y);
+
+    /**
+     * Draws width * height pixels with premultiplied alpha.
+     */
+    static void drawImage(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const Color *pixels);
+
+    static std::unique_ptr<Color[]> decodeBitmap(const uint8_t *data, uint32_t target_width, uint32_t target_height);
+
+    static std::unique_ptr<Color[]> decodePNG(const uint8_t *data, uint32_t &outWidth, uint32_t &outHeight);
+
+    static uint32_t *getDRCRow(uint32_t y);
+
+    static uint32_t *getTVRow(uint32_t y);
+
+    /**
+     * Everything is drawn into the DRC buffer, the TV buffer is a scaled copy of it. Remembers that the columns [x0, x1)
+     * of the rows [y0, y1) have been drawn, endDraw() copies them to the TV.
+     */
+    static void markDirty(uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1);
+
+    /**
+     * Updates the TV pixels covering the columns [x0, x1) of the rows [y0, y1) from the DRC buffer.
+     */
+    static void scaleRectToTV(uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1);
+
+    static ScreenBackend *backend;
     static bool isBackBuffer;
 
     static uint8_t *tvBuffer;
     static uint32_t tvSize;
     static uint8_t *drcBuffer;
     static uint32_t drcSize;
+    static uint32_t drcPitch;
     static uint32_t usedTVWidth;
     static float usedTVScale;
+    static uint32_t usedTVHeight;
+    static uint32_t clipX0;
+    static uint32_t clipY0;
+    static uint32_t clipX1;
+    static uint32_t clipY1;
+    static uint64_t frameStartTime;
+    static uint32_t lastFrameTime;
 };
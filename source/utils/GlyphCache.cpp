@@ -0,0 +1,204 @@
+#include "GlyphCache.h"
+#include "logger.h"
+#include "utils.h"
+#include <cstring>
+
+GlyphCache::GlyphCache() {
+    for (auto &bucket : mBuckets) {
+        bucket = INVALID_INDEX;
+    }
+}
+
+bool GlyphCache::init() {
+    deinit();
+    mAtlas = make_unique_nothrow<uint8_t[]>((size_t) MAX_GLYPHS * CELL_SIZE * CELL_SIZE);
+    if (!mAtlas) {
+        DEBUG_FUNCTION_LINE_WARN("Failed to allocate glyph atlas, glyphs will be rendered on demand");
+        return false;
+    }
+    return true;
+}
+
+void GlyphCache::deinit() {
+    DEBUG_FUNCTION_LINE_VERBOSE("Glyph cache hits: %u misses: %u", mHits, mMisses);
+    for (auto &bucket : mBuckets) {
+        bucket = INVALID_INDEX;
+    }
+    mUsedEntries = 0;
+    mLruHead     = INVALID_INDEX;
+    mLruTail     = INVALID_INDEX;
+    mHits        = 0;
+    mMisses      = 0;
+    mAtlas.reset();
+    mScratch.reset();
+    mScratchSize = 0;
+}
+
+const GlyphCache::Glyph *GlyphCache::get(const SFT &font, uint32_t codepoint) {
+    auto fontSize = (uint32_t) font.yScale;
+    auto index    = find(codepoint, fontSize);
+    if (index != INVALID_INDEX) {
+        mHits++;
+        auto &entry = mEntries[index];
+        if (index != mLruHead) {
+            lruUnlink(index);
+            lruPushFront(index);
+        }
+        if (entry.glyph.exists && !entry.inAtlas && !renderToScratch(font, entry)) {
+            return nullptr;
+        }
+        return &entry.glyph;
+    }
+
+    mMisses++;
+    index           = allocateEntry();
+    auto &entry     = mEntries[index];
+    entry           = {};
+    entry.codepoint = codepoint;
+    entry.fontSize  = fontSize;
+    if (!fillEntry(font, entry)) {
+        // The entry isn't part of the hash table, make sure it's the next one to be reused.
+        entry.codepoint = 0;
+        entry.fontSize  = 0;
+        lruPushBack(index);
+        return nullptr;
+    }
+
+    auto bucket      = GetBucket(codepoint, fontSize);
+    entry.hashNext   = mBuckets[bucket];
+    mBuckets[bucket] = index;
+    lruPushFront(index);
+    return &entry.glyph;
+}
+
+uint16_t GlyphCache::find(uint32_t codepoint, uint32_t fontSize) {
+    for (auto index = mBuckets[GetBucket(codepoint, fontSize)]; index != INVALID_INDEX; index = mEntries[index].hashNext) {
+        if (mEntries[index].codepoint == codepoint && mEntries[index].fontSize == fontSize) {
+            return index;
+        }
+    }
+    return INVALID_INDEX;
+}
+
+uint16_t GlyphCache::allocateEntry() {
+    if (mUsedEntries < MAX_GLYPHS) {
+        return mUsedEntries++;
+    }
+
+    // Evict the least recently used glyph
+    auto index = mLruTail;
+    lruUnlink(index);
+
+    auto &entry = mEntries[index];
+    for (auto *cur = &mBuckets[GetBucket(entry.codepoint, entry.fontSize)]; *cur != INVALID_INDEX; cur = &mEntries[*cur].hashNext) {
+        if (*cur == index) {
+            *cur = entry.hashNext;
+            break;
+        }
+    }
+    return index;
+}
+
+bool GlyphCache::fillEntry(const SFT &font, Entry &entry) {
+    auto &glyph = entry.glyph;
+    if (sft_lookup(&font, entry.codepoint, &entry.gid) < 0) {
+        glyph.exists = false;
+        return true;
+    }
+
+    SFT_GMetrics mtx;
+    if (sft_gmetrics(&font, entry.gid, &mtx) < 0) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to get glyph metrics");
+        return false;
+    }
+    glyph.exists          = true;
+    glyph.advanceWidth    = (float) mtx.advanceWidth;
+    glyph.leftSideBearing = (float) mtx.leftSideBearing;
+    glyph.yOffset         = mtx.yOffset;
+    glyph.minHeight       = mtx.minHeight;
+    glyph.width           = (mtx.minWidth + 3) & ~3;
+    glyph.height          = mtx.minHeight;
+    if (glyph.width == 0) {
+        glyph.width = 4;
+    }
+    if (glyph.height == 0) {
+        glyph.height = 4;
+    }
+
+    if (!mAtlas || (uint32_t) glyph.width * glyph.height > CELL_SIZE * CELL_SIZE) {
+        entry.inAtlas = false;
+        return renderToScratch(font, entry);
+    }
+
+    // sft_render doesn't touch the bitmap of empty glyphs
+    auto *cell = &mAtlas[(&entry - mEntries) * CELL_SIZE * CELL_SIZE];
+    memset(cell, 0, glyph.width * glyph.height);
+    if (sft_render(&font, entry.gid, {.pixels = cell, .width = glyph.width, .height = glyph.height}) < 0) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to render glyph");
+        return false;
+    }
+    entry.inAtlas = true;
+    glyph.pixels  = cell;
+    return true;
+}
+
+bool GlyphCache::renderToScratch(const SFT &font, Entry &entry) {
+    auto &glyph   = entry.glyph;
+    uint32_t size = (uint32_t) glyph.width * glyph.height;
+    if (size > mScratchSize) {
+        mScratch = make_unique_nothrow<uint8_t[]>((size_t) size);
+        if (!mScratch) {
+            DEBUG_FUNCTION_LINE_ERR("Failed to allocate memory for glyph");
+            mScratchSize = 0;
+            return false;
+        }
+        mScratchSize = size;
+    }
+    memset(mScratch.get(), 0, size);
+    if (sft_render(&font, entry.gid, {.pixels = mScratch.get(), .width = glyph.width, .height = glyph.height}) < 0) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to render glyph");
+        return false;
+    }
+    glyph.pixels = mScratch.get();
+    return true;
+}
+
+void GlyphCache::lruUnlink(uint16_t index) {
+    auto &entry = mEntries[index];
+    if (entry.lruPrev != INVALID_INDEX) {
+        mEntries[entry.lruPrev].lruNext = entry.lruNext;
+    } else {
+        mLruHead = entry.lruNext;
+    }
+    if (entry.lruNext != INVALID_INDEX) {
+        mEntries[entry.lruNext].lruPrev = entry.lruPrev;
+    } else {
+        mLruTail = entry.lruPrev;
+    }
+    entry.lruPrev = INVALID_INDEX;
+    entry.lruNext = INVALID_INDEX;
+}
+
+void GlyphCache::lruPushFront(uint16_t index) {
+    auto &entry   = mEntries[index];
+    entry.lruPrev = INVALID_INDEX;
+    entry.lruNext = mLruHead;
+    if (mLruHead != INVALID_INDEX) {
+        mEntries[mLruHead].lruPrev = index;
+    } else {
+        mLruTail = index;
+    }
+    mLruHead = index;
+}
+
+void GlyphCache::lruPushBack(uint16_t index) {
+    auto &entry   = mEntries[index];
+    entry.lruPrev = mLruTail;
+    entry.lruNext = INVALID_INDEX;
+    if (mLruTail != INVALID_INDEX) {
+        mEntries[mLruTail].lruNext = index;
+    } else {
+        mLruHead = index;
+    }
+    mLruTail = index;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "schrift.h"
+#include <cstdint>
+#include <memory>
+
+/**
+ * Caches the metrics and the rendered bitmap of glyphs, keyed by codepoint and font size.
+ *
+ * Bitmaps are stored in a fixed-size atlas of MAX_GLYPHS cells with CELL_SIZE * CELL_SIZE bytes each. Once all cells
+ * are used, the least recently used glyph gets evicted. Glyphs which don't fit into a cell only get their metrics
+ * cached and are rendered into a scratch buffer every time.
+ */
+class GlyphCache {
+public:
+    static constexpr uint32_t CELL_SIZE  = 32;
+    static constexpr uint32_t MAX_GLYPHS = 128;
+
+    struct Glyph {
+        // False if the font has no glyph for this codepoint
+        bool exists;
+        float advanceWidth;
+        float leftSideBearing;
+        int32_t yOffset;
+        uint32_t minHeight;
+        // Size of the bitmap, the width is a multiple of 4
+        uint16_t width;
+        uint16_t height;
+        // Coverage bitmap of width * height bytes
+        const uint8_t *pixels;
+    };
+
+    GlyphCache();
+
+    /**
+     * Allocates the atlas. Without an atlas every glyph gets rendered on demand.
+     */
+    bool init();
+
+    /**
+     * Drops all glyphs and frees the atlas, needs to be called whenever the font changes.
+     */
+    void deinit();
+
+    /**
+     * Returns the glyph for the codepoint rendered with the current font size of the font.
+     * The returned glyph is only valid until the next call. Returns nullptr if the glyph couldn't be rendered.
+     */
+    const Glyph *get(const SFT &font, uint32_t codepoint);
+
+    [[nodiscard]] uint32_t getHits() const {
+        return mHits;
+    }
+
+    [[nodiscard]] uint32_t getMisses() const {
+        return mMisses;
+    }
+
+private:
+    static constexpr uint16_t INVALID_INDEX = 0xFFFF;
+    static constexpr uint32_t BUCKET_COUNT  = 256;
+
+    struct Entry {
+        Glyph glyph;
+        SFT_Glyph gid;
+        uint32_t codepoint;
+        uint32_t fontSize;
+        // Whether the bitmap is stored in the atlas cell of this entry
+        bool inAtlas;
+        uint16_t hashNext;
+        uint16_t lruPrev;
+        uint16_t lruNext;
+    };
+
+    static uint32_t GetBucket(uint32_t codepoint, uint32_t fontSize) {
+        return (codepoint * 31 + fontSize) % BUCKET_COUNT;
+    }
+
+    uint16_t find(uint32_t codepoint, uint32_t fontSize);
+
+    uint16_t allocateEntry();
+
+    bool fillEntry(const SFT &font, Entry &entry);
+
+    bool renderToScratch(const SFT &font, Entry &entry);
+
+    void lruUnlink(uint16_t index);
+
+    void lruPushFront(uint16_t index);
+
+    void lruPushBack(uint16_t index);
+
+    Entry mEntries[MAX_GLYPHS]{};
+    uint16_t mBuckets[BUCKET_COUNT]{};
+    uint16_t mUsedEntries = 0;
+    uint16_t mLruHead     = INVALID_INDEX;
+    uint16_t mLruTail     = INVALID_INDEX;
+
+    std::unique_ptr<uint8_t[]> mAtlas;
+    std::unique_ptr<uint8_t[]> mScratch;
+    uint32_t mScratchSize = 0;
+
+    uint32_t mHits   = 0;
+    uint32_t mMisses = 0;
+};
@@ -0,0 +1,78 @@
+#include "ImageCache.h"
+#include "logger.h"
+
+// Rounded division by 255 for values up to 255 * 255
+static inline uint32_t div255(uint32_t value) {
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+const ImageCache::Image *ImageCache::find(const uint8_t *data, uint32_t width, uint32_t height) {
+    mUncached = {};
+    for (auto &entry : mEntries) {
+        if (entry.data == data && entry.requestedWidth == width && entry.requestedHeight == height) {
+            entry.lastUse = ++mUseCounter;
+            return &entry.image;
+        }
+    }
+    return nullptr;
+}
+
+const ImageCache::Image *ImageCache::insert(const uint8_t *data, uint32_t width, uint32_t height, std::unique_ptr<Color[]> pixels, uint32_t imageWidth, uint32_t imageHeight) {
+    uint32_t count = imageWidth * imageHeight;
+    for (uint32_t i = 0; i < count; i++) {
+        auto &pixel = pixels[i];
+        if (pixel.a != 0xFF) {
+            pixel = Color(div255(pixel.r * pixel.a), div255(pixel.g * pixel.a), div255(pixel.b * pixel.a), pixel.a);
+        }
+    }
+
+    Entry entry = {
+            .data            = data,
+            .requestedWidth  = width,
+            .requestedHeight = height,
+            .lastUse         = ++mUseCounter,
+            .image           = {.width = imageWidth, .height = imageHeight, .pixels = pixels.get()},
+            .pixels          = std::move(pixels),
+    };
+
+    uint32_t size = GetSize(entry);
+    if (size > MAX_MEMORY) {
+        DEBUG_FUNCTION_LINE_VERBOSE("Image %08X is too big to be cached (%u bytes)", data, size);
+        mUncached = std::move(entry);
+        return &mUncached.image;
+    }
+    evict(size);
+    mMemoryUsed += size;
+    mEntries.push_back(std::move(entry));
+    return &mEntries.back().image;
+}
+
+void ImageCache::evict(uint32_t size) {
+    while (!mEntries.empty() && mMemoryUsed + size > MAX_MEMORY) {
+        auto lru = mEntries.begin();
+        for (auto itr = mEntries.begin(); itr != mEntries.end(); ++itr) {
+            if (itr->lastUse < lru->lastUse) {
+                lru = itr;
+            }
+        }
+        mMemoryUsed -= GetSize(*lru);
+        mEntries.erase(lru);
+    }
+}
+
+void ImageCache::invalidate(const uint8_t *data) {
+    std::erase_if(mEntries, [this, data](const Entry &entry) {
+        if (entry.data != data) {
+            return false;
+        }
+        mMemoryUsed -= GetSize(entry);
+        return true;
+    });
+}
+
+void ImageCache::clear() {
+    mEntries.clear();
+    mUncached   = {};
+    mMemoryUsed = 0;
+}
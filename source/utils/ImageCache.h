@@ -0,0 +1,66 @@
+#pragma once
+
+#include "DrawUtils.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Caches decoded images, keyed by the address of the encoded data and the requested size.
+ *
+ * Pixels are stored with premultiplied alpha. Once the cached images exceed MAX_MEMORY bytes, the least recently used
+ * images get evicted. The cache can't notice when the encoded data changes or gets freed, invalidate() has to be
+ * called in that case.
+ */
+class ImageCache {
+public:
+    static constexpr uint32_t MAX_MEMORY = 512 * 1024;
+
+    struct Image {
+        uint32_t width;
+        uint32_t height;
+        // width * height pixels with premultiplied alpha
+        const Color *pixels;
+    };
+
+    /**
+     * Returns the cached image or nullptr. width and height are the requested size, 0 for the native size.
+     */
+    const Image *find(const uint8_t *data, uint32_t width, uint32_t height);
+
+    /**
+     * Takes the decoded straight alpha pixels, premultiplies them and caches them if they fit into MAX_MEMORY.
+     * The returned image is valid until the next call of any other function. Images which are too big are only kept
+     * until then.
+     */
+    const Image *insert(const uint8_t *data, uint32_t width, uint32_t height, std::unique_ptr<Color[]> pixels, uint32_t imageWidth, uint32_t imageHeight);
+
+    /**
+     * Drops all images decoded from data.
+     */
+    void invalidate(const uint8_t *data);
+
+    void clear();
+
+private:
+    struct Entry {
+        const uint8_t *data;
+        uint32_t requestedWidth;
+        uint32_t requestedHeight;
+        uint32_t lastUse;
+        Image image;
+        std::unique_ptr<Color[]> pixels;
+    };
+
+    static uint32_t GetSize(const Entry &entry) {
+        return entry.image.width * entry.image.height * sizeof(Color);
+    }
+
+    void evict(uint32_t size);
+
+    std::vector<Entry> mEntries;
+    // The last uncacheable image
+    Entry mUncached{};
+    uint32_t mMemoryUsed = 0;
+    uint32_t mUseCounter = 0;
+};
@@ -0,0 +1,132 @@
+#include "OSScreenBackend.h"
+#include "dc.h"
+#include "logger.h"
+#include <avm/tv.h>
+#include <coreinit/cache.h>
+#include <coreinit/screen.h>
+#include <coreinit/time.h>
+#include <gx2/event.h>
+
+// buffer width
+#define DRC_WIDTH 0x380
+
+OSScreenBackend::OSScreenBackend(void *tvBuffer, uint32_t tvSize, void *drcBuffer, uint32_t drcSize) {
+    bool bigScale = true;
+    switch (TVEGetCurrentPort()) {
+        case TVE_PORT_HDMI:
+            bigScale = true;
+            break;
+        case TVE_PORT_COMPONENT:
+        case TVE_PORT_COMPOSITE:
+        case TVE_PORT_SCART:
+            bigScale = false;
+            break;
+    }
+
+    AVMTvResolution tvResolution = AVM_TV_RESOLUTION_720P;
+    if (AVMGetTVScanMode(&tvResolution)) {
+        switch (tvResolution) {
+            case AVM_TV_RESOLUTION_480P:
+            case AVM_TV_RESOLUTION_720P:
+            case AVM_TV_RESOLUTION_720P_3D:
+            case AVM_TV_RESOLUTION_1080I:
+            case AVM_TV_RESOLUTION_1080P:
+            case AVM_TV_RESOLUTION_576P:
+            case AVM_TV_RESOLUTION_720P_50HZ:
+            case AVM_TV_RESOLUTION_1080I_50HZ:
+            case AVM_TV_RESOLUTION_1080P_50HZ:
+                bigScale = true;
+                break;
+            case AVM_TV_RESOLUTION_576I:
+            case AVM_TV_RESOLUTION_480I:
+            case AVM_TV_RESOLUTION_480I_PAL60:
+                break;
+        }
+    }
+
+    auto tvScanBufferWidth = DCReadReg32(SCREEN_TV, D1GRPH_X_END_REG);
+    uint32_t tvWidth;
+
+    if (tvScanBufferWidth == 640) { // 480i/480p/576i 4:3
+        tvWidth = 640;
+        SetDCPitchReg(SCREEN_TV, 640);
+        mTVScale = bigScale ? 0.75 : 0.75f;
+    } else if (tvScanBufferWidth == 854) { // 480i/480p/576i 16:9
+        tvWidth = 896;
+        SetDCPitchReg(SCREEN_TV, 896);
+        mTVScale = bigScale ? 1.0 : 1.0f;
+    } else if (tvScanBufferWidth == 1280) { // 720p 16:9
+        tvWidth = 1280;
+        SetDCPitchReg(SCREEN_TV, 1280);
+        if (bigScale) {
+            mTVScale = 1.5;
+        } else {
+            mTVScale = 0.75f;
+            if (tvResolution == AVM_TV_RESOLUTION_480I_PAL60 || tvResolution == AVM_TV_RESOLUTION_480I) {
+                AVMTvAspectRatio tvAspectRatio;
+                if (AVMGetTVAspectRatio(&tvAspectRatio) && tvAspectRatio == AVM_TV_ASPECT_RATIO_16_9) {
+                    DEBUG_FUNCTION_LINE_WARN("force big scaling for 480i + 16:9");
+                    mTVScale = 1.5;
+                }
+            }
+        }
+    } else if (tvScanBufferWidth == 1920) { // 1080i/1080p 16:9
+        tvWidth = 1920;
+        SetDCPitchReg(SCREEN_TV, 1920);
+        mTVScale = bigScale ? 2.25 : 1.125f;
+    } else {
+        tvWidth = tvScanBufferWidth;
+        SetDCPitchReg(SCREEN_TV, tvScanBufferWidth);
+        mTVScale = 1.0f;
+        DEBUG_FUNCTION_LINE_WARN("Unknown tv width detected, config menu might not show properly");
+    }
+
+    mTV  = {.buffer = (uint8_t *) tvBuffer, .size = tvSize, .pitch = tvWidth, .height = tvWidth ? (tvSize / 2) / (tvWidth * 4) : 0};
+    mDRC = {.buffer = (uint8_t *) drcBuffer, .size = drcSize, .pitch = DRC_WIDTH, .height = (drcSize / 2) / (DRC_WIDTH * 4)};
+}
+
+uint32_t OSScreenBackend::getBackBufferIndex() {
+    uint32_t pixel = *(uint32_t *) mTV.buffer;
+
+    // check which buffer is currently used
+    OSScreenPutPixelEx(SCREEN_TV, 0, 0, 0xABCDEF90);
+    mBackBufferIndex = *(uint32_t *) mTV.buffer == 0xABCDEF90 ? 0 : 1;
+
+    // restore the pixel we used for checking
+    *(uint32_t *) mTV.buffer = pixel;
+    return mBackBufferIndex;
+}
+
+void OSScreenBackend::clear(uint32_t color) {
+    OSScreenClearBufferEx(SCREEN_TV, color);
+    OSScreenClearBufferEx(SCREEN_DRC, color);
+}
+
+static void FlushRows(const ScreenBackend::Surface &surface, uint32_t backBufferIndex, ScreenBackend::RowRange rows) {
+    if (rows.end > surface.height) {
+        rows.end = surface.height;
+    }
+    if (rows.start >= rows.end) {
+        return;
+    }
+    uint32_t rowSize = surface.pitch * 4;
+    DCFlushRange(surface.buffer + backBufferIndex * (surface.size / 2) + rows.start * rowSize, (rows.end - rows.start) * rowSize);
+}
+
+void OSScreenBackend::present(RowRange tvRows, RowRange drcRows) {
+    // OSScreenFlipBuffersEx doesn't flush the data cache
+    FlushRows(mTV, mBackBufferIndex, tvRows);
+    FlushRows(mDRC, mBackBufferIndex, drcRows);
+
+    OSScreenFlipBuffersEx(SCREEN_DRC);
+    OSScreenFlipBuffersEx(SCREEN_TV);
+}
+
+void OSScreenBackend::waitForVSync() {
+    // The menu runs on the GX2 thread of the application, so GX2 is always initialized.
+    GX2WaitForVsync();
+}
+
+uint64_t OSScreenBackend::getTime() {
+    return OSTicksToMicroseconds(OSGetTime());
+}
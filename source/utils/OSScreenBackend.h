@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ScreenBackend.h"
+
+/**
+ * Renders via OSScreen into the given buffers, OSScreen has to be initialized and set up to use these buffers.
+ * Changes the pitch of the TV to match the scan buffer width, the caller is responsible for restoring the DC registers.
+ */
+class OSScreenBackend : public ScreenBackend {
+public:
+    OSScreenBackend(void *tvBuffer, uint32_t tvSize, void *drcBuffer, uint32_t drcSize);
+
+    ~OSScreenBackend() override = default;
+
+    [[nodiscard]] Surface getTVSurface() const override {
+        return mTV;
+    }
+
+    [[nodiscard]] Surface getDRCSurface() const override {
+        return mDRC;
+    }
+
+    [[nodiscard]] float getTVScale() const override {
+        return mTVScale;
+    }
+
+    uint32_t getBackBufferIndex() override;
+
+    void clear(uint32_t color) override;
+
+    void present(RowRange tvRows, RowRange drcRows) override;
+
+    void waitForVSync() override;
+
+    uint64_t getTime() override;
+
+private:
+    Surface mTV{};
+    Surface mDRC{};
+    float mTVScale            = 1.5f;
+    uint32_t mBackBufferIndex = 0;
+};
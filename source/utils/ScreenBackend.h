@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The screens DrawUtils renders to. Each screen is double buffered, its buffer holds two frames of RGBA8 pixels and
+ * getBackBufferIndex() selects the frame that is drawn to.
+ */
+class ScreenBackend {
+public:
+    struct Surface {
+        uint8_t *buffer;
+        // Size of both frames in bytes
+        uint32_t size;
+        // Width of a row in pixels
+        uint32_t pitch;
+        // Visible rows of a frame
+        uint32_t height;
+    };
+
+    // Rows [start, end) of a frame
+    struct RowRange {
+        uint32_t start;
+        uint32_t end;
+    };
+
+    virtual ~ScreenBackend() = default;
+
+    [[nodiscard]] virtual Surface getTVSurface() const = 0;
+
+    [[nodiscard]] virtual Surface getDRCSurface() const = 0;
+
+    /**
+     * Scale from the SCREEN_WIDTH x SCREEN_HEIGHT screen space to the TV.
+     */
+    [[nodiscard]] virtual float getTVScale() const = 0;
+
+    /**
+     * Index (0 or 1) of the frame that is currently not displayed.
+     */
+    virtual uint32_t getBackBufferIndex() = 0;
+
+    /**
+     * Fills the back buffer of both screens with color.
+     */
+    virtual void clear(uint32_t color) = 0;
+
+    /**
+     * Writes the given rows of the back buffers back to memory and displays the back buffer of both screens.
+     * Rows outside of the ranges have to be unchanged since the last present().
+     */
+    virtual void present(RowRange tvRows, RowRange drcRows) = 0;
+
+    /**
+     * Blocks until the next vertical blank.
+     */
+    virtual void waitForVSync() = 0;
+
+    /**
+     * Monotonic time in microseconds.
+     */
+    virtual uint64_t getTime() = 0;
+};
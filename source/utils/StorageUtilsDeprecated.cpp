@@ -8,46 +8,90 @@
 #include "utils/logger.h"
 
 namespace WUPSStorageDeprecated {
-    static void processJson(wups_storage_item_t *items, nlohmann::json json) {
+    /**
+     * The plugin side of this API takes ownership of the created tree. It reallocs the item arrays and frees keys and values
+     * individually (when storing, deleting and closing), so every item has to stay a separate heap allocation.
+     */
+    static bool processJson(wups_storage_item_t *items, const nlohmann::json &json) {
         if (items == nullptr) {
-            return;
+            return false;
+        }
+
+        items->data      = nullptr;
+        items->data_size = 0;
+        if (json.empty()) {
+            return true;
         }
 
-        items->data      = (wups_storage_item_t *) malloc(json.size() * sizeof(wups_storage_item_t));
+        // Zero initialized, so a partially created tree can be freed safely.
+        auto *childItems = (wups_storage_item_t *) calloc(json.size(), sizeof(wups_storage_item_t));
+        if (!childItems) {
+            return false;
+        }
+        items->data      = childItems;
         items->data_size = json.size();
 
         uint32_t index = 0;
         for (auto it = json.begin(); it != json.end(); ++it) {
-            wups_storage_item_t *item = &((wups_storage_item_t *) items->data)[index];
-            item->type                = WUPS_STORAGE_TYPE_INVALID;
-            item->deleted             = false;
-            item->data                = nullptr;
-            item->key                 = nullptr;
+            wups_storage_item_t *item = &childItems[index++];
 
-            item->key = (char *) malloc(it.key().size() + 1);
-            strcpy(item->key, it.key().c_str());
+            const auto &key = it.key();
+            item->key       = (char *) malloc(key.size() + 1);
+            if (!item->key) {
+                return false;
+            }
+            memcpy(item->key, key.c_str(), key.size() + 1);
 
-            if (it.value().is_string()) {
-                item->type      = WUPS_STORAGE_TYPE_STRING;
-                uint32_t size   = it.value().get<std::string>().size() + 1;
+            const auto &value = it.value();
+            if (value.is_string()) {
+                const auto &str = value.get_ref<const std::string &>();
+                uint32_t size   = str.size() + 1;
                 item->data      = malloc(size);
+                if (!item->data) {
+                    return false;
+                }
+                item->type      = WUPS_STORAGE_TYPE_STRING;
                 item->data_size = size;
-                strcpy((char *) item->data, it.value().get<std::string>().c_str());
-            } else if (it.value().is_number_integer()) {
+                memcpy(item->data, str.c_str(), size);
+            } else if (value.is_number_integer()) {
+                item->data = malloc(sizeof(int32_t));
+                if (!item->data) {
+                    return false;
+                }
                 item->type              = WUPS_STORAGE_TYPE_INT;
-                item->data              = malloc(sizeof(int32_t));
                 item->data_size         = sizeof(int32_t);
-                *(int32_t *) item->data = it.value().get<int32_t>();
-            } else if (it.value().is_object()) {
-                if (it.value().size() > 0) {
+                *(int32_t *) item->data = value.get<int32_t>();
+            } else if (value.is_object()) {
+                if (!value.empty()) {
                     item->type = WUPS_STORAGE_TYPE_ITEM;
-                    processJson(item, it.value());
+                    if (!processJson(item, value)) {
+                        return false;
+                    }
                 }
             } else {
-                DEBUG_FUNCTION_LINE_ERR("Unknown type %s for value %s", it.value().type_name(), it.key().c_str());
+                DEBUG_FUNCTION_LINE_ERR("Unknown type %s for value %s", value.type_name(), key.c_str());
+            }
+        }
+        return true;
+    }
+
+    static void freeItems(wups_storage_item_t *items) {
+        if (items->data == nullptr) {
+            return;
+        }
+        auto *childItems = (wups_storage_item_t *) items->data;
+        for (uint32_t i = 0; i < items->data_size; i++) {
+            auto *item = &childItems[i];
+            if (item->type == WUPS_STORAGE_TYPE_ITEM) {
+                freeItems(item);
+            } else {
+                free(item->data);
             }
-            index++;
+            free(item->key);
         }
+        free(childItems);
+        items->data      = nullptr;
+        items->data_size = 0;
     }
 
     WUPSStorageError StorageUtils::OpenStorage(const char *plugin_id, wups_storage_item_t *items) {
@@ -60,7 +104,10 @@ namespace WUPSStorageDeprecated {
         nlohmann::json j;
         CFile file(filePath, CFile::ReadOnly);
         if (file.isOpen() && file.size() > 0) {
-            auto *json_data        = (uint8_t *) memalign(0x40, ROUNDUP(file.size() + 1, 0x40));
+            auto *json_data = (uint8_t *) memalign(0x40, ROUNDUP(file.size() + 1, 0x40));
+            if (!json_data) {
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
             json_data[file.size()] = '\0';
 
             file.read(json_data, file.size());
@@ -82,7 +129,16 @@ namespace WUPSStorageDeprecated {
             return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-        processJson(items, j["storageitems"]);
+        auto storageItems = j.find("storageitems");
+        if (storageItems == j.end() || !storageItems->is_object()) {
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        if (!processJson(items, *storageItems)) {
+            DEBUG_FUNCTION_LINE_ERR("Failed to allocate storage items for \"%s\"", plugin_id);
+            freeItems(items);
+            return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+        }
 
         return WUPS_STORAGE_ERROR_SUCCESS;
     }
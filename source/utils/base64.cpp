@@ -2,126 +2,209 @@
 
 #include <string.h>
 
-static const char b64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-size_t b64_encoded_size(size_t inlen) {
-    size_t ret;
+// Table driven codec which handles a full 3 byte / 4 char group per iteration.
+// On big-endian targets (PPC) the groups are loaded/stored as whole words.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define B64_WORD_AT_A_TIME 1
+#else
+#define B64_WORD_AT_A_TIME 0
+#endif
+
+namespace {
+    constexpr char b64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Any valid group decodes into 24 bits, invalid chars set a bit above that.
+    constexpr uint32_t B64_INVALID = 0x01000000;
+
+    struct DecodeTables {
+        // One table per char position of a group, the values are already shifted into place.
+        uint32_t shifted[4][256];
+    };
+
+    constexpr DecodeTables makeDecodeTables() {
+        DecodeTables res{};
+        for (uint32_t pos = 0; pos < 4; pos++) {
+            for (uint32_t c = 0; c < 256; c++) {
+                res.shifted[pos][c] = B64_INVALID;
+            }
+            for (uint32_t i = 0; i < 64; i++) {
+                res.shifted[pos][(uint8_t) b64chars[i]] = i << (18 - 6 * pos);
+            }
+        }
+        return res;
+    }
 
-    ret = inlen;
-    if (inlen % 3 != 0)
-        ret += 3 - (inlen % 3);
-    ret /= 3;
-    ret *= 4;
+    constexpr DecodeTables b64decode = makeDecodeTables();
 
-    return ret;
-}
+    inline uint32_t decodeGroup(const char *in) {
+#if B64_WORD_AT_A_TIME
+        uint32_t w;
+        memcpy(&w, in, 4);
+        return b64decode.shifted[0][w >> 24] | b64decode.shifted[1][(w >> 16) & 0xFF] | b64decode.shifted[2][(w >> 8) & 0xFF] | b64decode.shifted[3][w & 0xFF];
+#else
+        return b64decode.shifted[0][(uint8_t) in[0]] | b64decode.shifted[1][(uint8_t) in[1]] | b64decode.shifted[2][(uint8_t) in[2]] | b64decode.shifted[3][(uint8_t) in[3]];
+#endif
+    }
 
-char *b64_encode(const uint8_t *in, size_t len) {
-    char *out;
-    size_t elen;
-    size_t i;
-    size_t j;
-    size_t v;
+    inline void encodeGroup(uint32_t v, char *out) {
+#if B64_WORD_AT_A_TIME
+        uint32_t w = ((uint32_t) (uint8_t) b64chars[(v >> 18) & 0x3F] << 24) | ((uint32_t) (uint8_t) b64chars[(v >> 12) & 0x3F] << 16) |
+                     ((uint32_t) (uint8_t) b64chars[(v >> 6) & 0x3F] << 8) | (uint32_t) (uint8_t) b64chars[v & 0x3F];
+        memcpy(out, &w, 4);
+#else
+        out[0] = b64chars[(v >> 18) & 0x3F];
+        out[1] = b64chars[(v >> 12) & 0x3F];
+        out[2] = b64chars[(v >> 6) & 0x3F];
+        out[3] = b64chars[v & 0x3F];
+#endif
+    }
 
-    if (in == NULL || len == 0)
-        return NULL;
+    /**
+     * out needs to hold b64_encoded_size(len) chars.
+     */
+    void encode(const uint8_t *in, size_t len, char *out) {
+        size_t i = 0;
+#if B64_WORD_AT_A_TIME
+        // Load a whole word while there is at least one byte after the current group.
+        for (; i + 4 <= len; i += 3, out += 4) {
+            uint32_t w;
+            memcpy(&w, in + i, 4);
+            encodeGroup(w >> 8, out);
+        }
+#endif
+        for (; i + 3 <= len; i += 3, out += 4) {
+            encodeGroup(((uint32_t) in[i] << 16) | ((uint32_t) in[i + 1] << 8) | in[i + 2], out);
+        }
 
-    elen      = b64_encoded_size(len);
-    out       = (char *) malloc(elen + 1);
-    out[elen] = '\0';
+        size_t rest = len - i;
+        if (rest > 0) {
+            uint32_t v = (uint32_t) in[i] << 16;
+            if (rest > 1) {
+                v |= (uint32_t) in[i + 1] << 8;
+            }
+            out[0] = b64chars[(v >> 18) & 0x3F];
+            out[1] = b64chars[(v >> 12) & 0x3F];
+            out[2] = rest > 1 ? b64chars[(v >> 6) & 0x3F] : '=';
+            out[3] = '=';
+        }
+    }
 
-    for (i = 0, j = 0; i < len; i += 3, j += 4) {
-        v = in[i];
-        v = i + 1 < len ? v << 8 | in[i + 1] : v << 8;
-        v = i + 2 < len ? v << 8 | in[i + 2] : v << 8;
+    size_t decodedSize(const char *in, size_t len) {
+        if (len == 0 || len % 4 != 0) {
+            return 0;
+        }
+        size_t ret = len / 4 * 3;
+        if (in[len - 1] == '=') {
+            ret--;
+            if (in[len - 2] == '=') {
+                ret--;
+            }
+        }
+        return ret;
+    }
 
-        out[j]     = b64chars[(v >> 18) & 0x3F];
-        out[j + 1] = b64chars[(v >> 12) & 0x3F];
-        if (i + 1 < len) {
-            out[j + 2] = b64chars[(v >> 6) & 0x3F];
-        } else {
-            out[j + 2] = '=';
+    /**
+     * out needs to hold decodedSize(in, len) bytes, len needs to be a multiple of 4.
+     */
+    bool decode(const char *in, size_t len, uint8_t *out) {
+        if (len == 0) {
+            return true;
+        }
+        // Collect the invalid bit of all groups and check it once at the end.
+        uint32_t invalid = 0;
+
+        // The last group may contain padding and is handled separately.
+        const char *last = in + len - 4;
+        for (; in < last; in += 4, out += 3) {
+            uint32_t v = decodeGroup(in);
+            invalid |= v;
+#if B64_WORD_AT_A_TIME
+            // The byte which is written past the group gets overwritten by the next group.
+            v <<= 8;
+            memcpy(out, &v, 4);
+#else
+            out[0] = v >> 16;
+            out[1] = v >> 8;
+            out[2] = v;
+#endif
         }
-        if (i + 2 < len) {
-            out[j + 3] = b64chars[v & 0x3F];
+
+        if (in[3] == '=') {
+            uint32_t v = b64decode.shifted[0][(uint8_t) in[0]] | b64decode.shifted[1][(uint8_t) in[1]];
+            if (in[2] == '=') {
+                invalid |= v;
+                out[0] = v >> 16;
+            } else {
+                v |= b64decode.shifted[2][(uint8_t) in[2]];
+                invalid |= v;
+                out[0] = v >> 16;
+                out[1] = v >> 8;
+            }
         } else {
-            out[j + 3] = '=';
+            uint32_t v = decodeGroup(in);
+            invalid |= v;
+            out[0] = v >> 16;
+            out[1] = v >> 8;
+            out[2] = v;
         }
+        return (invalid & B64_INVALID) == 0;
     }
+} // namespace
 
-    return out;
+size_t b64_encoded_size(size_t inlen) {
+    return (inlen + 2) / 3 * 4;
 }
 
-size_t b64_decoded_size(const char *in) {
-    size_t len;
-    size_t ret;
-    size_t i;
+char *b64_encode(const uint8_t *in, size_t len) {
+    if (in == NULL || len == 0)
+        return NULL;
 
-    if (in == NULL)
-        return 0;
+    size_t elen = b64_encoded_size(len);
+    auto *out   = (char *) malloc(elen + 1);
+    if (out == NULL)
+        return NULL;
 
-    len = strlen(in);
-    ret = len / 4 * 3;
+    encode(in, len, out);
+    out[elen] = '\0';
 
-    for (i = len; i-- > 0;) {
-        if (in[i] == '=') {
-            ret--;
-        } else {
-            break;
-        }
-    }
+    return out;
+}
 
-    return ret;
+bool b64_encode(const uint8_t *in, size_t len, std::string &out) {
+    if (in == nullptr || len == 0) {
+        return false;
+    }
+    out.resize(b64_encoded_size(len));
+    encode(in, len, out.data());
+    return true;
 }
 
-static const int b64invs[] = {
-        62, -1, -1, -1, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3,
-        4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
-        -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
-
-static int b64_isvalidchar(char c) {
-    if (c >= '0' && c <= '9')
-        return 1;
-    if (c >= 'A' && c <= 'Z')
-        return 1;
-    if (c >= 'a' && c <= 'z')
-        return 1;
-    if (c == '+' || c == '/' || c == '=')
-        return 1;
-    return 0;
+size_t b64_decoded_size(const char *in) {
+    if (in == NULL)
+        return 0;
+
+    return decodedSize(in, strlen(in));
 }
 
 int b64_decode(const char *in, uint8_t *out, size_t outlen) {
-    size_t len;
-    size_t i;
-    size_t j;
-    int v;
-
     if (in == NULL || out == NULL)
         return 0;
 
-    len = strlen(in);
-    if (outlen < b64_decoded_size(in) || len % 4 != 0)
+    size_t len = strlen(in);
+    if (len % 4 != 0 || outlen < decodedSize(in, len))
         return 0;
 
-    for (i = 0; i < len; i++) {
-        if (!b64_isvalidchar(in[i])) {
-            return 0;
-        }
-    }
+    return decode(in, len, out) ? 1 : 0;
+}
 
-    for (i = 0, j = 0; i < len; i += 4, j += 3) {
-        v = b64invs[in[i] - 43];
-        v = (v << 6) | b64invs[in[i + 1] - 43];
-        v = in[i + 2] == '=' ? v << 6 : (v << 6) | b64invs[in[i + 2] - 43];
-        v = in[i + 3] == '=' ? v << 6 : (v << 6) | b64invs[in[i + 3] - 43];
-
-        out[j] = (v >> 16) & 0xFF;
-        if (in[i + 2] != '=')
-            out[j + 1] = (v >> 8) & 0xFF;
-        if (in[i + 3] != '=')
-            out[j + 2] = v & 0xFF;
+bool b64_decode(std::string_view in, std::vector<uint8_t> &out) {
+    if (in.size() % 4 != 0) {
+        return false;
     }
-
-    return 1;
+    out.resize(decodedSize(in.data(), in.size()));
+    if (!decode(in.data(), in.size(), out.data())) {
+        out.clear();
+        return false;
+    }
+    return true;
 }
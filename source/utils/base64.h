@@ -17,4 +17,18 @@ int b64_decode(const char *in, uint8_t *out, size_t outlen);
 
 #ifdef __cplusplus
 }
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Encodes into the given string. Returns false on empty input.
+ */
+bool b64_encode(const uint8_t *in, size_t len, std::string &out);
+
+/**
+ * Decodes directly into the given vector. Returns false (and clears `out`) if the input is not valid base64.
+ */
+bool b64_decode(std::string_view in, std::vector<uint8_t> &out);
 #endif
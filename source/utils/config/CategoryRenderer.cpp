@@ -30,10 +30,7 @@ CategoryRenderer::CategoryRenderer(const GeneralConfigInformation *info, const W
     }
 
     // Make sure to call Update to get the current text of an item.
-    for (uint32_t i = 0; i < mItemRenderer.size(); i++) {
-        bool isHighlighted = ((int) i == mCursorPos);
-        mItemRenderer[i]->Update(isHighlighted);
-    }
+    UpdateVisibleItems();
 }
 
 CategoryRenderer::~CategoryRenderer() {
@@ -53,6 +50,7 @@ ConfigSubState CategoryRenderer::Update(Input &input, const WUPSConfigSimplePadD
             if (mSubCategoryRenderer) {
                 auto subResult = mSubCategoryRenderer->Update(input, simpleInputData, complexInputData);
                 if (subResult != SUB_STATE_RUNNING) {
+                    mDirtyRegions.invalidateAll();
                     mNeedsRedraw = true;
                     mState       = STATE_MAIN;
                     mFirstFrame  = true;
@@ -79,6 +77,7 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
 
     auto totalElementSize    = mItemRenderer.size();
     int32_t prevSelectedItem = mCursorPos;
+    int32_t prevRenderOffset = mRenderOffset;
 
     if (mIsItemMovementAllowed) {
         if (input.data.buttons_d & Input::eButtons::BUTTON_DOWN) {
@@ -93,6 +92,9 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
                 if (mCurrentOpen != mCursorPos) {
                     mSubCategoryRenderer.reset();
                     mSubCategoryRenderer = make_unique_nothrow<CategoryRenderer>(mInfo, mCat->getCategories()[mCursorPos].get(), false);
+                } else if (mSubCategoryRenderer) {
+                    // The screen content of the renderer has been overwritten in the meantime.
+                    mSubCategoryRenderer->Invalidate();
                 }
                 mCurrentOpen = mCursorPos;
                 mState       = STATE_SUB;
@@ -101,9 +103,11 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
             }
         } else if ((input.data.buttons_h & Input::eButtons::STICK_L_RIGHT) || (input.data.buttons_h & Input::eButtons::STICK_R_RIGHT)) {
             mItemRenderer[mCursorPos]->IncrementTextOffset();
+            mDirtyRegions.invalidate(ConfigLayout::GetRowRect(mCursorPos - mRenderOffset));
             mNeedsRedraw = true;
         } else if ((input.data.buttons_h & Input::eButtons::STICK_L_LEFT) || (input.data.buttons_h & Input::eButtons::STICK_R_LEFT)) {
             mItemRenderer[mCursorPos]->DecrementTextOffset();
+            mDirtyRegions.invalidate(ConfigLayout::GetRowRect(mCursorPos - mRenderOffset));
             mNeedsRedraw = true;
         }
     }
@@ -121,6 +125,13 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
         mRenderOffset = mCursorPos - MAX_BUTTONS_ON_SCREEN + 1;
     }
 
+    if (prevRenderOffset != mRenderOffset) {
+        mDirtyRegions.invalidate(ConfigLayout::LIST_RECT);
+    } else if (prevSelectedItem != mCursorPos) {
+        mDirtyRegions.invalidate(ConfigLayout::GetRowRect(prevSelectedItem - mRenderOffset));
+        mDirtyRegions.invalidate(ConfigLayout::GetRowRect(mCursorPos - mRenderOffset));
+    }
+
     bool posJustChanged = false;
     if (prevSelectedItem != mCursorPos) {
         mItemRenderer[prevSelectedItem]->SetIsSelected(false);
@@ -132,7 +143,9 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
     if (!posJustChanged && !mFirstFrame) {
         // WUPSConfigItemV2
         mItemRenderer[mCursorPos]->OnInput(simpleInputData);
-        mItemRenderer[mCursorPos]->OnInputEx(complexInputData);
+        if (mItemRenderer[mCursorPos]->HasInputEx()) {
+            mItemRenderer[mCursorPos]->OnInputEx(complexInputData);
+        }
 
         // WUPSConfigItemV1
         if (input.data.buttons_d != 0) {
@@ -147,14 +160,39 @@ ConfigSubState CategoryRenderer::UpdateStateMain(Input &input, const WUPSConfigS
 
     mIsItemMovementAllowed = mItemRenderer[mCursorPos]->IsMovementAllowed();
 
-    for (uint32_t i = 0; i < mItemRenderer.size(); i++) {
-        bool isHighlighted = ((int) i == mCursorPos);
+    UpdateVisibleItems();
+
+    return SUB_STATE_RUNNING;
+}
+
+void CategoryRenderer::UpdateVisibleItems() {
+    // The selected item is always visible. Items which are not visible get the current value once they are scrolled
+    // into view, the whole list is redrawn in that case anyway.
+    int32_t end = std::min(mRenderOffset + MAX_BUTTONS_ON_SCREEN, (int32_t) mItemRenderer.size());
+    for (int32_t i = mRenderOffset; i < end; i++) {
+        bool isHighlighted = (i == mCursorPos);
         mItemRenderer[i]->Update(isHighlighted);
+        if (mItemRenderer[i]->NeedsRedraw()) {
+            mDirtyRegions.invalidate(ConfigLayout::GetRowRect(i - mRenderOffset));
+        }
     }
+}
 
-    return SUB_STATE_RUNNING;
+
+bool CategoryRenderer::NeedsComplexInput() const {
+    if (mState == STATE_SUB) {
+        return mSubCategoryRenderer && mSubCategoryRenderer->NeedsComplexInput();
+    }
+    return !mItemRenderer.empty() && mItemRenderer[mCursorPos]->HasInputEx();
 }
 
+void CategoryRenderer::Invalidate() {
+    mDirtyRegions.invalidateAll();
+    mNeedsRedraw = true;
+    if (mSubCategoryRenderer) {
+        mSubCategoryRenderer->Invalidate();
+    }
+}
 
 void CategoryRenderer::ResetNeedsRedraw() {
     mNeedsRedraw = false;
@@ -201,16 +239,17 @@ void CategoryRenderer::Render() const {
 }
 
 void CategoryRenderer::RenderStateMain() const {
+    DrawUtils::beginDraw();
     if (mItemRenderer.empty()) {
-        DrawUtils::beginDraw();
-        RenderMainLayout();
+        mDirtyRegions.redraw(COLOR_BACKGROUND, [this](const DrawRect &region) {
+            RenderMainLayout(region);
 
-        std::string text(mIsRoot ? "This plugin can not be configured" : "This category is empty");
-
-        DrawUtils::setFontSize(24);
-        uint32_t sz = DrawUtils::getTextWidth(text.c_str());
-        DrawUtils::print((SCREEN_WIDTH / 2) - (sz / 2), (SCREEN_HEIGHT / 2), text.c_str());
+            std::string text(mIsRoot ? "This plugin can not be configured" : "This category is empty");
 
+            DrawUtils::setFontSize(24);
+            uint32_t sz = DrawUtils::getTextWidth(text.c_str());
+            DrawUtils::print((SCREEN_WIDTH / 2) - (sz / 2), (SCREEN_HEIGHT / 2), text.c_str());
+        });
         DrawUtils::endDraw();
         return;
     }
@@ -220,50 +259,51 @@ void CategoryRenderer::RenderStateMain() const {
     int start = std::max(0, mRenderOffset);
     int end   = std::min(start + MAX_BUTTONS_ON_SCREEN, totalElementSize);
 
-    DrawUtils::beginDraw();
-
-    RenderMainLayout();
-
-    uint32_t yOffset = 8 + 24 + 8 + 4;
+    mDirtyRegions.redraw(COLOR_BACKGROUND, [&](const DrawRect &region) {
+        RenderMainLayout(region);
 
-    for (int32_t i = start; i < end; i++) {
-        bool isHighlighted = (i == mCursorPos);
-
-        mItemRenderer[i]->Draw(yOffset, isHighlighted);
-        yOffset += 42 + 8;
-    }
+        for (int32_t i = start; i < end; i++) {
+            auto rowRect = ConfigLayout::GetRowRect(i - start);
+            if (rowRect.intersects(region)) {
+                bool isHighlighted = (i == mCursorPos);
+                mItemRenderer[i]->Draw(rowRect.y, isHighlighted);
+            }
+        }
 
-    // draw scroll indicator
-    DrawUtils::setFontSize(24);
-    if (end < totalElementSize) {
-        DrawUtils::print(SCREEN_WIDTH / 2 + 12, SCREEN_HEIGHT - 32, "\ufe3e", true);
-    }
-    if (start > 0) {
-        DrawUtils::print(SCREEN_WIDTH / 2 + 12, 32 + 20, "\ufe3d", true);
-    }
+        // draw scroll indicator
+        DrawUtils::setFontSize(24);
+        if (end < totalElementSize && region.intersects(ConfigLayout::SCROLL_DOWN_RECT)) {
+            DrawUtils::print(SCREEN_WIDTH / 2 + 12, SCREEN_HEIGHT - 32, "\ufe3e", true);
+        }
+        if (start > 0 && region.intersects(ConfigLayout::SCROLL_UP_RECT)) {
+            DrawUtils::print(SCREEN_WIDTH / 2 + 12, 32 + 20, "\ufe3d", true);
+        }
+    });
 
     DrawUtils::endDraw();
 }
 
-void CategoryRenderer::RenderMainLayout() const {
-    DrawUtils::clear(COLOR_BACKGROUND);
-
+void CategoryRenderer::RenderMainLayout(const DrawRect &region) const {
     DrawUtils::setFontColor(COLOR_TEXT);
     // draw top bar
-    DrawUtils::setFontSize(24);
-    DrawUtils::print(16, 6 + 24, StringTools::truncate(mInfo->name, 45).c_str());
-    DrawUtils::setFontSize(18);
-    DrawUtils::print(SCREEN_WIDTH - 16, 8 + 24, mInfo->version.c_str(), true);
-    DrawUtils::drawRectFilled(8, 8 + 24 + 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
+    if (region.intersects(ConfigLayout::TOP_BAR_RECT)) {
+        DrawUtils::setFontSize(24);
+        DrawUtils::print(16, 6 + 24, StringTools::truncate(mInfo->name, 45).c_str());
+        DrawUtils::setFontSize(18);
+        DrawUtils::print(SCREEN_WIDTH - 16, 8 + 24, mInfo->version.c_str(), true);
+        DrawUtils::drawRectFilled(8, 8 + 24 + 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
+    }
 
     // draw bottom bar
-    DrawUtils::drawRectFilled(8, SCREEN_HEIGHT - 24 - 8 - 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
-    DrawUtils::setFontSize(18);
-    DrawUtils::print(16, SCREEN_HEIGHT - 10, "\ue07d Navigate ");
-    DrawUtils::print(SCREEN_WIDTH - 16, SCREEN_HEIGHT - 10, "\ue000 Select", true);
-
-    // draw home button
-    DrawUtils::setFontSize(18);
-    const char *exitHint = "\ue001 Back";
-    DrawUtils::print(SCREEN_WIDTH / 2 + DrawUtils::getTextWidth(exitHint) / 2, SCREEN_HEIGHT - 10, exitHint, true);
+    if (region.intersects(ConfigLayout::BOTTOM_BAR_RECT)) {
+        DrawUtils::drawRectFilled(8, SCREEN_HEIGHT - 24 - 8 - 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
+        DrawUtils::setFontSize(18);
+        DrawUtils::print(16, SCREEN_HEIGHT - 10, "\ue07d Navigate ");
+        DrawUtils::print(SCREEN_WIDTH - 16, SCREEN_HEIGHT - 10, "\ue000 Select", true);
+
+        // draw home button
+        DrawUtils::setFontSize(18);
+        const char *exitHint = "\ue001 Back";
+        DrawUtils::print(SCREEN_WIDTH / 2 + DrawUtils::getTextWidth(exitHint) / 2, SCREEN_HEIGHT - 10, exitHint, true);
+    }
 }
@@ -4,6 +4,7 @@
 #include "ConfigRendererItemCategory.h"
 #include "ConfigRendererItemGeneric.h"
 #include "ConfigUtils.h"
+#include "DirtyRegions.h"
 #include "config/WUPSConfigCategory.h"
 #include "utils/input/Input.h"
 #include <memory>
@@ -23,12 +24,27 @@ public:
 
     void ResetNeedsRedraw();
 
+    /**
+     * Redraws everything on the next Render().
+     */
+    void Invalidate();
+
+    /**
+     * Whether the next Update() needs the complex pad data, otherwise it may be left uninitialized.
+     */
+    [[nodiscard]] bool NeedsComplexInput() const;
+
 private:
     ConfigSubState UpdateStateMain(Input &input, const WUPSConfigSimplePadData &simpleInputData, const WUPSConfigComplexPadData &complexInputData);
 
+    /**
+     * Polls the current value of the visible items.
+     */
+    void UpdateVisibleItems();
+
     void RenderStateMain() const;
 
-    void RenderMainLayout() const;
+    void RenderMainLayout(const DrawRect &region) const;
 
     enum State {
         STATE_MAIN = 0,
@@ -48,4 +64,6 @@ private:
     bool mFirstFrame                                                      = true;
     bool mIsRoot                                                          = false;
     bool mNeedsRedraw                                                     = true;
+    // Render() only updates the screen, so the damage can be consumed while rendering.
+    mutable DirtyRegions mDirtyRegions;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../DrawUtils.h"
 #include <cstdint>
 #include <gx2/surface.h>
 #include <string>
@@ -15,6 +16,33 @@
 
 #define MAX_BUTTONS_ON_SCREEN    8
 
+/**
+ * Screen areas of the config menu. The rects are used to find out which elements need to be redrawn, so they have to
+ * contain every pixel of their elements.
+ */
+namespace ConfigLayout {
+    constexpr uint32_t LIST_START_Y = 8 + 24 + 8 + 4;
+    constexpr uint32_t ROW_HEIGHT   = 42 + 8;
+
+    constexpr DrawRect SCREEN_RECT = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+    // Title, version and separator
+    constexpr DrawRect TOP_BAR_RECT = {0, 0, SCREEN_WIDTH, LIST_START_Y};
+    // Separator and button hints
+    constexpr DrawRect BOTTOM_BAR_RECT = {0, SCREEN_HEIGHT - 24 - 8 - 8, SCREEN_WIDTH, 24 + 8 + 8};
+    // Scroll indicators
+    constexpr DrawRect SCROLL_UP_RECT   = {SCREEN_WIDTH / 2 - 32, 32 + 20 - 32, 64, 40};
+    constexpr DrawRect SCROLL_DOWN_RECT = {SCREEN_WIDTH / 2 - 32, SCREEN_HEIGHT - 32 - 32, 64, 40};
+    // Everything that changes when scrolling: all rows and the scroll indicators
+    constexpr DrawRect LIST_RECT = {0, SCROLL_UP_RECT.y, SCREEN_WIDTH, SCROLL_DOWN_RECT.y + SCROLL_DOWN_RECT.h - SCROLL_UP_RECT.y};
+
+    /**
+     * Area of the n-th visible row (including the gap to the next row).
+     */
+    constexpr DrawRect GetRowRect(uint32_t row) {
+        return {0, LIST_START_Y + row * ROW_HEIGHT, SCREEN_WIDTH, ROW_HEIGHT};
+    }
+} // namespace ConfigLayout
+
 struct StoredBuffer {
     void *buffer;
     uint32_t buffer_size;
@@ -0,0 +1,70 @@
+#include "ConfigDisplayItem.h"
+#include "config/WUPSConfigAPI.h"
+#include "hooks.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include <cassert>
+
+const WUPSConfigAPIBackend::WUPSConfig &ConfigDisplayItem::getConfig() {
+    if (!mConfig) {
+        createConfig();
+    }
+    assert(mConfig);
+    return *mConfig;
+}
+
+void ConfigDisplayItem::createConfig() {
+    const auto configData = mPlugin->getConfigData();
+    if (configData) {
+        const auto configHandleOpt = configData->createConfig();
+        if (configHandleOpt) {
+            WUPSConfigAPIStatus callbackResult = configData->CallMenuOpenendCallback(configHandleOpt.value());
+            mConfig                            = WUPSConfigAPIBackend::Intern::PopConfigByHandle(configHandleOpt.value());
+            if (!mConfig) {
+                DEBUG_FUNCTION_LINE_ERR("Failed to get config for handle: %08X", configHandleOpt.value().handle);
+            } else if (callbackResult != WUPSCONFIG_API_RESULT_SUCCESS) {
+                DEBUG_FUNCTION_LINE_ERR("Callback failed for %s: %s", mInfo.name.c_str(), WUPSConfigAPI_GetStatusStr(callbackResult));
+                mConfig.reset();
+            }
+        } else {
+            DEBUG_FUNCTION_LINE_ERR("Failed to create config for plugin: \"%s\"", mInfo.name.c_str());
+        }
+    } else {
+        for (const auto &hook : mPlugin->getPluginInformation().getHookDataList()) {
+            if (hook.getType() == WUPS_LOADER_HOOK_GET_CONFIG_DEPRECATED) {
+                if (hook.getFunctionPointer() == nullptr) {
+                    DEBUG_FUNCTION_LINE_ERR("Hook had invalid ptr");
+                    break;
+                }
+                auto cur_config_handle = ((void *(*) ())((uint32_t *) hook.getFunctionPointer()))();
+                if (cur_config_handle == nullptr) {
+                    DEBUG_FUNCTION_LINE_WARN("Hook returned empty handle");
+                    break;
+                }
+                mConfig = WUPSConfigAPIBackend::Intern::PopConfigByHandle(WUPSConfigHandle(cur_config_handle));
+                if (!mConfig) {
+                    DEBUG_FUNCTION_LINE_ERR("Failed to find config for handle: %08X", cur_config_handle);
+                }
+                break;
+            }
+        }
+    }
+    if (!mConfig) {
+        mConfig = make_unique_nothrow<WUPSConfigAPIBackend::WUPSConfig>(mInfo.name);
+    }
+}
+
+void ConfigDisplayItem::CallMenuClosedCallback() const {
+    if (!mConfig) {
+        // The plugin has never been asked for its config.
+        return;
+    }
+    const auto configData = mPlugin->getConfigData();
+    if (configData) {
+        if (configData->CallMenuClosedCallback() == WUPSCONFIG_API_RESULT_MISSING_CALLBACK) {
+            DEBUG_FUNCTION_LINE_WARN("CallMenuClosedCallback is missing for %s", mPlugin->getMetaInformation().getName().c_str());
+        }
+    } else {
+        CallHook(*mPlugin, WUPS_LOADER_HOOK_CONFIG_CLOSED_DEPRECATED);
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "config/WUPSConfig.h"
+#include "plugin/PluginContainer.h"
 #include <memory>
 
 struct GeneralConfigInformation {
@@ -8,19 +9,36 @@ struct GeneralConfigInformation {
     std::string version;
 };
 
+/**
+ * Entry of the plugin list. The config of the plugin is only created (which calls the menu opened callback of the
+ * plugin) once it's needed and then kept until the menu is closed.
+ */
 class ConfigDisplayItem {
 public:
-    ConfigDisplayItem(GeneralConfigInformation &info, std::unique_ptr<WUPSConfigAPIBackend::WUPSConfig> config) : mConfig(std::move(config)), mInfo(std::move(info)) {
-        assert(mConfig);
+    ConfigDisplayItem(GeneralConfigInformation &info, const PluginContainer &plugin) : mPlugin(&plugin), mInfo(std::move(info)) {
     }
     [[nodiscard]] const GeneralConfigInformation &getConfigInformation() const {
         return mInfo;
     }
-    [[nodiscard]] const WUPSConfigAPIBackend::WUPSConfig &getConfig() const {
-        return *mConfig;
+
+    /**
+     * Returns the config of the plugin, creates it on the first call.
+     */
+    [[nodiscard]] const WUPSConfigAPIBackend::WUPSConfig &getConfig();
+
+    [[nodiscard]] bool isConfigCreated() const {
+        return mConfig != nullptr;
     }
 
+    /**
+     * Notifies the plugin that the menu has been closed, only if the config has been created.
+     */
+    void CallMenuClosedCallback() const;
+
 private:
+    void createConfig();
+
+    const PluginContainer *mPlugin;
     std::unique_ptr<WUPSConfigAPIBackend::WUPSConfig> mConfig;
     GeneralConfigInformation mInfo;
-};
\ No newline at end of file
+};
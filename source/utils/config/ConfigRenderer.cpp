@@ -7,43 +7,46 @@ void ConfigRenderer::RenderStateMain() const {
     int end   = std::min(start + MAX_BUTTONS_ON_SCREEN, totalElementSize);
 
     DrawUtils::beginDraw();
-    DrawUtils::clear(COLOR_BACKGROUND);
+    mDirtyRegions.redraw(COLOR_BACKGROUND, [&](const DrawRect &region) {
+        for (int32_t i = start; i < end; i++) {
+            auto rowRect = ConfigLayout::GetRowRect(i - start);
+            if (rowRect.intersects(region)) {
+                drawConfigEntry(rowRect.y, mConfigs[i].getConfigInformation(), i == mCursorPos);
+            }
+        }
 
-    uint32_t yOffset = 8 + 24 + 8 + 4;
-    for (int32_t i = start; i < end; i++) {
-        drawConfigEntry(yOffset, mConfigs[i].getConfigInformation(), i == mCursorPos);
-        yOffset += 42 + 8;
-    }
+        DrawUtils::setFontColor(COLOR_TEXT);
 
-    DrawUtils::setFontColor(COLOR_TEXT);
+        // draw top bar
+        if (region.intersects(ConfigLayout::TOP_BAR_RECT)) {
+            DrawUtils::setFontSize(24);
+            DrawUtils::print(16, 6 + 24, "Wii U Plugin System Config Menu");
+            DrawUtils::setFontSize(18);
+            DrawUtils::print(SCREEN_WIDTH - 16, 8 + 24, VERSION_FULL, true);
+            DrawUtils::drawRectFilled(8, 8 + 24 + 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
+        }
 
-    // draw top bar
-    DrawUtils::setFontSize(24);
-    DrawUtils::print(16, 6 + 24, "Wii U Plugin System Config Menu");
-    DrawUtils::setFontSize(18);
-    DrawUtils::print(SCREEN_WIDTH - 16, 8 + 24, VERSION_FULL, true);
-    DrawUtils::drawRectFilled(8, 8 + 24 + 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
-
-    // draw bottom bar
-    DrawUtils::drawRectFilled(8, SCREEN_HEIGHT - 24 - 8 - 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
-    DrawUtils::setFontSize(18);
-    DrawUtils::print(16, SCREEN_HEIGHT - 10, "\ue07d Navigate ");
-    DrawUtils::print(SCREEN_WIDTH - 16, SCREEN_HEIGHT - 10, "\ue000 Select", true);
-
-    // draw scroll indicator
-    DrawUtils::setFontSize(24);
-    if (end < totalElementSize) {
-        DrawUtils::print(SCREEN_WIDTH / 2 + 12, SCREEN_HEIGHT - 32, "\ufe3e", true);
-    }
-    if (start > 0) {
-        DrawUtils::print(SCREEN_WIDTH / 2 + 12, 32 + 20, "\ufe3d", true);
-    }
+        // draw bottom bar
+        if (region.intersects(ConfigLayout::BOTTOM_BAR_RECT)) {
+            DrawUtils::drawRectFilled(8, SCREEN_HEIGHT - 24 - 8 - 4, SCREEN_WIDTH - 8 * 2, 3, COLOR_BLACK);
+            DrawUtils::setFontSize(18);
+            DrawUtils::print(16, SCREEN_HEIGHT - 10, "\ue07d Navigate ");
+            DrawUtils::print(SCREEN_WIDTH - 16, SCREEN_HEIGHT - 10, "\ue000 Select", true);
 
-    // draw home button
-    DrawUtils::setFontSize(18);
-    const char *exitHint = "\ue044 Exit";
-    DrawUtils::print(SCREEN_WIDTH / 2 + DrawUtils::getTextWidth(exitHint) / 2, SCREEN_HEIGHT - 10, exitHint, true);
+            // draw home button
+            const char *exitHint = "\ue044 Exit";
+            DrawUtils::print(SCREEN_WIDTH / 2 + DrawUtils::getTextWidth(exitHint) / 2, SCREEN_HEIGHT - 10, exitHint, true);
+        }
 
+        // draw scroll indicator
+        DrawUtils::setFontSize(24);
+        if (end < totalElementSize && region.intersects(ConfigLayout::SCROLL_DOWN_RECT)) {
+            DrawUtils::print(SCREEN_WIDTH / 2 + 12, SCREEN_HEIGHT - 32, "\ufe3e", true);
+        }
+        if (start > 0 && region.intersects(ConfigLayout::SCROLL_UP_RECT)) {
+            DrawUtils::print(SCREEN_WIDTH / 2 + 12, 32 + 20, "\ufe3d", true);
+        }
+    });
     DrawUtils::endDraw();
 }
 
@@ -70,6 +73,7 @@ ConfigSubState ConfigRenderer::UpdateStateMain(const Input &input) {
         return SUB_STATE_ERROR;
     }
     auto prevSelectedItem = mCursorPos;
+    auto prevRenderOffset = mRenderOffset;
 
     auto totalElementSize = mConfigs.size();
     if (input.data.buttons_d & Input::eButtons::BUTTON_DOWN) {
@@ -80,6 +84,9 @@ ConfigSubState ConfigRenderer::UpdateStateMain(const Input &input) {
         if (mCursorPos != mCurrentOpen) {
             mCategoryRenderer.reset();
             mCategoryRenderer = make_unique_nothrow<CategoryRenderer>(&(mConfigs[mCursorPos].getConfigInformation()), &(mConfigs[mCursorPos].getConfig()), true);
+        } else if (mCategoryRenderer) {
+            // The screen content of the renderer has been overwritten in the meantime.
+            mCategoryRenderer->Invalidate();
         }
         mNeedRedraw  = true;
         mCurrentOpen = mCursorPos;
@@ -88,8 +95,10 @@ ConfigSubState ConfigRenderer::UpdateStateMain(const Input &input) {
     } else if (input.data.buttons_d & (Input::eButtons::BUTTON_B | Input::eButtons::BUTTON_HOME)) {
         mNeedRedraw = true;
         mCategoryRenderer.reset();
-        for (const auto &element : mConfigs) {
-            CallOnCloseCallback(element.getConfigInformation(), element.getConfig());
+        for (auto &element : mConfigs) {
+            if (element.isConfigCreated()) {
+                CallOnCloseCallback(element.getConfigInformation(), element.getConfig());
+            }
         }
         return SUB_STATE_RETURN;
     }
@@ -107,6 +116,13 @@ ConfigSubState ConfigRenderer::UpdateStateMain(const Input &input) {
         mRenderOffset = mCursorPos - MAX_BUTTONS_ON_SCREEN + 1;
     }
 
+    if (prevRenderOffset != mRenderOffset) {
+        mDirtyRegions.invalidate(ConfigLayout::LIST_RECT);
+    } else if (prevSelectedItem != mCursorPos) {
+        mDirtyRegions.invalidate(ConfigLayout::GetRowRect(prevSelectedItem - mRenderOffset));
+        mDirtyRegions.invalidate(ConfigLayout::GetRowRect(mCursorPos - mRenderOffset));
+    }
+
     if (prevSelectedItem != mCursorPos) {
         mNeedRedraw = true;
     }
@@ -155,7 +171,8 @@ ConfigSubState ConfigRenderer::Update(Input &input, const WUPSConfigSimplePadDat
                 auto subResult = mCategoryRenderer->Update(input, simpleInputData, complexInputData);
                 if (subResult != SUB_STATE_RUNNING) {
                     mNeedRedraw = true;
-                    mState      = STATE_MAIN;
+                    mDirtyRegions.invalidateAll();
+                    mState = STATE_MAIN;
                     return SUB_STATE_RUNNING;
                 }
                 return SUB_STATE_RUNNING;
@@ -186,3 +203,13 @@ void ConfigRenderer::CallOnCloseCallback(const GeneralConfigInformation &info, c
         item->onCloseCallback();
     }
 }
+
+bool ConfigRenderer::NeedsComplexInput() const {
+    return mState == STATE_SUB && mCategoryRenderer && mCategoryRenderer->NeedsComplexInput();
+}
+
+void ConfigRenderer::CallMenuClosedCallbacks() const {
+    for (const auto &element : mConfigs) {
+        element.CallMenuClosedCallback();
+    }
+}
@@ -3,6 +3,7 @@
 #include "../input/Input.h"
 #include "../logger.h"
 #include "CategoryRenderer.h"
+#include "DirtyRegions.h"
 #include "globals.h"
 #include <memory>
 #include <vector>
@@ -22,6 +23,16 @@ public:
 
     void ResetNeedsRedraw();
 
+    /**
+     * Whether the next Update() needs the complex pad data, otherwise it may be left uninitialized.
+     */
+    [[nodiscard]] bool NeedsComplexInput() const;
+
+    /**
+     * Calls the menu closed callback of every plugin whose config has been created.
+     */
+    void CallMenuClosedCallbacks() const;
+
 private:
     ConfigSubState UpdateStateMain(const Input &input);
 
@@ -46,4 +57,6 @@ private:
     void CallOnCloseCallback(const GeneralConfigInformation &info, const WUPSConfigAPIBackend::WUPSConfig &config);
 
     bool mNeedRedraw = true;
+    // Render() only updates the screen, so the damage can be consumed while rendering.
+    mutable DirtyRegions mDirtyRegions;
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "ConfigRendererItemGeneric.h"
 #include "config/WUPSConfigItem.h"
+#include <cassert>
 
 class ConfigRendererItem : public ConfigRendererItemGeneric {
 public:
@@ -75,6 +76,10 @@ public:
         mItem->onInputEx(input);
     }
 
+    [[nodiscard]] bool HasInputEx() const override {
+        return mItem->hasInputEx();
+    }
+
 private:
     const WUPSConfigAPIBackend::WUPSConfigItem *mItem;
     std::string mCurItemText;
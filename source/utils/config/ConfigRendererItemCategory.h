@@ -1,6 +1,7 @@
 #pragma once
 #include "ConfigRendererItemGeneric.h"
 #include "config/WUPSConfigCategory.h"
+#include <cassert>
 
 class ConfigRendererItemCategory : public ConfigRendererItemGeneric {
 public:
@@ -80,6 +80,10 @@ public:
     virtual void OnInputEx(WUPSConfigComplexPadData) {
     }
 
+    [[nodiscard]] virtual bool HasInputEx() const {
+        return false;
+    }
+
     [[nodiscard]] virtual bool IsMovementAllowed() const {
         return true;
     }
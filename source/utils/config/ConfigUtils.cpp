@@ -1,8 +1,10 @@
 #include "ConfigUtils.h"
 #include "../../globals.h"
 #include "../DrawUtils.h"
+#include "../OSScreenBackend.h"
 #include "../dc.h"
 #include "../logger.h"
+#include "../utils.h"
 #include "ConfigRenderer.h"
 #include "config/WUPSConfigAPI.h"
 #include "hooks.h"
@@ -10,6 +12,7 @@
 #include "utils/input/VPADInput.h"
 #include "utils/input/WPADInput.h"
 
+#include <algorithm>
 #include <avm/tv.h>
 #include <coreinit/screen.h>
 #include <gx2/display.h>
@@ -18,6 +21,12 @@
 #include <string>
 #include <vector>
 
+// Once nothing has been pressed or drawn for IDLE_AFTER_FRAMES frames the menu only updates every IDLE_FRAME_TIME us.
+#define IDLE_AFTER_FRAMES 60
+#define IDLE_FRAME_TIME   50000
+
+ConfigMenuStats ConfigUtils::sMenuStats = {};
+
 WUPS_CONFIG_SIMPLE_INPUT ConfigUtils::convertInputs(uint32_t buttons) {
     WUPSConfigButtons pressedButtons = WUPS_CONFIG_BUTTON_NONE;
     if (buttons & Input::eButtons::BUTTON_A) {
@@ -72,58 +81,19 @@ WUPS_CONFIG_SIMPLE_INPUT ConfigUtils::convertInputs(uint32_t buttons) {
 }
 
 void ConfigUtils::displayMenu() {
+    [[maybe_unused]] auto menuStartTime = OSGetTime();
     renderBasicScreen("Loading configs...");
 
+    // The configs are only created once a plugin gets selected.
     std::vector<ConfigDisplayItem> configs;
+    configs.reserve(gLoadedPlugins.size());
     for (const auto &plugin : gLoadedPlugins) {
         GeneralConfigInformation info;
         info.name    = plugin.getMetaInformation().getName();
         info.author  = plugin.getMetaInformation().getAuthor();
         info.version = plugin.getMetaInformation().getVersion();
 
-        std::unique_ptr<WUPSConfigAPIBackend::WUPSConfig> config;
-        const auto configData = plugin.getConfigData();
-        if (configData) {
-            const auto configHandleOpt = configData->createConfig();
-            if (configHandleOpt) {
-                WUPSConfigAPIStatus callbackResult = configData->CallMenuOpenendCallback(configHandleOpt.value());
-                config                             = WUPSConfigAPIBackend::Intern::PopConfigByHandle(configHandleOpt.value());
-                if (!config) {
-                    DEBUG_FUNCTION_LINE_ERR("Failed to get config for handle: %08X", configHandleOpt.value().handle);
-                } else if (callbackResult != WUPSCONFIG_API_RESULT_SUCCESS) {
-                    DEBUG_FUNCTION_LINE_ERR("Callback failed for %s: %s", info.name.c_str(), WUPSConfigAPI_GetStatusStr(callbackResult));
-                    config.reset();
-                } else {
-                    info.name = config->getName();
-                }
-            } else {
-                DEBUG_FUNCTION_LINE_ERR("Failed to create config for plugin: \"%s\"", info.name.c_str());
-            }
-        } else {
-            for (const auto &hook : plugin.getPluginInformation().getHookDataList()) {
-                if (hook.getType() == WUPS_LOADER_HOOK_GET_CONFIG_DEPRECATED) {
-                    if (hook.getFunctionPointer() == nullptr) {
-                        DEBUG_FUNCTION_LINE_ERR("Hook had invalid ptr");
-                        break;
-                    }
-                    auto cur_config_handle = ((void *(*) ())((uint32_t *) hook.getFunctionPointer()))();
-                    if (cur_config_handle == nullptr) {
-                        DEBUG_FUNCTION_LINE_WARN("Hook returned empty handle");
-                        break;
-                    }
-                    config = WUPSConfigAPIBackend::Intern::PopConfigByHandle(WUPSConfigHandle(cur_config_handle));
-                    if (!config) {
-                        DEBUG_FUNCTION_LINE_ERR("Failed to find config for handle: %08X", cur_config_handle);
-                    }
-                    break;
-                }
-            }
-        }
-        if (!config) {
-            config = make_unique_nothrow<WUPSConfigAPIBackend::WUPSConfig>(info.name);
-        }
-
-        configs.emplace_back(info, std::move(config));
+        configs.emplace_back(info, plugin);
     }
 
     // Sort Configs by name
@@ -156,8 +126,12 @@ void ConfigUtils::displayMenu() {
             WPAD_CHAN_6,
     };
 
-    auto startTime      = OSGetTime();
-    bool skipFirstInput = true;
+    auto startTime               = OSGetTime();
+    bool skipFirstInput          = true;
+    bool isFirstFrame            = true;
+    uint32_t lastButtonsHeld     = 0;
+    uint32_t framesWithoutChange = 0;
+    sMenuStats                   = {};
 
     gOnlyAcceptFromThread = OSGetCurrentThread();
     while (true) {
@@ -166,6 +140,7 @@ void ConfigUtils::displayMenu() {
             gConfigMenuShouldClose = false;
             break;
         }
+        auto inputStartTime = OSGetTime();
         baseInput.reset();
         if (vpadInput.update(1280, 720)) {
             baseInput.combine(vpadInput);
@@ -179,7 +154,13 @@ void ConfigUtils::displayMenu() {
         if (skipFirstInput) {
             skipFirstInput     = false;
             baseInput.lastData = baseInput.data;
+            lastButtonsHeld    = baseInput.data.buttons_h;
         }
+        // While idle the controllers are read less often than they are sampled, a press or release between two reads
+        // isn't reported by the controller anymore.
+        baseInput.data.buttons_d |= baseInput.data.buttons_h & ~lastButtonsHeld;
+        baseInput.data.buttons_r |= lastButtonsHeld & ~baseInput.data.buttons_h;
+        lastButtonsHeld = baseInput.data.buttons_h;
 
         WUPSConfigSimplePadData simpleData;
         simpleData.buttons_d    = convertInputs(baseInput.data.buttons_d);
@@ -190,44 +171,77 @@ void ConfigUtils::displayMenu() {
         simpleData.touched      = baseInput.data.touched;
         simpleData.validPointer = baseInput.data.validPointer;
 
+        // Copying the KPADStatus of every channel is only worth it if the selected item actually uses it.
         WUPSConfigComplexPadData complexData;
-        complexData.vpad.data      = vpadInput.vpad;
-        complexData.vpad.tpCalib   = vpadInput.tpCalib;
-        complexData.vpad.vpadError = vpadInput.vpadError;
-        for (int i = 0; i < 7; i++) {
-            complexData.kpad.kpadError[i] = wpadInputs[i].kpadError;
-            complexData.kpad.data[i]      = wpadInputs[i].kpad;
+        if (renderer.NeedsComplexInput()) {
+            complexData.vpad.data      = vpadInput.vpad;
+            complexData.vpad.tpCalib   = vpadInput.tpCalib;
+            complexData.vpad.vpadError = vpadInput.vpadError;
+            for (int i = 0; i < 7; i++) {
+                complexData.kpad.kpadError[i] = wpadInputs[i].kpadError;
+                complexData.kpad.data[i]      = wpadInputs[i].kpad;
+            }
+        }
+        auto inputTime = (uint32_t) OSTicksToMicroseconds(OSGetTime() - inputStartTime);
+        sMenuStats.totalInputTime += inputTime;
+        if (inputTime > sMenuStats.maxInputTime) {
+            sMenuStats.maxInputTime = inputTime;
         }
 
         auto subState = renderer.Update(baseInput, simpleData, complexData);
         if (subState != SUB_STATE_RUNNING) {
             break;
         }
-        if (renderer.NeedsRedraw() || baseInput.data.buttons_d || baseInput.data.buttons_r) {
+        bool rendered = renderer.NeedsRedraw();
+        if (rendered) {
             renderer.Render();
+            DEBUG_FUNCTION_LINE_VERBOSE("Rendering took %u us", DrawUtils::getLastFrameTime());
+            if (isFirstFrame) {
+                isFirstFrame = false;
+                DEBUG_FUNCTION_LINE("First frame of the menu after %u us", (uint32_t) OSTicksToMicroseconds(OSGetTime() - menuStartTime));
+            }
         }
         renderer.ResetNeedsRedraw();
 
-        auto diffTime = OSTicksToMicroseconds(OSGetTime() - startTime);
-        if (diffTime < 16000) {
-            OSSleepTicks(OSMicrosecondsToTicks(16000 - diffTime));
+        if (rendered || baseInput.data.buttons_h || baseInput.data.buttons_d || baseInput.data.buttons_r || baseInput.data.touched) {
+            framesWithoutChange = 0;
+        } else if (framesWithoutChange < IDLE_AFTER_FRAMES) {
+            framesWithoutChange++;
         }
-    }
 
-    startTime = OSGetTime();
-    renderBasicScreen("Saving configs...");
+        auto cpuTime = (uint32_t) OSTicksToMicroseconds(OSGetTime() - startTime);
+        if (rendered) {
+            sMenuStats.framesRendered++;
+        } else {
+            sMenuStats.framesSkipped++;
+        }
+        sMenuStats.totalCPUTime += cpuTime;
+        if (cpuTime > sMenuStats.maxCPUTime) {
+            sMenuStats.maxCPUTime = cpuTime;
+        }
 
-    for (const auto &plugin : gLoadedPlugins) {
-        const auto configData = plugin.getConfigData();
-        if (configData) {
-            if (configData->CallMenuClosedCallback() == WUPSCONFIG_API_RESULT_MISSING_CALLBACK) {
-                DEBUG_FUNCTION_LINE_WARN("CallMenuClosedCallback is missing for %s", plugin.getMetaInformation().getName().c_str());
+        if (framesWithoutChange >= IDLE_AFTER_FRAMES) {
+            sMenuStats.idleFrames++;
+            if (cpuTime < IDLE_FRAME_TIME) {
+                OSSleepTicks(OSMicrosecondsToTicks(IDLE_FRAME_TIME - cpuTime));
             }
         } else {
-            CallHook(plugin, WUPS_LOADER_HOOK_CONFIG_CLOSED_DEPRECATED);
+            // Rendering right after the vertical blank gives a whole frame until the flip takes effect.
+            DrawUtils::waitForVSync();
         }
     }
 
+    [[maybe_unused]] uint32_t frames = std::max<uint32_t>(sMenuStats.framesRendered + sMenuStats.framesSkipped, 1);
+    DEBUG_FUNCTION_LINE("Menu frames rendered: %u skipped: %u idle: %u, CPU time per frame avg: %u us max: %u us, input time per frame avg: %u us max: %u us",
+                        sMenuStats.framesRendered, sMenuStats.framesSkipped, sMenuStats.idleFrames,
+                        (uint32_t) (sMenuStats.totalCPUTime / frames), sMenuStats.maxCPUTime,
+                        (uint32_t) (sMenuStats.totalInputTime / frames), sMenuStats.maxInputTime);
+
+    startTime = OSGetTime();
+    renderBasicScreen("Saving configs...");
+
+    renderer.CallMenuClosedCallbacks();
+
     WUPSConfigAPIBackend::Intern::CleanAllHandles();
 
     // we want wait at least 300ms to avoid leaking inputs from the config menu to the application
@@ -262,6 +276,7 @@ void ConfigUtils::openConfigMenu() {
     bool skipScreen0Free = false;
     bool skipScreen1Free = false;
     bool doShutdownKPAD  = false;
+    std::unique_ptr<OSScreenBackend> screenBackend;
 
     if (!screenbuffer0 || !screenbuffer1) {
         if (screenbuffer0 == nullptr) {
@@ -306,7 +321,12 @@ void ConfigUtils::openConfigMenu() {
     OSScreenEnableEx(SCREEN_TV, 1);
     OSScreenEnableEx(SCREEN_DRC, 1);
 
-    DrawUtils::initBuffers(screenbuffer0, screen_buf0_size, screenbuffer1, screen_buf1_size);
+    screenBackend = make_unique_nothrow<OSScreenBackend>(screenbuffer0, screen_buf0_size, screenbuffer1, screen_buf1_size);
+    if (!screenBackend) {
+        DEBUG_FUNCTION_LINE_ERR("Failed to create screen backend");
+        goto error_exit;
+    }
+    DrawUtils::initBackend(screenBackend.get());
     if (!DrawUtils::initFont()) {
         DEBUG_FUNCTION_LINE_ERR("Failed to init Font");
         goto error_exit;
@@ -331,6 +351,7 @@ void ConfigUtils::openConfigMenu() {
     OSEnableHomeButtonMenu(wasHomeButtonMenuEnabled);
 
     DrawUtils::deinitFont();
+    DrawUtils::clearImageCache();
 
 error_exit:
     // Restore DC reg values
@@ -11,13 +11,37 @@
 
 #define MOVE_ITEM_INPUT_MASK (WUPS_CONFIG_BUTTON_B | WUPS_CONFIG_BUTTON_DOWN | WUPS_CONFIG_BUTTON_UP)
 
+struct ConfigMenuStats {
+    // Iterations of the menu loop that drew a frame
+    uint32_t framesRendered;
+    // Iterations of the menu loop without anything to draw
+    uint32_t framesSkipped;
+    // Iterations of the menu loop that ran at the idle rate
+    uint32_t idleFrames;
+    // Time spent in the menu loop without sleeping/waiting for vsync, in microseconds
+    uint64_t totalCPUTime;
+    uint32_t maxCPUTime;
+    // Part of the CPU time spent reading the controllers, in microseconds
+    uint64_t totalInputTime;
+    uint32_t maxInputTime;
+};
+
 class ConfigUtils {
 public:
     static void openConfigMenu();
 
+    /**
+     * Counters of the last time the config menu was opened.
+     */
+    static const ConfigMenuStats &getMenuStats() {
+        return sMenuStats;
+    }
+
     static WUPS_CONFIG_SIMPLE_INPUT convertInputs(uint32_t buttons);
 
 private:
     static void displayMenu();
     static void renderBasicScreen(std::string_view text);
+
+    static ConfigMenuStats sMenuStats;
 };
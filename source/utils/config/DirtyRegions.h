@@ -0,0 +1,88 @@
+#pragma once
+#include "../DrawUtils.h"
+#include "ConfigDefines.h"
+#include <array>
+#include <cstdint>
+
+/**
+ * Tracks which parts of the screen need to be redrawn.
+ * TV and DRC are double buffered, so a change has to be drawn into both buffers. The damage is tracked per buffer and
+ * only cleared for the buffer that has actually been drawn (as detected by DrawUtils::beginDraw()).
+ */
+class DirtyRegions {
+public:
+    // If more regions are invalidated, the whole screen gets redrawn.
+    static constexpr uint32_t MAX_REGIONS = 8;
+
+    void invalidateAll() {
+        for (auto &buffer : mBuffers) {
+            buffer.full  = true;
+            buffer.count = 0;
+        }
+    }
+
+    void invalidate(const DrawRect &rect) {
+        for (auto &buffer : mBuffers) {
+            if (buffer.full) {
+                continue;
+            }
+            // Skip the new region if it's already covered, drop regions that are covered by the new one.
+            bool covered = false;
+            for (uint32_t i = 0; i < buffer.count; i++) {
+                if (buffer.regions[i].contains(rect)) {
+                    covered = true;
+                    break;
+                }
+            }
+            if (covered) {
+                continue;
+            }
+            uint32_t count = 0;
+            for (uint32_t i = 0; i < buffer.count; i++) {
+                if (!rect.contains(buffer.regions[i])) {
+                    buffer.regions[count++] = buffer.regions[i];
+                }
+            }
+            buffer.count = count;
+            if (buffer.count == MAX_REGIONS) {
+                buffer.full  = true;
+                buffer.count = 0;
+                continue;
+            }
+            buffer.regions[buffer.count++] = rect;
+        }
+    }
+
+    /**
+     * Clears every dirty region of the current back buffer to the background color and calls drawRegion(const DrawRect &)
+     * with the clip rect set to the region. drawRegion has to draw every element intersecting the region.
+     * Needs to be called between DrawUtils::beginDraw() and DrawUtils::endDraw().
+     */
+    template<typename T>
+    void redraw(Color background, T drawRegion) {
+        auto &buffer = mBuffers[DrawUtils::getBackBufferIndex()];
+        if (buffer.full) {
+            DrawUtils::clear(background);
+            drawRegion(ConfigLayout::SCREEN_RECT);
+        } else {
+            for (uint32_t i = 0; i < buffer.count; i++) {
+                const auto &region = buffer.regions[i];
+                DrawUtils::setClipRect(region);
+                DrawUtils::drawRectFilled(region.x, region.y, region.w, region.h, background);
+                drawRegion(region);
+            }
+            DrawUtils::resetClipRect();
+        }
+        buffer.full  = false;
+        buffer.count = 0;
+    }
+
+private:
+    struct BufferDamage {
+        bool full      = true;
+        uint32_t count = 0;
+        std::array<DrawRect, MAX_REGIONS> regions{};
+    };
+
+    std::array<BufferDamage, 2> mBuffers{};
+};
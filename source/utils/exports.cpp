@@ -2,6 +2,7 @@
 #include "../globals.h"
 #include "../plugin/PluginDataFactory.h"
 #include "../plugin/PluginMetaInformationFactory.h"
+#include "storage/StorageUtils.h"
 #include "utils.h"
 #include <wums.h>
 #include <wups_backend/import_defines.h>
@@ -252,7 +253,7 @@ extern "C" PluginBackendApiErrorType WUPSGetAPIVersion(WUPSBackendAPIVersion *ou
     if (outVersion == nullptr) {
         return PLUGIN_BACKEND_API_ERROR_INVALID_ARG;
     }
-    *outVersion = 3;
+    *outVersion = 5;
     return PLUGIN_BACKEND_API_ERROR_NONE;
 }
 
@@ -342,3 +343,40 @@ extern "C" PluginBackendApiErrorType WUPSGetPluginMetaInformationByBufferEx(wups
 
 WUMS_EXPORT_FUNCTION(WUPSGetPluginMetaInformationByPathEx);
 WUMS_EXPORT_FUNCTION(WUPSGetPluginMetaInformationByBufferEx);
+
+// API 4.0
+extern "C" PluginBackendApiErrorType WUPSGetStorageMemoryUsage(wups_backend_plugin_container_handle handle, uint32_t *outUsage) {
+    if (handle == 0 || outUsage == nullptr) {
+        return PLUGIN_BACKEND_API_ERROR_INVALID_ARG;
+    }
+    for (const auto &curContainer : gLoadedPlugins) {
+        if (curContainer.getHandle() == handle) {
+            *outUsage = 0;
+            if (curContainer.getStorageRootItem() != nullptr) {
+                StorageUtils::API::Internal::GetMemoryUsage(curContainer.getStorageRootItem(), *outUsage);
+            }
+            return PLUGIN_BACKEND_API_ERROR_NONE;
+        }
+    }
+    return PLUGIN_BACKEND_API_INVALID_HANDLE;
+}
+
+extern "C" PluginBackendApiErrorType WUPSSetStorageQuotas(uint32_t softQuota, uint32_t hardQuota) {
+    StorageUtils::API::Internal::SetQuotas(softQuota, hardQuota);
+    return PLUGIN_BACKEND_API_ERROR_NONE;
+}
+
+WUMS_EXPORT_FUNCTION(WUPSGetStorageMemoryUsage);
+WUMS_EXPORT_FUNCTION(WUPSSetStorageQuotas);
+
+// API 5.0
+extern "C" WUPSStorageError WUPSStorageAPI_StoreItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count) {
+    return StorageUtils::API::StoreItems(root, entries, count);
+}
+
+extern "C" WUPSStorageError WUPSStorageAPI_GetItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count) {
+    return StorageUtils::API::GetItems(root, entries, count);
+}
+
+WUMS_EXPORT_FUNCTION(WUPSStorageAPI_StoreItems);
+WUMS_EXPORT_FUNCTION(WUPSStorageAPI_GetItems);
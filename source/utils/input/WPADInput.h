@@ -130,13 +130,25 @@ public:
         kpadError = KPAD_ERROR_UNINITIALIZED;
         data      = {};
 
-        WPADExtensionType type;
-        if (WPADProbe(channel, &type) != 0) {
-            data.buttons_h = 0;
-            return false;
+        // Connected channels are only read, disconnected channels are probed every PROBE_INTERVAL updates.
+        if (!connected) {
+            if (updatesUntilProbe > 0) {
+                updatesUntilProbe--;
+                return false;
+            }
+            WPADExtensionType type;
+            if (WPADProbe(channel, &type) != 0) {
+                updatesUntilProbe = PROBE_INTERVAL;
+                return false;
+            }
+            connected = true;
         }
 
         if (KPADReadEx(channel, &kpad, 1, &kpadError) <= 0) {
+            if (kpadError == KPAD_ERROR_INVALID_CONTROLLER) {
+                connected         = false;
+                updatesUntilProbe = PROBE_INTERVAL;
+            }
             return false;
         }
 
@@ -182,7 +194,17 @@ public:
     static void close() {
     }
 
+    [[nodiscard]] bool isConnected() const {
+        return connected;
+    }
+
     KPADStatus kpad     = {};
     KPADError kpadError = KPAD_ERROR_UNINITIALIZED;
     KPADChan channel;
+
+private:
+    static constexpr uint32_t PROBE_INTERVAL = 30;
+
+    bool connected             = false;
+    uint32_t updatesUntilProbe = 0;
 };
@@ -0,0 +1,138 @@
+#include "StorageBlobs.h"
+#include "fs/CFile.hpp"
+#include "fs/FSUtils.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include <cstdio>
+#include <filesystem>
+
+namespace StorageBlobs {
+    namespace {
+        constexpr std::string_view REFERENCE_PREFIX = "$blob:";
+        // 64 bit content hash + 32 bit size, both as hex.
+        constexpr size_t NAME_LENGTH = 16 + 8;
+
+        std::string GetBlobFolder(std::string_view plugin_id) {
+            return getPluginPath() + "/config/" + std::string(plugin_id) + "/blobs/";
+        }
+
+        bool IsValidName(std::string_view name) {
+            if (name.size() != NAME_LENGTH) {
+                return false;
+            }
+            for (auto c : name) {
+                if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F'))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    bool IsReference(std::string_view value) {
+        return !GetNameFromReference(value).empty();
+    }
+
+    std::string_view GetNameFromReference(std::string_view value) {
+        if (!value.starts_with(REFERENCE_PREFIX)) {
+            return {};
+        }
+        auto name = value.substr(REFERENCE_PREFIX.size());
+        // Only accept names we could have created ourselves, the name becomes part of a path.
+        if (!IsValidName(name)) {
+            return {};
+        }
+        return name;
+    }
+
+    std::string GetReference(std::string_view name) {
+        std::string res;
+        res.reserve(REFERENCE_PREFIX.size() + name.size());
+        res.append(REFERENCE_PREFIX);
+        res.append(name);
+        return res;
+    }
+
+    std::string GetName(const std::vector<uint8_t> &data) {
+        // FNV-1a
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (auto b : data) {
+            hash ^= b;
+            hash *= 0x100000001B3ULL;
+        }
+        char buf[NAME_LENGTH + 1];
+        snprintf(buf, sizeof(buf), "%016llX%08X", (unsigned long long) hash, (unsigned int) data.size());
+        return buf;
+    }
+
+    WUPSStorageError LoadBlob(std::string_view plugin_id, std::string_view reference, std::vector<uint8_t> &out) {
+        auto name = GetNameFromReference(reference);
+        if (name.empty()) {
+            return WUPS_STORAGE_ERROR_INVALID_ARGS;
+        }
+        std::string filePath = GetBlobFolder(plugin_id) + std::string(name) + ".bin";
+        if (FSUtils::LoadFileToMem(filePath, out) < 0) {
+            DEBUG_FUNCTION_LINE_WARN("Failed to load blob \"%s\"", filePath.c_str());
+            return WUPS_STORAGE_ERROR_NOT_FOUND;
+        }
+        if (GetName(out) != name) {
+            DEBUG_FUNCTION_LINE_WARN("Blob \"%s\" is corrupted", filePath.c_str());
+            out.clear();
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        return WUPS_STORAGE_ERROR_SUCCESS;
+    }
+
+    WUPSStorageError WriteBlob(std::string_view plugin_id, std::string_view name, const std::vector<uint8_t> &data) {
+        std::string folderPath = GetBlobFolder(plugin_id);
+        std::string filePath   = folderPath + std::string(name) + ".bin";
+
+        // The name depends on the content, an existing file with the expected size doesn't need to be written again.
+        std::error_code err;
+        auto existingSize = std::filesystem::file_size(filePath, err);
+        if (!err && existingSize == data.size()) {
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        if (!FSUtils::CreateSubfolder(folderPath)) {
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+
+        DEBUG_FUNCTION_LINE_VERBOSE("Writing blob \"%s\"...", filePath.c_str());
+        CFile file(filePath, CFile::WriteOnly);
+        if (!file.isOpen()) {
+            DEBUG_FUNCTION_LINE_ERR("Cannot create file %s", filePath.c_str());
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        auto writeResult = file.write(data.data(), data.size());
+        file.close();
+
+        if (writeResult != (int32_t) data.size()) {
+            std::filesystem::remove(filePath, err);
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        return WUPS_STORAGE_ERROR_SUCCESS;
+    }
+
+    void RemoveUnusedBlobs(std::string_view plugin_id, const BlobNameSet &usedBlobs) {
+        std::string folderPath = GetBlobFolder(plugin_id);
+        std::error_code err;
+        if (!std::filesystem::is_directory(folderPath, err)) {
+            return;
+        }
+        std::vector<std::filesystem::path> unused;
+        for (auto it = std::filesystem::directory_iterator(folderPath, err); !err && it != std::filesystem::directory_iterator(); it.increment(err)) {
+            const auto &path = it->path();
+            if (path.extension() != ".bin") {
+                continue;
+            }
+            if (!usedBlobs.contains(path.stem().string())) {
+                unused.push_back(path);
+            }
+        }
+        for (const auto &path : unused) {
+            DEBUG_FUNCTION_LINE_VERBOSE("Removing unused blob \"%s\"", path.c_str());
+            std::filesystem::remove(path, err);
+        }
+    }
+} // namespace StorageBlobs
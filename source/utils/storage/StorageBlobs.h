@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wups/storage.h>
+
+/**
+ * Binary items bigger than BLOB_THRESHOLD are not stored as base64 inside the json, but as separate,
+ * content-addressed file in `config/<plugin_id>/blobs/<name>.bin`. The json only holds a reference
+ * to this file (`$blob:<name>`). The `$` is not part of the base64 alphabet, so a reference can never be
+ * mistaken for inline binary data.
+ */
+namespace StorageBlobs {
+    constexpr uint32_t BLOB_THRESHOLD = 4 * 1024;
+
+    /**
+     * Blobs that have been written (or already existed) while saving a root.
+     */
+    using BlobNameSet = std::set<std::string, std::less<>>;
+
+    struct PendingBlob {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+
+    bool IsReference(std::string_view value);
+
+    /**
+     * Returns an empty string_view if value is not a reference.
+     */
+    std::string_view GetNameFromReference(std::string_view value);
+
+    std::string GetReference(std::string_view name);
+
+    /**
+     * The name is derived from the content, the same data always results in the same name.
+     */
+    std::string GetName(const std::vector<uint8_t> &data);
+
+    /**
+     * Loads and verifies the blob the given reference points to.
+     */
+    WUPSStorageError LoadBlob(std::string_view plugin_id, std::string_view reference, std::vector<uint8_t> &out);
+
+    /**
+     * Writes the blob unless a file with that name (and thus content) already exists.
+     */
+    WUPSStorageError WriteBlob(std::string_view plugin_id, std::string_view name, const std::vector<uint8_t> &data);
+
+    /**
+     * Deletes all blobs of the given plugin which are not part of usedBlobs.
+     */
+    void RemoveUnusedBlobs(std::string_view plugin_id, const BlobNameSet &usedBlobs);
+} // namespace StorageBlobs
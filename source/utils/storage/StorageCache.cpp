@@ -0,0 +1,108 @@
+#include "StorageCache.h"
+#include "StorageItemRoot.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <sys/stat.h>
+
+namespace StorageCache {
+    namespace {
+        struct CacheEntry {
+            std::shared_ptr<StorageItemRoot> root;
+            FileInfo fileInfo;
+            uint32_t memoryUsage;
+        };
+
+        // Most recently added entry first.
+        std::list<CacheEntry> sCache;
+        uint32_t sCacheSize = 0;
+        std::mutex sCacheMutex;
+
+        std::string GetFilePath(std::string_view plugin_id, std::string_view extension) {
+            return getPluginPath() + "/config/" + std::string(plugin_id) + std::string(extension);
+        }
+
+        void RemoveEntry(std::list<CacheEntry>::iterator it) {
+            sCacheSize -= it->memoryUsage;
+            sCache.erase(it);
+        }
+
+        std::list<CacheEntry>::iterator FindEntry(std::string_view plugin_id) {
+            for (auto it = sCache.begin(); it != sCache.end(); ++it) {
+                if (it->root->getPluginId() == plugin_id) {
+                    return it;
+                }
+            }
+            return sCache.end();
+        }
+    } // namespace
+
+    FileInfo GetFileInfo(std::string_view plugin_id) {
+        FileInfo res{};
+        struct stat st {};
+        if (stat(GetFilePath(plugin_id, ".json").c_str(), &st) == 0) {
+            res.snapshotSize  = st.st_size;
+            res.snapshotMTime = st.st_mtime;
+        }
+        if (stat(GetFilePath(plugin_id, ".journal").c_str(), &st) == 0) {
+            res.journalSize  = st.st_size;
+            res.journalMTime = st.st_mtime;
+        }
+        return res;
+    }
+
+    bool Contains(std::string_view plugin_id) {
+        std::lock_guard lock(sCacheMutex);
+        return FindEntry(plugin_id) != sCache.end();
+    }
+
+    void Add(std::shared_ptr<StorageItemRoot> root) {
+        if (!root) {
+            return;
+        }
+        auto fileInfo = GetFileInfo(root->getPluginId());
+        uint32_t memoryUsage;
+        {
+            std::shared_lock lock(root->getMutex());
+            memoryUsage = root->getMemoryUsage();
+        }
+
+        std::lock_guard lock(sCacheMutex);
+        if (auto it = FindEntry(root->getPluginId()); it != sCache.end()) {
+            RemoveEntry(it);
+        }
+        if (memoryUsage > MAX_CACHE_SIZE) {
+            DEBUG_FUNCTION_LINE_VERBOSE("Storage \"%s\" is too big to be cached", root->getPluginId().c_str());
+            return;
+        }
+        while (!sCache.empty() && sCacheSize + memoryUsage > MAX_CACHE_SIZE) {
+            DEBUG_FUNCTION_LINE_VERBOSE("Evict storage \"%s\" from cache", sCache.back().root->getPluginId().c_str());
+            RemoveEntry(std::prev(sCache.end()));
+        }
+        sCache.push_front({std::move(root), fileInfo, memoryUsage});
+        sCacheSize += memoryUsage;
+    }
+
+    std::shared_ptr<StorageItemRoot> Take(std::string_view plugin_id) {
+        std::shared_ptr<StorageItemRoot> res;
+        FileInfo fileInfo{};
+        {
+            std::lock_guard lock(sCacheMutex);
+            auto it = FindEntry(plugin_id);
+            if (it == sCache.end()) {
+                return nullptr;
+            }
+            res      = std::move(it->root);
+            fileInfo = it->fileInfo;
+            RemoveEntry(it);
+        }
+
+        if (GetFileInfo(plugin_id) != fileInfo) {
+            DEBUG_FUNCTION_LINE_VERBOSE("Storage \"%.*s\" has been changed since it has been cached", (int) plugin_id.size(), plugin_id.data());
+            return nullptr;
+        }
+        return res;
+    }
+} // namespace StorageCache
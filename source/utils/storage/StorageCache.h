@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+
+class StorageItemRoot;
+
+/**
+ * Keeps closed StorageItemRoots in memory, so opening the same storage again (e.g. after reloading the plugins or
+ * when relaunching an application) doesn't need to parse the file again.
+ * An entry is only reused if `config/<plugin_id>.json` still has the same size and modification time as after
+ * closing the storage and no journal has been created. If the memory usage of all cached roots gets bigger than
+ * MAX_CACHE_SIZE, the least recently closed roots are dropped.
+ */
+namespace StorageCache {
+    constexpr uint32_t MAX_CACHE_SIZE = 256 * 1024;
+
+    /**
+     * Size and modification time of `<plugin_id>.json` and `<plugin_id>.journal`, zero if a file doesn't exist.
+     */
+    struct FileInfo {
+        off_t snapshotSize;
+        time_t snapshotMTime;
+        off_t journalSize;
+        time_t journalMTime;
+
+        bool operator==(const FileInfo &) const = default;
+    };
+
+    FileInfo GetFileInfo(std::string_view plugin_id);
+
+    bool Contains(std::string_view plugin_id);
+
+    /**
+     * Must be called after the root has been closed and written to the SD card. Replaces any cached root with the same plugin id.
+     */
+    void Add(std::shared_ptr<StorageItemRoot> root);
+
+    /**
+     * Removes the root for the given plugin id from the cache.
+     * @return nullptr if the root is not cached or the file has been changed in the meantime.
+     */
+    std::shared_ptr<StorageItemRoot> Take(std::string_view plugin_id);
+} // namespace StorageCache
@@ -0,0 +1,201 @@
+#include "StorageCompression.h"
+#include "fs/CFile.hpp"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include <cstring>
+#include <malloc.h>
+#include <zlib.h>
+
+namespace StorageCompression {
+    namespace {
+        constexpr uint8_t MAGIC[4]       = {'W', 'U', 'P', 'Z'};
+        constexpr uint32_t HEADER_SIZE   = sizeof(MAGIC) + sizeof(uint32_t);
+        constexpr uint32_t CHUNK_SIZE    = 16 * 1024;
+        constexpr uint32_t MAX_DATA_SIZE = 64 * 1024 * 1024;
+        // A 4 KiB window and memLevel 5 limit deflate to ~32 KiB of state instead of ~256 KiB with the defaults.
+        // inflate always accepts smaller windows.
+        constexpr int DEFLATE_WINDOW_BITS = 12;
+        constexpr int DEFLATE_MEM_LEVEL   = 5;
+
+        uint8_t *AllocData(uint32_t size) {
+            return (uint8_t *) memalign(0x40, ROUNDUP(size + 1, 0x40));
+        }
+
+        /**
+         * Returns an empty buffer, a corrupted file is handled like a file with invalid json.
+         */
+        WUPSStorageError ReturnEmpty(uint8_t *data, uint8_t *&outData, uint32_t &outSize) {
+            if (!data && !(data = AllocData(0))) {
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            data[0] = '\0';
+            outData = data;
+            outSize = 0;
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        WUPSStorageError ReadCompressed(CFile &file, uint32_t uncompressedSize, uint8_t *&outData, uint32_t &outSize) {
+            if (uncompressedSize > MAX_DATA_SIZE) {
+                DEBUG_FUNCTION_LINE_ERR("Storage file is corrupted, invalid uncompressed size %u", uncompressedSize);
+                return ReturnEmpty(nullptr, outData, outSize);
+            }
+            auto *data  = AllocData(uncompressedSize);
+            auto *chunk = (uint8_t *) memalign(0x40, CHUNK_SIZE);
+            if (!data || !chunk) {
+                free(data);
+                free(chunk);
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+
+            z_stream s = {};
+            if (inflateInit(&s) != Z_OK) {
+                free(data);
+                free(chunk);
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            s.next_out  = data;
+            s.avail_out = uncompressedSize;
+
+            int ret       = Z_OK;
+            bool readFail = false;
+            while (ret == Z_OK) {
+                if (s.avail_in == 0) {
+                    int32_t readRes = file.read(chunk, CHUNK_SIZE);
+                    if (readRes <= 0) {
+                        // Either a read error or the file ends before the stream does.
+                        readFail = true;
+                        break;
+                    }
+                    s.next_in  = chunk;
+                    s.avail_in = readRes;
+                }
+                ret = inflate(&s, Z_NO_FLUSH);
+            }
+            inflateEnd(&s);
+            free(chunk);
+
+            if (ret == Z_MEM_ERROR) {
+                free(data);
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            if (readFail) {
+                // Don't treat the storage as empty, it would overwrite the file on the next save.
+                DEBUG_FUNCTION_LINE_ERR("Failed to read compressed storage file");
+                free(data);
+                return WUPS_STORAGE_ERROR_IO_ERROR;
+            }
+            if (ret != Z_STREAM_END || s.avail_out != 0) {
+                DEBUG_FUNCTION_LINE_ERR("Storage file is corrupted, failed to inflate: %d", ret);
+                return ReturnEmpty(data, outData, outSize);
+            }
+            data[uncompressedSize] = '\0';
+            outData                = data;
+            outSize                = uncompressedSize;
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        WUPSStorageError WriteCompressed(CFile &file, std::string_view data, uint32_t &outFileSize) {
+            uint8_t header[HEADER_SIZE];
+            memcpy(header, MAGIC, sizeof(MAGIC));
+            header[4] = (uint8_t) (data.size() >> 24);
+            header[5] = (uint8_t) (data.size() >> 16);
+            header[6] = (uint8_t) (data.size() >> 8);
+            header[7] = (uint8_t) data.size();
+            if (file.write(header, HEADER_SIZE) != (int32_t) HEADER_SIZE) {
+                return WUPS_STORAGE_ERROR_IO_ERROR;
+            }
+
+            auto *chunk = (uint8_t *) memalign(0x40, CHUNK_SIZE);
+            if (!chunk) {
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            z_stream s = {};
+            if (deflateInit2(&s, Z_BEST_SPEED, Z_DEFLATED, DEFLATE_WINDOW_BITS, DEFLATE_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+                free(chunk);
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            s.next_in  = (Bytef *) data.data();
+            s.avail_in = data.size();
+
+            WUPSStorageError res = WUPS_STORAGE_ERROR_SUCCESS;
+            uint32_t fileSize    = HEADER_SIZE;
+            int ret;
+            do {
+                s.next_out  = chunk;
+                s.avail_out = CHUNK_SIZE;
+                ret         = deflate(&s, Z_FINISH);
+                if (ret == Z_STREAM_ERROR) {
+                    res = WUPS_STORAGE_ERROR_UNKNOWN_ERROR;
+                    break;
+                }
+                uint32_t chunkSize = CHUNK_SIZE - s.avail_out;
+                if (chunkSize > 0 && file.write(chunk, chunkSize) != (int32_t) chunkSize) {
+                    res = WUPS_STORAGE_ERROR_IO_ERROR;
+                    break;
+                }
+                fileSize += chunkSize;
+            } while (ret != Z_STREAM_END);
+            deflateEnd(&s);
+            free(chunk);
+
+            if (res == WUPS_STORAGE_ERROR_SUCCESS) {
+                outFileSize = fileSize;
+            }
+            return res;
+        }
+    } // namespace
+
+    WUPSStorageError ReadFile(const std::string &path, uint8_t *&outData, uint32_t &outSize, uint32_t &outFileSize) {
+        CFile file(path, CFile::ReadOnly);
+        if (!file.isOpen() || file.size() == 0) {
+            return WUPS_STORAGE_ERROR_NOT_FOUND;
+        }
+        outFileSize = file.size();
+
+        uint8_t header[HEADER_SIZE];
+        uint32_t headerSize = file.size() < HEADER_SIZE ? file.size() : HEADER_SIZE;
+        if (file.read(header, headerSize) != (int32_t) headerSize) {
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        if (headerSize == HEADER_SIZE && memcmp(header, MAGIC, sizeof(MAGIC)) == 0) {
+            uint32_t uncompressedSize = (header[4] << 24) | (header[5] << 16) | (header[6] << 8) | header[7];
+            return ReadCompressed(file, uncompressedSize, outData, outSize);
+        }
+
+        uint32_t size = file.size();
+        auto *data    = AllocData(size);
+        if (!data) {
+            return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+        }
+        memcpy(data, header, headerSize);
+        uint32_t done = headerSize;
+        while (done < size) {
+            int32_t readRes = file.read(data + done, size - done);
+            if (readRes <= 0) {
+                free(data);
+                return WUPS_STORAGE_ERROR_IO_ERROR;
+            }
+            done += readRes;
+        }
+        data[size] = '\0';
+        outData    = data;
+        outSize    = size;
+        return WUPS_STORAGE_ERROR_SUCCESS;
+    }
+
+    WUPSStorageError WriteFile(const std::string &path, std::string_view data, uint32_t &outFileSize) {
+        CFile file(path, CFile::WriteOnly);
+        if (!file.isOpen()) {
+            DEBUG_FUNCTION_LINE_ERR("Cannot create file %s", path.c_str());
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        if (data.size() > COMPRESSION_THRESHOLD) {
+            return WriteCompressed(file, data, outFileSize);
+        }
+        if (file.write((const uint8_t *) data.data(), data.size()) != (int32_t) data.size()) {
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        outFileSize = data.size();
+        return WUPS_STORAGE_ERROR_SUCCESS;
+    }
+} // namespace StorageCompression
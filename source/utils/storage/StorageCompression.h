@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <wups/storage.h>
+
+/**
+ * Storage files bigger than COMPRESSION_THRESHOLD are written deflated. Compressed files start with MAGIC followed by
+ * the uncompressed size (big endian) and a zlib stream, a json file can never start with these bytes.
+ * Files are inflated/deflated in chunks while reading/writing, so only the uncompressed data has to fit into memory.
+ */
+namespace StorageCompression {
+    constexpr uint32_t COMPRESSION_THRESHOLD = 32 * 1024;
+
+    /**
+     * Reads a storage file (compressed or not). On success outData points to outSize bytes followed by a null-terminator,
+     * the buffer needs to be freed with free(). A corrupted compressed file results in an empty buffer.
+     * outFileSize is the size of the file on the SD card.
+     */
+    WUPSStorageError ReadFile(const std::string &path, uint8_t *&outData, uint32_t &outSize, uint32_t &outFileSize);
+
+    /**
+     * Writes data as is or deflated if it's bigger than COMPRESSION_THRESHOLD.
+     */
+    WUPSStorageError WriteFile(const std::string &path, std::string_view data, uint32_t &outFileSize);
+} // namespace StorageCompression
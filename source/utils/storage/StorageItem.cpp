@@ -1,72 +1,136 @@
 #include "StorageItem.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
-void StorageItem::setValue(const std::string &value) {
-    mData                 = value;
+StorageItem::StorageItem(std::string_view key) {
+    if (key.size() > 0xFFFF) {
+        return;
+    }
+    char *dst = mKey.inlineData;
+    if (key.size() > INLINE_SIZE) {
+        if (!(mKey.heap = (char *) malloc(key.size()))) {
+            return;
+        }
+        dst = mKey.heap;
+    }
+    if (!key.empty()) {
+        memcpy(dst, key.data(), key.size());
+    }
+    mKeySize = key.size();
+}
+
+StorageItem::~StorageItem() {
+    freeValue();
+    if (mKeySize > INLINE_SIZE) {
+        free(mKey.heap);
+    }
+}
+
+void StorageItem::freeValue() {
+    if (mType == StorageItemType::String && mValueSize > INLINE_SIZE) {
+        free(mValue.str);
+    } else if (mType == StorageItemType::Binary) {
+        delete mValue.bin;
+    }
+    mValue     = {};
+    mValueSize = 0;
+    mType      = StorageItemType::None;
+}
+
+void StorageItem::setScalar(StorageItemType type) {
+    mType                 = type;
+    mBinaryConversionDone = true;
+}
+
+bool StorageItem::setValue(std::string_view value) {
+    char *heap = nullptr;
+    if (value.size() > INLINE_SIZE) {
+        if (!(heap = (char *) malloc(value.size()))) {
+            return false;
+        }
+        memcpy(heap, value.data(), value.size());
+    }
+    freeValue();
+    if (heap) {
+        mValue.str = heap;
+    } else if (!value.empty()) {
+        memcpy(mValue.inlineData, value.data(), value.size());
+    }
+    mValueSize            = value.size();
     mType                 = StorageItemType::String;
     mBinaryConversionDone = false;
+    return true;
 }
 
-void StorageItem::setValue(bool value) {
-    mData                 = value;
-    mType                 = StorageItemType::Boolean;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(bool value) {
+    freeValue();
+    mValue.b = value;
+    setScalar(StorageItemType::Boolean);
+    return true;
 }
 
-void StorageItem::setValue(int32_t value) {
-    mData                 = (int64_t) value;
-    mType                 = StorageItemType::S64;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(int32_t value) {
+    return setValue((int64_t) value);
 }
 
-void StorageItem::setValue(int64_t value) {
-    mData                 = value;
-    mType                 = StorageItemType::S64;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(int64_t value) {
+    freeValue();
+    mValue.s64 = value;
+    setScalar(StorageItemType::S64);
+    return true;
 }
 
-void StorageItem::setValue(uint64_t value) {
-    mData                 = value;
-    mType                 = StorageItemType::U64;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(uint64_t value) {
+    freeValue();
+    mValue.u64 = value;
+    setScalar(StorageItemType::U64);
+    return true;
 }
 
-void StorageItem::setValue(uint32_t value) {
-    mData                 = (uint64_t) value;
-    mType                 = StorageItemType::U64;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(uint32_t value) {
+    return setValue((uint64_t) value);
 }
 
-void StorageItem::setValue(float value) {
-    mData                 = (double) value;
-    mType                 = StorageItemType::Double;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(float value) {
+    return setValue((double) value);
 }
 
-void StorageItem::setValue(double value) {
-    mData                 = value;
-    mType                 = StorageItemType::Double;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(double value) {
+    freeValue();
+    mValue.d = value;
+    setScalar(StorageItemType::Double);
+    return true;
 }
 
-void StorageItem::setValue(const std::vector<uint8_t> &data) {
-    mData                 = data;
-    mType                 = StorageItemType::Binary;
-    mBinaryConversionDone = true;
+bool StorageItem::setValue(const std::vector<uint8_t> &data) {
+    return setValue(std::vector<uint8_t>(data));
+}
+
+bool StorageItem::setValue(std::vector<uint8_t> &&data) {
+    auto *bin = new (std::nothrow) std::vector<uint8_t>(std::move(data));
+    if (!bin) {
+        return false;
+    }
+    freeValue();
+    mValue.bin = bin;
+    setScalar(StorageItemType::Binary);
+    return true;
 }
 
-void StorageItem::setValue(const uint8_t *data, size_t size) {
-    setValue(std::vector<uint8_t>(data, data + size));
+bool StorageItem::setValue(const uint8_t *data, size_t size) {
+    return setValue(std::vector<uint8_t>(data, data + size));
 }
 
 bool StorageItem::getValue(bool &result) const {
     if (mType == StorageItemType::Boolean) {
-        result = std::get<bool>(mData);
+        result = mValue.b;
         return true;
     } else if (mType == StorageItemType::S64) {
-        result = !!(std::get<int64_t>(mData));
+        result = !!(mValue.s64);
         return true;
     } else if (mType == StorageItemType::U64) {
-        result = !!(std::get<uint64_t>(mData));
+        result = !!(mValue.u64);
         return true;
     }
     return false;
@@ -74,10 +138,10 @@ bool StorageItem::getValue(bool &result) const {
 
 bool StorageItem::getValue(int32_t &result) const {
     if (mType == StorageItemType::S64) {
-        result = (int32_t) std::get<int64_t>(mData);
+        result = (int32_t) mValue.s64;
         return true;
     } else if (mType == StorageItemType::U64) {
-        result = (int32_t) std::get<uint64_t>(mData);
+        result = (int32_t) mValue.u64;
         return true;
     }
     return false;
@@ -85,7 +149,7 @@ bool StorageItem::getValue(int32_t &result) const {
 
 bool StorageItem::getValue(std::vector<uint8_t> &result) const {
     if (mType == StorageItemType::Binary) {
-        result = std::get<std::vector<uint8_t>>(mData);
+        result = *mValue.bin;
         return true;
     }
     return false;
@@ -93,15 +157,39 @@ bool StorageItem::getValue(std::vector<uint8_t> &result) const {
 
 bool StorageItem::getValue(std::string &result) const {
     if (mType == StorageItemType::String) {
-        result = std::get<std::string>(mData);
+        result.assign(getStringData(), mValueSize);
         return true;
     }
     return false;
 }
 
+std::optional<std::string_view> StorageItem::getStringValue() const {
+    if (mType == StorageItemType::String) {
+        return std::string_view(getStringData(), mValueSize);
+    }
+    return std::nullopt;
+}
+
+const std::vector<uint8_t> *StorageItem::getBinaryValue() const {
+    if (mType == StorageItemType::Binary) {
+        return mValue.bin;
+    }
+    return nullptr;
+}
+
+uint32_t StorageItem::getMemoryUsage() const {
+    uint32_t res = sizeof(StorageItem) + GetKeyMemoryUsage(mKeySize);
+    if (mType == StorageItemType::String && mValueSize > INLINE_SIZE) {
+        res += mValueSize;
+    } else if (mType == StorageItemType::Binary) {
+        res += sizeof(std::vector<uint8_t>) + mValue.bin->size();
+    }
+    return res;
+}
+
 bool StorageItem::getValue(double &result) const {
     if (mType == StorageItemType::Double) {
-        result = std::get<double>(mData);
+        result = mValue.d;
         return true;
     }
     return false;
@@ -109,7 +197,7 @@ bool StorageItem::getValue(double &result) const {
 
 bool StorageItem::getValue(float &result) const {
     if (mType == StorageItemType::Double) {
-        result = (float) std::get<double>(mData);
+        result = (float) mValue.d;
         return true;
     }
     return false;
@@ -117,10 +205,10 @@ bool StorageItem::getValue(float &result) const {
 
 bool StorageItem::getValue(uint64_t &result) const {
     if (mType == StorageItemType::U64) {
-        result = std::get<uint64_t>(mData);
+        result = mValue.u64;
         return true;
     } else if (mType == StorageItemType::S64) {
-        result = (uint64_t) std::get<int64_t>(mData);
+        result = (uint64_t) mValue.s64;
         return true;
     }
     return false;
@@ -128,10 +216,10 @@ bool StorageItem::getValue(uint64_t &result) const {
 
 bool StorageItem::getValue(uint32_t &result) const {
     if (mType == StorageItemType::U64) {
-        result = (uint32_t) std::get<uint64_t>(mData);
+        result = (uint32_t) mValue.u64;
         return true;
     } else if (mType == StorageItemType::S64) {
-        result = (uint32_t) std::get<int64_t>(mData);
+        result = (uint32_t) mValue.s64;
         return true;
     }
     return false;
@@ -139,10 +227,10 @@ bool StorageItem::getValue(uint32_t &result) const {
 
 bool StorageItem::getValue(int64_t &result) const {
     if (mType == StorageItemType::S64) {
-        result = std::get<int64_t>(mData);
+        result = mValue.s64;
         return true;
     } else if (mType == StorageItemType::U64) {
-        result = (int64_t) std::get<uint64_t>(mData);
+        result = (int64_t) mValue.u64;
         return true;
     }
     return false;
@@ -150,7 +238,7 @@ bool StorageItem::getValue(int64_t &result) const {
 
 bool StorageItem::getItemSizeString(uint32_t &outSize) const {
     if (mType == StorageItemType::String) {
-        outSize = (std::get<std::string>(mData).length() + 1);
+        outSize = mValueSize + 1;
         return true;
     }
     return false;
@@ -158,7 +246,7 @@ bool StorageItem::getItemSizeString(uint32_t &outSize) const {
 
 bool StorageItem::getItemSizeBinary(uint32_t &outSize) const {
     if (mType == StorageItemType::Binary) {
-        outSize = std::get<std::vector<uint8_t>>(mData).size();
+        outSize = mValue.bin->size();
         return true;
     }
     return false;
@@ -168,18 +256,11 @@ bool StorageItem::attemptBinaryConversion() {
     if (mBinaryConversionDone) {
         return true;
     }
-    if (mType == StorageItemType::String) {
-        auto &tmp     = std::get<std::string>(mData);
-        auto dec_size = b64_decoded_size(tmp.c_str());
-        if (dec_size > 0) {
-            auto *dec = (uint8_t *) malloc(dec_size);
-            if (dec) {
-                if (b64_decode(tmp.c_str(), dec, dec_size)) {
-                    setValue(dec, dec_size);
-                }
-                free(dec);
-            } else {
-                DEBUG_FUNCTION_LINE_WARN("Malloc failed for string->binary parsing");
+    if (mType == StorageItemType::String && mValueSize > 0) {
+        std::vector<uint8_t> dec;
+        // Decode straight into the vector that becomes the new value, invalid base64 keeps the string.
+        if (b64_decode(std::string_view(getStringData(), mValueSize), dec)) {
+            if (!setValue(std::move(dec))) {
                 return false;
             }
         }
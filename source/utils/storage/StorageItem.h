@@ -4,48 +4,73 @@
 #include "utils/logger.h"
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
-#include <variant>
 #include <vector>
 
-enum class StorageItemType { None,
-                             Boolean,
-                             String,
-                             Binary,
-                             S64,
-                             U64,
-                             Double };
-
+enum class StorageItemType : uint8_t { None,
+                                       Boolean,
+                                       String,
+                                       Binary,
+                                       S64,
+                                       U64,
+                                       Double };
+
+/**
+ * A single node of the storage tree, kept as small as possible as a storage can hold thousands of them.
+ *
+ * Scalars and strings up to INLINE_SIZE bytes are stored inside the node, longer strings in a separate buffer and
+ * binary data in an out-of-line vector (so decoded base64 or loaded blobs can be moved in without copying).
+ * The same applies to the key: keys up to INLINE_SIZE bytes don't need an extra allocation. The key only lives here,
+ * StorageItemMap looks it up through the node.
+ */
 class StorageItem {
 public:
-    explicit StorageItem(std::string_view key) : mData(std::monostate{}), mType(StorageItemType::None), mKey(key) {
-    }
+    static constexpr uint32_t INLINE_SIZE = 8;
+
+    /**
+     * If the key can't be stored (allocation failed or longer than 0xFFFF bytes), getKey() returns an empty key.
+     */
+    explicit StorageItem(std::string_view key);
+
+    ~StorageItem();
+
+    StorageItem(const StorageItem &) = delete;
+
+    StorageItem &operator=(const StorageItem &) = delete;
 
-    [[nodiscard]] uint32_t getHandle() const {
-        return (uint32_t) this;
+    [[nodiscard]] uintptr_t getHandle() const {
+        return (uintptr_t) this;
     }
 
-    // Setters for different types
-    void setValue(bool value);
+    // Setters for different types. Return false if the value couldn't be allocated, the old value is kept in this case.
+    bool setValue(bool value);
 
-    void setValue(const std::string &value);
+    bool setValue(std::string_view value);
 
-    void setValue(int32_t value);
+    bool setValue(const std::string &value) {
+        return setValue(std::string_view(value));
+    }
+
+    bool setValue(int32_t value);
+
+    bool setValue(int64_t value);
 
-    void setValue(int64_t value);
+    bool setValue(uint64_t value);
 
-    void setValue(uint64_t value);
+    bool setValue(uint32_t value);
 
-    void setValue(uint32_t value);
+    bool setValue(float value);
 
-    void setValue(float value);
+    bool setValue(double value);
 
-    void setValue(double value);
+    bool setValue(const std::vector<uint8_t> &data);
 
-    void setValue(const std::vector<uint8_t> &data);
+    bool setValue(std::vector<uint8_t> &&data);
 
-    void setValue(const uint8_t *data, size_t size);
+    bool setValue(const uint8_t *data, size_t size);
 
     bool getValue(bool &result) const;
 
@@ -65,12 +90,35 @@ public:
 
     bool getValue(std::vector<uint8_t> &result) const;
 
+    /**
+     * Access the value without copying it. Returns std::nullopt/nullptr if the item has a different type.
+     */
+    [[nodiscard]] std::optional<std::string_view> getStringValue() const;
+
+    [[nodiscard]] const std::vector<uint8_t> *getBinaryValue() const;
+
+    /**
+     * Heap memory used by this item: the node itself plus the key and the value if they are not stored inline.
+     */
+    [[nodiscard]] uint32_t getMemoryUsage() const;
+
+    /**
+     * Estimation of getMemoryUsage() for a new item.
+     */
+    static uint32_t GetMemoryUsage(size_t keySize, size_t valueSize) {
+        return sizeof(StorageItem) + GetKeyMemoryUsage(keySize) + (valueSize > INLINE_SIZE ? valueSize : 0);
+    }
+
+    static uint32_t GetKeyMemoryUsage(size_t keySize) {
+        return keySize > INLINE_SIZE ? keySize : 0;
+    }
+
     [[nodiscard]] StorageItemType getType() const {
         return mType;
     }
 
-    [[nodiscard]] const std::string &getKey() const {
-        return mKey;
+    [[nodiscard]] std::string_view getKey() const {
+        return {mKeySize > INLINE_SIZE ? mKey.heap : mKey.inlineData, mKeySize};
     }
 
     bool getItemSizeString(uint32_t &outSize) const;
@@ -79,10 +127,38 @@ public:
 
     bool attemptBinaryConversion();
 
+    [[nodiscard]] bool isBinaryConversionDone() const {
+        return mBinaryConversionDone;
+    }
+
 private:
-    std::variant<std::monostate, std::string, bool, int64_t, uint64_t, double, std::vector<uint8_t>> mData = std::monostate{};
-    StorageItemType mType                                                                                  = StorageItemType::None;
-    std::string mKey                                                                                       = {};
+    void freeValue();
+
+    void setScalar(StorageItemType type);
+
+    [[nodiscard]] const char *getStringData() const {
+        return mValueSize > INLINE_SIZE ? mValue.str : mValue.inlineData;
+    }
 
+    union {
+        int64_t s64;
+        uint64_t u64;
+        double d;
+        bool b;
+        // String with more than INLINE_SIZE bytes
+        char *str;
+        std::vector<uint8_t> *bin;
+        char inlineData[INLINE_SIZE];
+    } mValue{};
+
+    union {
+        char *heap;
+        char inlineData[INLINE_SIZE];
+    } mKey{};
+
+    // Length of the string value
+    uint32_t mValueSize        = 0;
+    uint16_t mKeySize          = 0;
+    StorageItemType mType      = StorageItemType::None;
     bool mBinaryConversionDone = true;
 };
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "utils/utils.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * Insertion-ordered map from key to heap-allocated node, used for the children of a StorageSubItem.
+ *
+ * Nodes are owned through a std::unique_ptr, so their address (and therefore their storage handle) stays stable
+ * while the map grows. Small maps are searched linearly by comparing the cached hashes, larger maps use an
+ * open-addressing index with linear probing. Lookups take a std::string_view, no temporary std::string is created.
+ *
+ * T needs to be constructible from a std::string_view and provide a `getKey()` function. A node whose key differs from
+ * the requested one after construction (e.g. because the key couldn't be allocated) is treated as allocation failure.
+ */
+template<typename T>
+class StorageItemMap {
+    struct Entry {
+        uint32_t hash;
+        std::unique_ptr<T> value;
+    };
+
+public:
+    class iterator {
+    public:
+        explicit iterator(typename std::vector<Entry>::const_iterator it) : mIt(it) {
+        }
+
+        T &operator*() const {
+            return *mIt->value;
+        }
+
+        T *operator->() const {
+            return mIt->value.get();
+        }
+
+        iterator &operator++() {
+            ++mIt;
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return mIt == other.mIt;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return mIt != other.mIt;
+        }
+
+    private:
+        typename std::vector<Entry>::const_iterator mIt;
+    };
+
+    [[nodiscard]] iterator begin() const {
+        return iterator(mEntries.begin());
+    }
+
+    [[nodiscard]] iterator end() const {
+        return iterator(mEntries.end());
+    }
+
+    [[nodiscard]] size_t size() const {
+        return mEntries.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return mEntries.empty();
+    }
+
+    [[nodiscard]] T *find(std::string_view key) const {
+        auto index = findIndex(key, hash(key));
+        if (index == NOT_FOUND) {
+            return nullptr;
+        }
+        return mEntries[index].value.get();
+    }
+
+    [[nodiscard]] bool contains(std::string_view key) const {
+        return findIndex(key, hash(key)) != NOT_FOUND;
+    }
+
+    /**
+     * Creates a new node for the given key.
+     * @return nullptr if the key already exists or the allocation failed.
+     */
+    T *emplace(std::string_view key, bool &alreadyExists) {
+        auto keyHash  = hash(key);
+        alreadyExists = findIndex(key, keyHash) != NOT_FOUND;
+        if (alreadyExists) {
+            return nullptr;
+        }
+        auto value = make_unique_nothrow<T>(key);
+        if (!value || value->getKey().size() != key.size()) {
+            return nullptr;
+        }
+        auto *res = value.get();
+        mEntries.push_back({keyHash, std::move(value)});
+
+        if (!mSlots.empty()) {
+            if ((mEntries.size() * 2) > mSlots.size()) {
+                rebuildIndex(mSlots.size() * 2);
+            } else {
+                insertSlot(keyHash, mEntries.size() - 1);
+            }
+        } else if (mEntries.size() > SMALL_MAP_SIZE) {
+            rebuildIndex(SMALL_MAP_SIZE * 4);
+        }
+        return res;
+    }
+
+    /**
+     * Removes the node with the given key. Keeps the insertion order of the remaining nodes,
+     * which is why this is O(n).
+     */
+    bool erase(std::string_view key) {
+        auto index = findIndex(key, hash(key));
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        mEntries.erase(mEntries.begin() + index);
+        if (mEntries.size() <= SMALL_MAP_SIZE) {
+            mSlots.clear();
+            mSlots.shrink_to_fit();
+        } else {
+            rebuildIndex(mSlots.size());
+        }
+        return true;
+    }
+
+    void clear() {
+        mEntries.clear();
+        mSlots.clear();
+    }
+
+private:
+    static constexpr uint32_t NOT_FOUND      = 0xFFFFFFFF;
+    static constexpr uint32_t EMPTY_SLOT     = 0;
+    static constexpr uint32_t SMALL_MAP_SIZE = 8;
+
+    // FNV-1a
+    static uint32_t hash(std::string_view key) {
+        uint32_t res = 0x811C9DC5;
+        for (auto c : key) {
+            res ^= (uint8_t) c;
+            res *= 0x01000193;
+        }
+        return res;
+    }
+
+    [[nodiscard]] uint32_t findIndex(std::string_view key, uint32_t keyHash) const {
+        if (mSlots.empty()) {
+            for (uint32_t i = 0; i < mEntries.size(); i++) {
+                if (mEntries[i].hash == keyHash && mEntries[i].value->getKey() == key) {
+                    return i;
+                }
+            }
+            return NOT_FOUND;
+        }
+        uint32_t mask = mSlots.size() - 1;
+        for (uint32_t pos = keyHash & mask;; pos = (pos + 1) & mask) {
+            auto slot = mSlots[pos];
+            if (slot == EMPTY_SLOT) {
+                return NOT_FOUND;
+            }
+            auto &entry = mEntries[slot - 1];
+            if (entry.hash == keyHash && entry.value->getKey() == key) {
+                return slot - 1;
+            }
+        }
+    }
+
+    void insertSlot(uint32_t keyHash, uint32_t index) {
+        uint32_t mask = mSlots.size() - 1;
+        uint32_t pos  = keyHash & mask;
+        while (mSlots[pos] != EMPTY_SLOT) {
+            pos = (pos + 1) & mask;
+        }
+        // Slots store index + 1, 0 marks an empty slot.
+        mSlots[pos] = index + 1;
+    }
+
+    void rebuildIndex(uint32_t slotCount) {
+        mSlots.assign(slotCount, EMPTY_SLOT);
+        for (uint32_t i = 0; i < mEntries.size(); i++) {
+            insertSlot(mEntries[i].hash, i);
+        }
+    }
+
+    std::vector<Entry> mEntries;
+    std::vector<uint32_t> mSlots;
+};
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "StorageBlobs.h"
 #include "StorageItem.h"
+#include "StorageJournal.h"
 #include "StorageSubItem.h"
 #include "utils/logger.h"
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -13,6 +17,7 @@
 class StorageItemRoot : public StorageSubItem {
 public:
     explicit StorageItemRoot(std::string_view plugin_name) : StorageSubItem(plugin_name), mPluginName(plugin_name) {
+        recalculateMemoryUsage();
     }
 
     [[nodiscard]] const std::string &getPluginId() const {
@@ -22,8 +27,59 @@ public:
     void wipe() {
         mSubCategories.clear();
         mItems.clear();
+        recalculateMemoryUsage();
+    }
+
+    /**
+     * Memory used by the item tree. Guarded by getMutex().
+     */
+    [[nodiscard]] uint32_t getMemoryUsage() const {
+        return mMemoryUsage;
+    }
+
+    void updateMemoryUsage(uint32_t oldUsage, uint32_t newUsage) {
+        mMemoryUsage = mMemoryUsage - oldUsage + newUsage;
+    }
+
+    void recalculateMemoryUsage() {
+        mMemoryUsage = getTreeMemoryUsage();
+    }
+
+    /**
+     * Guarded by getMutex().
+     */
+    bool softQuotaExceeded = false;
+
+    /**
+     * Guards the item tree of this root. Reading items only requires a shared lock, modifying the tree requires a unique lock.
+     */
+    [[nodiscard]] std::shared_mutex &getMutex() {
+        return mMutex;
+    }
+
+    /**
+     * Serializes writing this root to the SD card, so concurrent saves can't interleave.
+     */
+    [[nodiscard]] std::mutex &getSaveMutex() {
+        return mSaveMutex;
+    }
+
+    /**
+     * Blobs that are known to exist on the SD card. Guarded by the save mutex.
+     */
+    [[nodiscard]] StorageBlobs::BlobNameSet &getWrittenBlobs() {
+        return mWrittenBlobs;
+    }
+
+    [[nodiscard]] StorageJournal &getJournal() {
+        return mJournal;
     }
 
 private:
     std::string mPluginName;
+    std::shared_mutex mMutex;
+    std::mutex mSaveMutex;
+    StorageBlobs::BlobNameSet mWrittenBlobs;
+    StorageJournal mJournal;
+    uint32_t mMemoryUsage = 0;
 };
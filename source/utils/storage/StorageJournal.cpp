@@ -0,0 +1,179 @@
+#include "StorageJournal.h"
+#include "fs/CFile.hpp"
+#include "fs/FSUtils.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include <cstdio>
+
+namespace {
+    // "XXXXXXXX "
+    constexpr size_t CHECKSUM_LENGTH = 9;
+
+    // FNV-1a
+    uint32_t GetChecksum(std::string_view data) {
+        uint32_t res = 0x811C9DC5;
+        for (auto c : data) {
+            res ^= (uint8_t) c;
+            res *= 0x01000193;
+        }
+        return res;
+    }
+
+    std::string GetJournalPath(std::string_view plugin_id) {
+        return getPluginPath() + "/config/" + std::string(plugin_id) + ".journal";
+    }
+
+    WUPSStorageError WriteFile(std::string_view plugin_id, const std::string &data, CFile::eOpenTypes mode) {
+        auto filePath = GetJournalPath(plugin_id);
+        CFile file(filePath, mode);
+        if (!file.isOpen()) {
+            DEBUG_FUNCTION_LINE_ERR("Cannot open file %s", filePath.c_str());
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        auto writeResult = file.write((const uint8_t *) data.data(), data.size());
+        file.close();
+        if (writeResult != (int32_t) data.size()) {
+            return WUPS_STORAGE_ERROR_IO_ERROR;
+        }
+        return WUPS_STORAGE_ERROR_SUCCESS;
+    }
+} // namespace
+
+std::string StorageJournal::FormatRecord(const nlohmann::json &record) {
+    auto recordString = record.dump(-1, ' ', false, nlohmann::json::error_handler_t::ignore);
+    char checksum[CHECKSUM_LENGTH + 1];
+    snprintf(checksum, sizeof(checksum), "%08X ", (unsigned int) GetChecksum(recordString));
+
+    std::string res;
+    res.reserve(CHECKSUM_LENGTH + recordString.size() + 1);
+    res.append(checksum, CHECKSUM_LENGTH);
+    res.append(recordString);
+    res.push_back('\n');
+    return res;
+}
+
+void StorageJournal::addRecord(const nlohmann::json &record) {
+    auto line = FormatRecord(record);
+    std::lock_guard lock(mMutex);
+    mPending.push_back({std::move(line), nullptr, nullptr});
+}
+
+void StorageJournal::addStore(const StorageSubItem &parent, const StorageItem &item) {
+    std::lock_guard lock(mMutex);
+    if (mPendingStores.contains(&item)) {
+        return;
+    }
+    mPendingStores[&item] = mPending.size();
+    mPending.push_back({{}, &parent, &item});
+}
+
+void StorageJournal::removeStore(const StorageItem &item) {
+    std::lock_guard lock(mMutex);
+    auto it = mPendingStores.find(&item);
+    if (it != mPendingStores.end()) {
+        mPending[it->second].item   = nullptr;
+        mPending[it->second].parent = nullptr;
+        mPendingStores.erase(it);
+    }
+}
+
+bool StorageJournal::hasPendingStores() {
+    std::lock_guard lock(mMutex);
+    return !mPendingStores.empty();
+}
+
+void StorageJournal::requestSnapshot() {
+    std::lock_guard lock(mMutex);
+    mSnapshotRequired = true;
+    // The snapshot includes all pending changes
+    mPending.clear();
+    mPendingStores.clear();
+}
+
+bool StorageJournal::takePending(std::vector<PendingChange> &outChanges) {
+    std::lock_guard lock(mMutex);
+    outChanges.swap(mPending);
+    mPending.clear();
+    mPendingStores.clear();
+    bool res          = mSnapshotRequired;
+    mSnapshotRequired = false;
+    return res;
+}
+
+void StorageJournal::clearPending() {
+    std::lock_guard lock(mMutex);
+    mPending.clear();
+    mPendingStores.clear();
+    mSnapshotRequired = false;
+}
+
+uint32_t StorageJournal::GetSnapshotChecksum(std::string_view snapshot) {
+    return GetChecksum(snapshot);
+}
+
+WUPSStorageError StorageJournal::CreateFile(std::string_view plugin_id, uint32_t snapshotChecksum, const std::string &records, uint32_t &outFileSize) {
+    // Truncates a journal that couldn't be removed after the last snapshot.
+    auto data = FormatRecord(nlohmann::json::array({"h", snapshotChecksum})) + records;
+    if (auto err = WriteFile(plugin_id, data, CFile::WriteOnly); err != WUPS_STORAGE_ERROR_SUCCESS) {
+        return err;
+    }
+    outFileSize = data.size();
+    return WUPS_STORAGE_ERROR_SUCCESS;
+}
+
+WUPSStorageError StorageJournal::AppendToFile(std::string_view plugin_id, const std::string &records) {
+    return WriteFile(plugin_id, records, CFile::Append);
+}
+
+void StorageJournal::RemoveFile(std::string_view plugin_id) {
+    remove(GetJournalPath(plugin_id).c_str());
+}
+
+bool StorageJournal::ReadFile(std::string_view plugin_id, uint32_t snapshotChecksum, std::vector<nlohmann::json> &outRecords, uint32_t &outFileSize) {
+    outFileSize = 0;
+    std::vector<uint8_t> buffer;
+    if (FSUtils::LoadFileToMem(GetJournalPath(plugin_id), buffer) < 0) {
+        // No journal is fine.
+        return true;
+    }
+    outFileSize = buffer.size();
+
+    std::string_view data((const char *) buffer.data(), buffer.size());
+    bool hasHeader = false;
+    while (!data.empty()) {
+        auto lineEnd = data.find('\n');
+        if (lineEnd == std::string_view::npos) {
+            DEBUG_FUNCTION_LINE_WARN("Journal of \"%.*s\" ends with a torn record", (int) plugin_id.size(), plugin_id.data());
+            return false;
+        }
+        auto line = data.substr(0, lineEnd);
+        data.remove_prefix(lineEnd + 1);
+
+        if (line.size() <= CHECKSUM_LENGTH || line[CHECKSUM_LENGTH - 1] != ' ') {
+            DEBUG_FUNCTION_LINE_WARN("Journal of \"%.*s\" contains a corrupted record", (int) plugin_id.size(), plugin_id.data());
+            return false;
+        }
+        auto recordString = line.substr(CHECKSUM_LENGTH);
+        char checksum[CHECKSUM_LENGTH + 1];
+        snprintf(checksum, sizeof(checksum), "%08X ", (unsigned int) GetChecksum(recordString));
+        if (line.substr(0, CHECKSUM_LENGTH) != std::string_view(checksum, CHECKSUM_LENGTH)) {
+            DEBUG_FUNCTION_LINE_WARN("Journal of \"%.*s\" contains a record with invalid checksum", (int) plugin_id.size(), plugin_id.data());
+            return false;
+        }
+        auto record = nlohmann::json::parse(recordString.begin(), recordString.end(), nullptr, false);
+        if (record.is_discarded()) {
+            DEBUG_FUNCTION_LINE_WARN("Journal of \"%.*s\" contains an invalid record", (int) plugin_id.size(), plugin_id.data());
+            return false;
+        }
+        if (!hasHeader) {
+            if (!record.is_array() || record.size() != 2 || record[0] != "h" || !record[1].is_number_unsigned() || record[1].get<uint32_t>() != snapshotChecksum) {
+                DEBUG_FUNCTION_LINE_WARN("Journal of \"%.*s\" doesn't belong to the snapshot, ignoring it", (int) plugin_id.size(), plugin_id.data());
+                return false;
+            }
+            hasHeader = true;
+            continue;
+        }
+        outRecords.push_back(std::move(record));
+    }
+    return true;
+}
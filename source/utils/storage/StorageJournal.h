@@ -0,0 +1,106 @@
+#pragma once
+
+#include "StorageItem.h"
+#include "utils/json.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <wups/storage.h>
+
+class StorageSubItem;
+
+/**
+ * Saving a root appends the changes since the last save to `config/<plugin_id>.journal` instead of rewriting the whole
+ * `<plugin_id>.json`. Opening a storage replays the journal on top of the json (the snapshot). The journal gets compacted
+ * into a new snapshot when the storage is closed, when the journal grows bigger than the snapshot or when a change can't
+ * be expressed as record (e.g. wiping the storage).
+ *
+ * Each record is one line: `<fnv1a-32 of the json as 8 hex digits> <json array>\n`
+ * - `["h", checksum]` header, always the first record. The fnv1a-32 of the (uncompressed) snapshot the journal belongs
+ *   to. A journal left over from an older snapshot (e.g. the console crashed after writing a new snapshot but before
+ *   removing the journal) doesn't match the snapshot on the SD card anymore and is ignored.
+ * - `["s", [path...], key, value]` store an item
+ * - `["d", [path...], key]` delete an item or sub item
+ * - `["c", [path...], key]` create a sub item
+ */
+class StorageJournal {
+public:
+    struct PendingChange {
+        // Either a complete record (delete item, create sub item) ...
+        std::string record;
+        // ... or an item that has been stored. The record is created when saving, so storing the same item multiple times
+        // between two saves results in a single record.
+        const StorageSubItem *parent = nullptr;
+        const StorageItem *item      = nullptr;
+    };
+
+    // Journals smaller than this are never compacted, even if the snapshot is tiny.
+    static constexpr uint32_t MIN_COMPACTION_SIZE = 16 * 1024;
+
+    /**
+     * All functions modifying the pending changes need to be called while holding a unique lock on the item tree.
+     */
+    void addRecord(const nlohmann::json &record);
+
+    void addStore(const StorageSubItem &parent, const StorageItem &item);
+
+    /**
+     * Needs to be called before a stored item gets deleted.
+     */
+    void removeStore(const StorageItem &item);
+
+    [[nodiscard]] bool hasPendingStores();
+
+    /**
+     * Forces the next save to write a full snapshot.
+     */
+    void requestSnapshot();
+
+    /**
+     * Moves the pending changes into outChanges. Needs at least a shared lock on the item tree, the items of the changes
+     * are only valid while holding it.
+     * @return true if the next save needs to write a full snapshot.
+     */
+    bool takePending(std::vector<PendingChange> &outChanges);
+
+    void clearPending();
+
+    /**
+     * Returns the line for the given record, including checksum and line break.
+     */
+    static std::string FormatRecord(const nlohmann::json &record);
+
+    static uint32_t GetSnapshotChecksum(std::string_view snapshot);
+
+    /**
+     * Replaces the journal with a new one for the snapshot with the given checksum that contains the given records.
+     */
+    static WUPSStorageError CreateFile(std::string_view plugin_id, uint32_t snapshotChecksum, const std::string &records, uint32_t &outFileSize);
+
+    static WUPSStorageError AppendToFile(std::string_view plugin_id, const std::string &records);
+
+    static void RemoveFile(std::string_view plugin_id);
+
+    /**
+     * Reads all valid records of the journal. Reading stops at the first torn or corrupted record, no records are read if
+     * the journal doesn't belong to the snapshot with the given checksum.
+     * @return false if the journal doesn't belong to the snapshot or contains a torn or corrupted record.
+     */
+    static bool ReadFile(std::string_view plugin_id, uint32_t snapshotChecksum, std::vector<nlohmann::json> &outRecords, uint32_t &outFileSize);
+
+    // Guarded by the save mutex of the root.
+    bool hasSnapshot          = false;
+    uint32_t snapshotFileSize = 0;
+    uint32_t snapshotChecksum = 0;
+    uint32_t journalFileSize  = 0;
+
+private:
+    std::mutex mMutex;
+    std::vector<PendingChange> mPending;
+    // Index of the pending change for each stored item
+    std::unordered_map<const StorageItem *, uint32_t> mPendingStores;
+    bool mSnapshotRequired = false;
+};
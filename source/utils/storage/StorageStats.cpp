@@ -0,0 +1,117 @@
+#include "StorageStats.h"
+
+#ifdef DEBUG
+#include "utils/logger.h"
+#include <atomic>
+
+namespace StorageStats {
+    namespace {
+        // Bucket i counts durations in [2^(i-1), 2^i) us, the last bucket also holds everything above.
+        constexpr uint32_t BUCKET_COUNT = 24;
+
+        /**
+         * Every counter is updated on its own with relaxed atomics, so recording doesn't serialize calls on different roots.
+         * 64 bit atomics would need libatomic on the PPC, the total is split into two 32 bit halves instead.
+         */
+        struct OperationStats {
+            std::atomic<uint32_t> count;
+            std::atomic<uint32_t> totalUsLow;
+            std::atomic<uint32_t> totalUsHigh;
+            std::atomic<uint32_t> maxUs;
+            std::atomic<uint32_t> buckets[BUCKET_COUNT];
+        };
+
+        OperationStats sStats[OPERATION_COUNT];
+
+        const char *GetOperationName(Operation operation) {
+            switch (operation) {
+                case OPERATION_OPEN:
+                    return "Open";
+                case OPERATION_CLOSE:
+                    return "Close";
+                case OPERATION_SAVE:
+                    return "Save";
+                case OPERATION_RELOAD:
+                    return "Reload";
+                case OPERATION_WIPE:
+                    return "Wipe";
+                case OPERATION_GET:
+                    return "GetItem";
+                case OPERATION_GET_SIZE:
+                    return "GetItemSize";
+                case OPERATION_STORE:
+                    return "StoreItem";
+                case OPERATION_GET_BATCH:
+                    return "GetItems";
+                case OPERATION_STORE_BATCH:
+                    return "StoreItems";
+                case OPERATION_DELETE:
+                    return "DeleteItem";
+                case OPERATION_SUB_ITEM:
+                    return "SubItem";
+                case OPERATION_COUNT:
+                    break;
+            }
+            return "Unknown";
+        }
+
+        uint32_t GetBucket(uint32_t durationInUs) {
+            uint32_t bucket = 32 - __builtin_clz(durationInUs | 1);
+            if (durationInUs == 0) {
+                bucket = 0;
+            }
+            return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+        }
+
+        /**
+         * Returns the upper bound of the bucket which contains the given percentile.
+         */
+        uint32_t GetPercentile(const uint32_t (&buckets)[BUCKET_COUNT], uint32_t count, uint32_t percentile) {
+            uint32_t threshold = (count * percentile + 99) / 100;
+            uint32_t sum       = 0;
+            for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+                sum += buckets[i];
+                if (sum >= threshold) {
+                    return 1u << i;
+                }
+            }
+            return 1u << (BUCKET_COUNT - 1);
+        }
+    } // namespace
+
+    void Record(Operation operation, uint32_t durationInUs) {
+        auto &stats = sStats[operation];
+        stats.count.fetch_add(1, std::memory_order_relaxed);
+        uint32_t oldLow = stats.totalUsLow.fetch_add(durationInUs, std::memory_order_relaxed);
+        if (oldLow + durationInUs < oldLow) {
+            stats.totalUsHigh.fetch_add(1, std::memory_order_relaxed);
+        }
+        stats.buckets[GetBucket(durationInUs)].fetch_add(1, std::memory_order_relaxed);
+        uint32_t maxUs = stats.maxUs.load(std::memory_order_relaxed);
+        while (durationInUs > maxUs && !stats.maxUs.compare_exchange_weak(maxUs, durationInUs, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Calls recorded while printing may end up partially in this and partially in the next report.
+     */
+    void PrintAndReset() {
+        for (uint32_t op = 0; op < OPERATION_COUNT; op++) {
+            auto &stats    = sStats[op];
+            uint32_t count = stats.count.exchange(0, std::memory_order_relaxed);
+            uint64_t total = stats.totalUsLow.exchange(0, std::memory_order_relaxed);
+            total |= (uint64_t) stats.totalUsHigh.exchange(0, std::memory_order_relaxed) << 32;
+            uint32_t maxUs = stats.maxUs.exchange(0, std::memory_order_relaxed);
+            uint32_t buckets[BUCKET_COUNT];
+            for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+                buckets[i] = stats.buckets[i].exchange(0, std::memory_order_relaxed);
+            }
+            if (count > 0) {
+                DEBUG_FUNCTION_LINE("[Storage] %-12s calls: %6u avg: %6llu us p50: <%6u us p99: <%6u us max: %6u us",
+                                    GetOperationName((Operation) op), count, total / count,
+                                    GetPercentile(buckets, count, 50), GetPercentile(buckets, count, 99), maxUs);
+            }
+        }
+    }
+} // namespace StorageStats
+#endif
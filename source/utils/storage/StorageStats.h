@@ -0,0 +1,55 @@
+#pragma once
+
+#include <coreinit/time.h>
+#include <cstdint>
+
+/**
+ * Latency statistics for the storage API, only collected in DEBUG builds.
+ * The stats are printed (and reset) once the last opened storage has been closed.
+ */
+namespace StorageStats {
+    enum Operation {
+        OPERATION_OPEN,
+        OPERATION_CLOSE,
+        OPERATION_SAVE,
+        OPERATION_RELOAD,
+        OPERATION_WIPE,
+        OPERATION_GET,
+        OPERATION_GET_SIZE,
+        OPERATION_STORE,
+        OPERATION_GET_BATCH,
+        OPERATION_STORE_BATCH,
+        OPERATION_DELETE,
+        OPERATION_SUB_ITEM,
+        OPERATION_COUNT,
+    };
+
+#ifdef DEBUG
+    void Record(Operation operation, uint32_t durationInUs);
+
+    void PrintAndReset();
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Operation operation) : mOperation(operation), mStart(OSGetTime()) {
+        }
+
+        ~ScopedTimer() {
+            Record(mOperation, OSTicksToMicroseconds(OSGetTime() - mStart));
+        }
+
+    private:
+        Operation mOperation;
+        OSTime mStart;
+    };
+#else
+    inline void PrintAndReset() {
+    }
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Operation) {
+        }
+    };
+#endif
+} // namespace StorageStats
@@ -3,7 +3,7 @@
 StorageSubItem *StorageSubItem::getSubItem(wups_storage_item item) {
     // Try to find the sub-item based on item handle.
     for (auto &cur : mSubCategories) {
-        if (cur.getHandle() == (uint32_t) item) {
+        if (cur.getHandle() == (uintptr_t) item) {
             return &cur;
         }
     }
@@ -19,66 +19,62 @@ StorageSubItem *StorageSubItem::getSubItem(wups_storage_item item) {
     return nullptr;
 }
 
-const StorageSubItem *StorageSubItem::getSubItem(const char *key) const {
-    // Try to find the sub-item based on key.
-    for (const auto &cur : mSubCategories) {
-        if (cur.getKey() == key) {
-            return &cur;
-        }
-    }
+const StorageSubItem *StorageSubItem::getSubItem(std::string_view key) const {
+    return mSubCategories.find(key);
+}
 
-    return nullptr;
+StorageSubItem *StorageSubItem::getSubItem(std::string_view key) {
+    return mSubCategories.find(key);
 }
 
-bool StorageSubItem::deleteItem(const char *key) {
-    if (remove_first_if(mSubCategories, [key](auto &cur) { return cur.getKey() == key; })) {
+bool StorageSubItem::deleteItem(std::string_view key) {
+    if (mSubCategories.erase(key)) {
         return true;
     }
-
-    auto itemItr = mItems.find(key);
-    if (itemItr != mItems.end()) {
-        mItems.erase(itemItr);
-        return true; // Item found and deleted.
-    }
-    return false;
+    return mItems.erase(key);
 }
 
-StorageItem *StorageSubItem::createItem(const char *key, StorageSubItem::StorageSubItemError &error) {
-    for (const auto &cur : mSubCategories) {
-        if (cur.getKey() == key) {
-            error = STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE;
-            return nullptr;
-        }
+StorageItem *StorageSubItem::createItem(std::string_view key, StorageSubItem::StorageSubItemError &error) {
+    if (mSubCategories.contains(key)) {
+        error = STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE;
+        return nullptr;
     }
 
-    auto result = mItems.insert({key, StorageItem(key)});
-    if (result.second) {
-        return &result.first->second;
+    bool alreadyExists = false;
+    auto res           = mItems.emplace(key, alreadyExists);
+    if (!res) {
+        error = alreadyExists ? STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE : STORAGE_SUB_ITEM_ERROR_MALLOC_FAILED;
     }
-    return nullptr;
+    return res;
 }
 
-StorageSubItem *StorageSubItem::createSubItem(const char *key, StorageSubItem::StorageSubItemError &error) {
-    auto resItr = mItems.find(key);
-    if (resItr != mItems.end()) {
+StorageSubItem *StorageSubItem::createSubItem(std::string_view key, StorageSubItem::StorageSubItemError &error) {
+    if (mItems.contains(key)) {
         error = STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE;
         return nullptr;
     }
-    for (const auto &cur : mSubCategories) {
-        if (cur.getKey() == key) {
-            error = STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE;
-            return nullptr;
-        }
+
+    bool alreadyExists = false;
+    auto res           = mSubCategories.emplace(key, alreadyExists);
+    if (!res) {
+        error = alreadyExists ? STORAGE_SUB_ITEM_KEY_ALREADY_IN_USE : STORAGE_SUB_ITEM_ERROR_MALLOC_FAILED;
+        return nullptr;
     }
+    res->mParent = this;
+    return res;
+}
 
-    mSubCategories.emplace_front(key);
-    return &mSubCategories.front();
+StorageItem *StorageSubItem::getItem(std::string_view name) {
+    return mItems.find(name);
 }
 
-StorageItem *StorageSubItem::getItem(const char *name) {
-    auto resItr = mItems.find(name);
-    if (resItr != mItems.end()) {
-        return &resItr->second;
+uint32_t StorageSubItem::getTreeMemoryUsage() const {
+    uint32_t res = GetMemoryUsage(getKey().size());
+    for (const auto &item : mItems) {
+        res += item.getMemoryUsage();
     }
-    return nullptr;
+    for (const auto &subItem : mSubCategories) {
+        res += subItem.getTreeMemoryUsage();
+    }
+    return res;
 }
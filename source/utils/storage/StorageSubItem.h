@@ -1,10 +1,11 @@
 #pragma once
 
 #include "StorageItem.h"
+#include "StorageItemMap.h"
 #include "utils/utils.h"
-#include <map>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <wups/storage.h>
@@ -22,25 +23,44 @@ public:
 
     StorageSubItem *getSubItem(wups_storage_item item);
 
-    const StorageSubItem *getSubItem(const char *key) const;
+    const StorageSubItem *getSubItem(std::string_view key) const;
 
-    bool deleteItem(const char *key);
+    StorageSubItem *getSubItem(std::string_view key);
 
-    StorageItem *createItem(const char *key, StorageSubItem::StorageSubItemError &error);
+    bool deleteItem(std::string_view key);
 
-    StorageSubItem *createSubItem(const char *key, StorageSubItem::StorageSubItemError &error);
+    StorageItem *createItem(std::string_view key, StorageSubItem::StorageSubItemError &error);
 
-    StorageItem *getItem(const char *name);
+    StorageSubItem *createSubItem(std::string_view key, StorageSubItem::StorageSubItemError &error);
 
-    [[nodiscard]] const std::forward_list<StorageSubItem> &getSubItems() const {
+    StorageItem *getItem(std::string_view name);
+
+    /**
+     * Memory accounted to this sub item and all of its children, see StorageItem::getMemoryUsage()
+     */
+    [[nodiscard]] uint32_t getTreeMemoryUsage() const;
+
+    static uint32_t GetMemoryUsage(size_t keySize) {
+        return sizeof(StorageSubItem) + GetKeyMemoryUsage(keySize);
+    }
+
+    [[nodiscard]] const StorageItemMap<StorageSubItem> &getSubItems() const {
         return mSubCategories;
     }
 
-    [[nodiscard]] const std::map<std::string, StorageItem> &getItems() const {
+    [[nodiscard]] const StorageItemMap<StorageItem> &getItems() const {
         return mItems;
     }
 
+    /**
+     * Returns nullptr for the root item.
+     */
+    [[nodiscard]] const StorageSubItem *getParent() const {
+        return mParent;
+    }
+
 protected:
-    std::forward_list<StorageSubItem> mSubCategories;
-    std::map<std::string, StorageItem> mItems;
+    StorageItemMap<StorageSubItem> mSubCategories;
+    StorageItemMap<StorageItem> mItems;
+    StorageSubItem *mParent = nullptr;
 };
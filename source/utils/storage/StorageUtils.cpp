@@ -1,18 +1,32 @@
 #include "StorageUtils.h"
 #include "NotificationsUtils.h"
+#include "StorageBlobs.h"
+#include "StorageCache.h"
+#include "StorageCompression.h"
 #include "StorageItemRoot.h"
-#include "fs/CFile.hpp"
+#include "StorageJournal.h"
+#include "StorageStats.h"
 #include "fs/FSUtils.h"
 #include "utils/StringTools.h"
 #include "utils/base64.h"
 #include "utils/json.hpp"
 #include "utils/logger.h"
 #include "utils/utils.h"
+#include <atomic>
+#include <condition_variable>
+#include <coreinit/thread.h>
+#include <list>
 #include <memory>
+#include <shared_mutex>
 #include <string>
 namespace StorageUtils {
-    std::forward_list<StorageItemRoot> gStorage;
-    std::mutex gStorageMutex;
+    // Only guards opening/closing of storages, every StorageItemRoot has its own lock for the item tree.
+    std::forward_list<std::shared_ptr<StorageItemRoot>> gStorage;
+    std::shared_mutex gStorageMutex;
+
+    // 0 means no quota
+    std::atomic<uint32_t> gStorageSoftQuota = DEFAULT_STORAGE_SOFT_QUOTA;
+    std::atomic<uint32_t> gStorageHardQuota = DEFAULT_STORAGE_HARD_QUOTA;
 
     namespace Helper {
         static WUPSStorageError ConvertToWUPSError(const StorageSubItem::StorageSubItemError &error) {
@@ -27,11 +41,26 @@ namespace StorageUtils {
             return WUPS_STORAGE_ERROR_UNKNOWN_ERROR;
         }
 
+        static bool deserializeValue(const nlohmann::json &value, StorageItem &item) {
+            if (value.is_string()) {
+                return item.setValue(value.get_ref<const std::string &>());
+            } else if (value.is_boolean()) {
+                return item.setValue(value.get<bool>());
+            } else if (value.is_number_unsigned()) {
+                return item.setValue(value.get<std::uint64_t>());
+            } else if (value.is_number_integer()) {
+                return item.setValue(value.get<std::int64_t>());
+            } else if (value.is_number_float()) {
+                return item.setValue(value.get<std::double_t>());
+            }
+            return false;
+        }
+
         static bool deserializeFromJson(const nlohmann::json &json, StorageSubItem &item) {
             for (auto it = json.begin(); it != json.end(); ++it) {
                 StorageSubItem::StorageSubItemError subItemError = StorageSubItem::STORAGE_SUB_ITEM_ERROR_NONE;
                 if (it.value().is_object()) {
-                    auto res = item.createSubItem(it.key().c_str(), subItemError);
+                    auto res = item.createSubItem(it.key(), subItemError);
                     if (!res) {
                         DEBUG_FUNCTION_LINE_WARN("Failed to create sub item: Error %d", subItemError);
                         return false;
@@ -43,28 +72,13 @@ namespace StorageUtils {
                         }
                     }
                 } else {
-                    auto res = item.createItem(it.key().c_str(), subItemError);
+                    auto res = item.createItem(it.key(), subItemError);
 
                     if (!res) {
                         DEBUG_FUNCTION_LINE_WARN("Failed to create Item for key %s. Error %d", it.key().c_str(), subItemError);
                         return false;
                     }
-                    if (it.value().is_string()) {
-                        auto val = it.value().get<std::string>();
-                        res->setValue(val);
-                    } else if (it.value().is_boolean()) {
-                        auto val = it.value().get<bool>();
-                        res->setValue(val);
-                    } else if (it.value().is_number_unsigned()) {
-                        auto val = it.value().get<std::uint64_t>();
-                        res->setValue(val);
-                    } else if (it.value().is_number_integer()) {
-                        auto val = it.value().get<std::int64_t>();
-                        res->setValue(val);
-                    } else if (it.value().is_number_float()) {
-                        auto val = it.value().get<std::double_t>();
-                        res->setValue(val);
-                    } else {
+                    if (!deserializeValue(it.value(), *res)) {
                         DEBUG_FUNCTION_LINE_ERR("Unknown type %s for value %s", it.value().type_name(), it.key().c_str());
                     }
                 }
@@ -72,207 +86,511 @@ namespace StorageUtils {
             return true;
         }
 
-        static std::unique_ptr<StorageItemRoot> deserializeFromJson(const nlohmann::json &json, std::string_view key) {
-            if (json.empty() || !json.is_object()) {
-                return nullptr;
-            }
-            auto root = make_unique_nothrow<StorageItemRoot>(key);
-            if (root) {
-                if (deserializeFromJson(json, *root)) {
-                    return root;
+        /**
+         * Serializes the value of an item, binary items are always encoded as base64.
+         */
+        static bool serializeValue(const StorageItem &value, nlohmann::json &out) {
+            switch ((StorageItemType) value.getType()) {
+                case StorageItemType::String: {
+                    auto res = value.getStringValue();
+                    if (res) {
+                        out = std::string(*res);
+                        return true;
+                    }
+                    break;
+                }
+                case StorageItemType::Boolean: {
+                    bool res;
+                    if (value.getValue(res)) {
+                        out = res;
+                        return true;
+                    }
+                    break;
+                }
+                case StorageItemType::S64: {
+                    int64_t res;
+                    if (value.getValue(res)) {
+                        out = res;
+                        return true;
+                    }
+                    break;
                 }
+                case StorageItemType::U64: {
+                    uint64_t res;
+                    if (value.getValue(res)) {
+                        out = res;
+                        return true;
+                    }
+                    break;
+                }
+                case StorageItemType::Double: {
+                    double res;
+                    if (value.getValue(res)) {
+                        out = res;
+                        return true;
+                    }
+                    break;
+                }
+                case StorageItemType::Binary: {
+                    auto tmp = value.getBinaryValue();
+                    if (tmp) {
+                        std::string enc;
+                        if (b64_encode(tmp->data(), tmp->size(), enc)) {
+                            out = std::move(enc);
+                            return true;
+                        }
+                        DEBUG_FUNCTION_LINE_WARN("Failed to store binary item: Malloc failed");
+                    }
+                    break;
+                }
+                case StorageItemType::None:
+                    DEBUG_FUNCTION_LINE_WARN("Skip: StorageItemType::None");
+                    break;
             }
-            return nullptr;
+            return false;
         }
 
-        static nlohmann::json serializeToJson(const StorageSubItem &baseItem) {
+        struct SerializedBlobs {
+            // All blobs referenced by the serialized tree
+            StorageBlobs::BlobNameSet referenced;
+            // Blobs which might not exist on the SD card yet
+            std::vector<StorageBlobs::PendingBlob> pending;
+        };
+
+        /**
+         * Binary items bigger than StorageBlobs::BLOB_THRESHOLD are replaced by a reference. Blobs which are not part of `writtenBlobs`
+         * are copied to `blobs.pending` so they can be written after the lock on the tree has been released.
+         */
+        static nlohmann::json serializeToJson(const StorageSubItem &baseItem, const StorageBlobs::BlobNameSet &writtenBlobs, SerializedBlobs &blobs) {
             nlohmann::json json = nlohmann::json::object();
 
             for (const auto &curSubItem : baseItem.getSubItems()) {
-                json[curSubItem.getKey()] = serializeToJson(curSubItem);
+                json[std::string(curSubItem.getKey())] = serializeToJson(curSubItem, writtenBlobs, blobs);
             }
 
-            for (const auto &[key, value] : baseItem.getItems()) {
-                switch ((StorageItemType) value.getType()) {
-                    case StorageItemType::String: {
-                        std::string res;
-                        if (value.getValue(res)) {
-                            json[key] = res;
-                        }
-                        break;
-                    }
-                    case StorageItemType::Boolean: {
-                        bool res;
-                        if (value.getValue(res)) {
-                            json[key] = res;
-                        }
-                        break;
-                    }
-                    case StorageItemType::S64: {
-                        int64_t res;
-                        if (value.getValue(res)) {
-                            json[key] = res;
-                        }
-                        break;
-                    }
-                    case StorageItemType::U64: {
-                        uint64_t res;
-                        if (value.getValue(res)) {
-                            json[key] = res;
-                        }
-                        break;
+            for (const auto &value : baseItem.getItems()) {
+                std::string key(value.getKey());
+                if (auto str = value.getStringValue()) {
+                    // Keep references to blobs that haven't been loaded yet.
+                    auto blobName = StorageBlobs::GetNameFromReference(*str);
+                    if (!blobName.empty()) {
+                        blobs.referenced.emplace(blobName);
                     }
-                    case StorageItemType::Double: {
-                        double res;
-                        if (value.getValue(res)) {
-                            json[key] = res;
-                        }
-                        break;
-                    }
-                    case StorageItemType::Binary: {
-                        std::vector<uint8_t> tmp;
-                        if (value.getValue(tmp)) {
-                            auto *enc = b64_encode(tmp.data(), tmp.size());
-                            if (enc) {
-                                json[key] = enc;
-                                free(enc);
-                            } else {
-                                DEBUG_FUNCTION_LINE_WARN("Failed to store binary item: Malloc failed");
-                            }
-                        }
-                        break;
+                } else if (auto bin = value.getBinaryValue(); bin && bin->size() >= StorageBlobs::BLOB_THRESHOLD) {
+                    auto blobName = StorageBlobs::GetName(*bin);
+                    if (!writtenBlobs.contains(blobName)) {
+                        blobs.pending.push_back({blobName, *bin});
                     }
-                    case StorageItemType::None:
-                        DEBUG_FUNCTION_LINE_WARN("Skip: StorageItemType::None");
-                        break;
+                    json[key] = StorageBlobs::GetReference(blobName);
+                    blobs.referenced.emplace(std::move(blobName));
+                    continue;
+                }
+                nlohmann::json res;
+                if (serializeValue(value, res)) {
+                    json[key] = std::move(res);
                 }
             }
 
             return json;
         }
 
-        static StorageItemRoot *getRootItem(wups_storage_root_item root) {
-            for (auto &cur : gStorage) {
-                if (cur.getHandle() == (uint32_t) root) {
-                    return &cur;
+        /**
+         * Returns the keys from the root to the given sub item, the root itself is not part of the path.
+         */
+        static nlohmann::json getJournalPath(const StorageSubItem &item) {
+            std::vector<const StorageSubItem *> items;
+            for (auto cur = &item; cur->getParent() != nullptr; cur = cur->getParent()) {
+                items.push_back(cur);
+            }
+            nlohmann::json path = nlohmann::json::array();
+            for (auto it = items.rbegin(); it != items.rend(); ++it) {
+                path.push_back(std::string((*it)->getKey()));
+            }
+            return path;
+        }
+
+        /**
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static void addStoreRecord(StorageItemRoot &rootItem, const StorageSubItem &parent, const StorageItem &item) {
+            auto bin = item.getBinaryValue();
+            if (bin && bin->size() >= StorageBlobs::BLOB_THRESHOLD) {
+                // Blobs are only written as part of a snapshot.
+                rootItem.getJournal().requestSnapshot();
+                return;
+            }
+            rootItem.getJournal().addStore(parent, item);
+        }
+
+        static void removeStoreRecords(StorageJournal &journal, const StorageSubItem &subItem) {
+            for (const auto &item : subItem.getItems()) {
+                journal.removeStore(item);
+            }
+            for (const auto &cur : subItem.getSubItems()) {
+                removeStoreRecords(journal, cur);
+            }
+        }
+
+        /**
+         * Needs to be called before deleting the (sub) item with the given key. The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static void removeStoreRecords(StorageItemRoot &rootItem, StorageSubItem &parent, std::string_view key) {
+            auto &journal = rootItem.getJournal();
+            if (!journal.hasPendingStores()) {
+                return;
+            }
+            if (auto item = parent.getItem(key)) {
+                journal.removeStore(*item);
+            } else if (auto subItem = parent.getSubItem(key)) {
+                removeStoreRecords(journal, *subItem);
+            }
+        }
+
+        /**
+         * Creates the journal lines for the pending changes. The caller needs to hold a (shared) lock on rootItem.getMutex()
+         * @return false if the changes can't be expressed as records.
+         */
+        static bool getPendingRecords(const std::vector<StorageJournal::PendingChange> &changes, std::string &outRecords) {
+            for (const auto &change : changes) {
+                if (!change.record.empty()) {
+                    outRecords += change.record;
+                } else if (change.item) {
+                    nlohmann::json value;
+                    if (!serializeValue(*change.item, value)) {
+                        return false;
+                    }
+                    outRecords += StorageJournal::FormatRecord(nlohmann::json::array({"s", getJournalPath(*change.parent), std::string(change.item->getKey()), std::move(value)}));
                 }
             }
+            return true;
+        }
 
-            return nullptr;
+        /**
+         * Applies a journal record to the tree. Records which can't be applied are skipped.
+         */
+        static bool applyJournalRecord(StorageItemRoot &rootItem, const nlohmann::json &record) {
+            if (!record.is_array() || record.size() < 3 || !record[0].is_string() || !record[1].is_array() || !record[2].is_string()) {
+                return false;
+            }
+            const auto &type = record[0].get_ref<const std::string &>();
+            const auto &key  = record[2].get_ref<const std::string &>();
+
+            StorageSubItem::StorageSubItemError error = StorageSubItem::STORAGE_SUB_ITEM_ERROR_NONE;
+            StorageSubItem *parent                    = &rootItem;
+            for (const auto &pathElement : record[1]) {
+                if (!pathElement.is_string()) {
+                    return false;
+                }
+                const auto &subItemKey = pathElement.get_ref<const std::string &>();
+                auto subItem           = parent->getSubItem(subItemKey);
+                if (!subItem && !(subItem = parent->createSubItem(subItemKey, error))) {
+                    return false;
+                }
+                parent = subItem;
+            }
+
+            if (type == "s" && record.size() == 4) {
+                auto item = parent->getItem(key);
+                if (!item && !(item = parent->createItem(key, error))) {
+                    return false;
+                }
+                return deserializeValue(record[3], *item);
+            } else if (type == "d") {
+                return parent->deleteItem(key);
+            } else if (type == "c") {
+                return parent->getSubItem(key) || parent->createSubItem(key, error);
+            }
+            return false;
         }
 
-        static StorageSubItem *getSubItem(wups_storage_root_item root, wups_storage_item parent) {
-            auto rootItem = getRootItem(root);
-            if (rootItem) {
-                if (parent == nullptr) {
-                    return rootItem;
+        /**
+         * Looks up an opened root. The returned shared_ptr keeps the root alive even if the storage is closed concurrently.
+         */
+        static std::shared_ptr<StorageItemRoot> getRootItem(wups_storage_root_item root) {
+            std::shared_lock lock(gStorageMutex);
+            for (const auto &cur : gStorage) {
+                if (cur->getHandle() == (uintptr_t) root) {
+                    return cur;
                 }
-                return rootItem->getSubItem(parent);
             }
+
             return nullptr;
         }
 
-        WUPSStorageError LoadFromFile(std::string_view plugin_id, nlohmann::json &outJson) {
+        /**
+         * The caller needs to hold a lock on rootItem.getMutex()
+         */
+        static StorageSubItem *getSubItem(StorageItemRoot &rootItem, wups_storage_item parent) {
+            if (parent == nullptr) {
+                return &rootItem;
+            }
+            return rootItem.getSubItem(parent);
+        }
+
+        /**
+         * @param outChecksum  optional, receives the checksum of the snapshot the journal has to belong to.
+         */
+        WUPSStorageError LoadFromFile(std::string_view plugin_id, nlohmann::json &outJson, uint32_t *outFileSize = nullptr, uint32_t *outChecksum = nullptr) {
             std::string filePath = getPluginPath() + "/config/" + plugin_id.data() + ".json";
-            CFile file(filePath, CFile::ReadOnly);
-            if (!file.isOpen() || file.size() == 0) {
-                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            uint8_t *json_data   = nullptr;
+            uint32_t dataSize    = 0;
+            uint32_t fileSize    = 0;
+            if (auto err = StorageCompression::ReadFile(filePath, json_data, dataSize, fileSize); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                return err;
             }
-            auto *json_data = (uint8_t *) memalign(0x40, ROUNDUP(file.size() + 1, 0x40));
-            if (!json_data) {
-                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            if (outFileSize) {
+                *outFileSize = fileSize;
             }
-            WUPSStorageError result = WUPS_STORAGE_ERROR_SUCCESS;
-            uint64_t readRes        = file.read(json_data, file.size());
-            if (readRes == file.size()) {
-                json_data[file.size()] = '\0';
-                outJson                = nlohmann::json::parse(json_data, nullptr, false);
-            } else {
-                result = WUPS_STORAGE_ERROR_IO_ERROR;
+            if (outChecksum) {
+                *outChecksum = StorageJournal::GetSnapshotChecksum(std::string_view((const char *) json_data, dataSize));
             }
-            file.close();
+            outJson = nlohmann::json::parse(json_data, json_data + dataSize, nullptr, false);
             free(json_data);
-            return result;
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        /**
+         * Replaces the content of rootItem with the items of the given json. Invalid or empty json results in an empty root.
+         * The caller needs to hold a unique lock on rootItem.getMutex() if the root is already accessible by other threads.
+         */
+        static void LoadFromJson(const nlohmann::json &j, StorageItemRoot &rootItem) {
+            rootItem.wipe();
+            if (j.empty() || !j.is_object() || !j.contains("storageitems") || j["storageitems"].empty() || !j["storageitems"].is_object()) {
+                return;
+            }
+            if (!deserializeFromJson(j["storageitems"], rootItem)) {
+                rootItem.wipe();
+            }
         }
 
+        /**
+         * Loads the snapshot and replays the journal on top of it. Discards all unsaved changes.
+         */
         WUPSStorageError LoadFromFile(std::string_view plugin_id, StorageItemRoot &rootItem) {
+            // Make sure we don't read the files while they are written.
+            std::lock_guard saveLock(rootItem.getSaveMutex());
+            auto &journal = rootItem.getJournal();
+
             nlohmann::json j;
             WUPSStorageError err;
+            uint32_t snapshotFileSize = 0;
+            uint32_t snapshotChecksum = 0;
 
-            if ((err = LoadFromFile(plugin_id, j)) != WUPS_STORAGE_ERROR_SUCCESS) {
+            if ((err = LoadFromFile(plugin_id, j, &snapshotFileSize, &snapshotChecksum)) != WUPS_STORAGE_ERROR_SUCCESS) {
                 return err;
             }
 
-            std::unique_ptr<StorageItemRoot> storage;
-            if (j.empty() || !j.is_object() || !j.contains("storageitems") || j["storageitems"].empty() || !j["storageitems"].is_object()) {
-                storage = make_unique_nothrow<StorageItemRoot>(plugin_id);
-            } else {
-                storage = StorageUtils::Helper::deserializeFromJson(j["storageitems"], plugin_id);
-                if (!storage) {
-                    storage = make_unique_nothrow<StorageItemRoot>(plugin_id);
+            std::vector<nlohmann::json> records;
+            uint32_t journalFileSize = 0;
+            bool journalValid        = StorageJournal::ReadFile(plugin_id, snapshotChecksum, records, journalFileSize);
+
+            std::unique_lock lock(rootItem.getMutex());
+            LoadFromJson(j, rootItem);
+            for (const auto &record : records) {
+                if (!applyJournalRecord(rootItem, record)) {
+                    DEBUG_FUNCTION_LINE_WARN("Skipping journal record for \"%s\"", rootItem.getPluginId().c_str());
                 }
             }
-            rootItem = std::move(*storage);
+
+            rootItem.recalculateMemoryUsage();
+            rootItem.softQuotaExceeded = false;
+
+            journal.clearPending();
+            journal.hasSnapshot      = true;
+            journal.snapshotFileSize = snapshotFileSize;
+            journal.snapshotChecksum = snapshotChecksum;
+            journal.journalFileSize  = journalFileSize;
+            if (!journalValid) {
+                // Records appended after a torn record would never be replayed and a journal of an older snapshot must not
+                // be appended to, the next save has to write a snapshot.
+                journal.requestSnapshot();
+            }
             return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-        static WUPSStorageError WriteStorageToSD(wups_storage_root_item root, bool forceSave) {
-            const StorageItemRoot *rootItem = nullptr;
-            for (const auto &cur : gStorage) {
-                if (cur.getHandle() == (uint32_t) root) {
-                    rootItem = &cur;
-                    break;
-                }
-            }
-            if (!rootItem) {
-                return WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED;
+        /**
+         * Needs to be called after the current state has been written as snapshot, the journal isn't needed anymore.
+         */
+        static void OnSnapshotWritten(StorageItemRoot &rootItem, uint32_t snapshotFileSize, uint32_t snapshotChecksum) {
+            auto &journal = rootItem.getJournal();
+            // A journal which doesn't get removed (e.g. because of a crash) belongs to an older snapshot and will be ignored.
+            if (journal.journalFileSize > 0 || !journal.hasSnapshot) {
+                StorageJournal::RemoveFile(rootItem.getPluginId());
             }
+            journal.hasSnapshot      = true;
+            journal.snapshotFileSize = snapshotFileSize;
+            journal.snapshotChecksum = snapshotChecksum;
+            journal.journalFileSize  = 0;
+        }
 
+        /**
+         * The caller needs to hold the save mutex of the root.
+         */
+        static WUPSStorageError WriteSnapshotToSD(StorageItemRoot &rootItem, bool forceSave) {
             std::string folderPath = getPluginPath() + "/config/";
-            std::string filePath   = folderPath + rootItem->getPluginId() + ".json";
+            std::string filePath   = folderPath + rootItem.getPluginId() + ".json";
 
             nlohmann::json j;
-            j["storageitems"] = serializeToJson(*rootItem);
+            SerializedBlobs blobs;
+            {
+                std::shared_lock lock(rootItem.getMutex());
+                j["storageitems"] = serializeToJson(rootItem, rootItem.getWrittenBlobs(), blobs);
+            }
+
+            // Blobs need to exist before the json references them.
+            for (const auto &blob : blobs.pending) {
+                if (auto err = StorageBlobs::WriteBlob(rootItem.getPluginId(), blob.name, blob.data); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                    DEBUG_FUNCTION_LINE_ERR("Failed to write blob for \"%s.json\"", rootItem.getPluginId().c_str());
+                    return err;
+                }
+                rootItem.getWrittenBlobs().insert(blob.name);
+            }
 
             if (!forceSave) {
                 nlohmann::json jsonFromFile;
                 WUPSStorageError loadErr;
-                if ((loadErr = Helper::LoadFromFile(rootItem->getPluginId(), jsonFromFile)) == WUPS_STORAGE_ERROR_SUCCESS) {
+                uint32_t fileSize = 0;
+                uint32_t checksum = 0;
+                if ((loadErr = Helper::LoadFromFile(rootItem.getPluginId(), jsonFromFile, &fileSize, &checksum)) == WUPS_STORAGE_ERROR_SUCCESS) {
                     if (j == jsonFromFile) {
-                        DEBUG_FUNCTION_LINE_VERBOSE("Storage has no changes, avoid saving \"%s.json\"", rootItem->getPluginId().c_str());
+                        DEBUG_FUNCTION_LINE_VERBOSE("Storage has no changes, avoid saving \"%s.json\"", rootItem.getPluginId().c_str());
+                        OnSnapshotWritten(rootItem, fileSize, checksum);
                         return WUPS_STORAGE_ERROR_SUCCESS;
                     }
                 } else if (loadErr != WUPS_STORAGE_ERROR_NOT_FOUND) {
-                    DEBUG_FUNCTION_LINE_WARN("Failed to load \"%s.json\"", rootItem->getPluginId().c_str());
+                    DEBUG_FUNCTION_LINE_WARN("Failed to load \"%s.json\"", rootItem.getPluginId().c_str());
                 }
-                DEBUG_FUNCTION_LINE_VERBOSE("Saving \"%s.json\"...", rootItem->getPluginId().c_str());
+                DEBUG_FUNCTION_LINE_VERBOSE("Saving \"%s.json\"...", rootItem.getPluginId().c_str());
             } else {
-                DEBUG_FUNCTION_LINE_VERBOSE("Force saving \"%s.json\"...", rootItem->getPluginId().c_str());
+                DEBUG_FUNCTION_LINE_VERBOSE("Force saving \"%s.json\"...", rootItem.getPluginId().c_str());
             }
 
             if (!FSUtils::CreateSubfolder(folderPath)) {
                 return WUPS_STORAGE_ERROR_IO_ERROR;
             }
 
-            CFile file(filePath, CFile::WriteOnly);
-            if (!file.isOpen()) {
-                DEBUG_FUNCTION_LINE_ERR("Cannot create file %s", filePath.c_str());
-                return WUPS_STORAGE_ERROR_IO_ERROR;
+            std::string jsonString = j.dump(4, ' ', false, nlohmann::json::error_handler_t::ignore);
+            uint32_t fileSize      = 0;
+            if (auto err = StorageCompression::WriteFile(filePath, jsonString, fileSize); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                return err;
             }
 
-            std::string jsonString = j.dump(4, ' ', false, nlohmann::json::error_handler_t::ignore);
-            auto writeResult       = file.write((const uint8_t *) jsonString.c_str(), jsonString.size());
+            OnSnapshotWritten(rootItem, fileSize, StorageJournal::GetSnapshotChecksum(jsonString));
 
-            file.close();
+            StorageBlobs::RemoveUnusedBlobs(rootItem.getPluginId(), blobs.referenced);
+            std::erase_if(rootItem.getWrittenBlobs(), [&blobs](const auto &name) { return !blobs.referenced.contains(name); });
 
-            if (writeResult != (int32_t) jsonString.size()) {
-                return WUPS_STORAGE_ERROR_IO_ERROR;
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        /**
+         * Appends the pending changes to the journal if possible, otherwise writes a new snapshot.
+         */
+        static WUPSStorageError WriteStorageToSD(StorageItemRoot &rootItem, bool forceSave, bool allowJournal) {
+            // Only hold the lock of the item tree while serializing, the file IO just needs to be exclusive per root.
+            std::lock_guard saveLock(rootItem.getSaveMutex());
+            auto &journal = rootItem.getJournal();
+
+            std::string records;
+            bool snapshotRequired;
+            {
+                std::shared_lock lock(rootItem.getMutex());
+                std::vector<StorageJournal::PendingChange> changes;
+                snapshotRequired = journal.takePending(changes);
+                if (!snapshotRequired && !getPendingRecords(changes, records)) {
+                    snapshotRequired = true;
+                }
+            }
+            if (allowJournal && !forceSave && !snapshotRequired && journal.hasSnapshot) {
+                if (records.empty()) {
+                    DEBUG_FUNCTION_LINE_VERBOSE("Storage has no changes, avoid saving \"%s.json\"", rootItem.getPluginId().c_str());
+                    return WUPS_STORAGE_ERROR_SUCCESS;
+                }
+                uint32_t newJournalFileSize = journal.journalFileSize + records.size();
+                if (newJournalFileSize < StorageJournal::MIN_COMPACTION_SIZE || newJournalFileSize <= journal.snapshotFileSize) {
+                    WUPSStorageError writeErr;
+                    if (journal.journalFileSize == 0) {
+                        writeErr = StorageJournal::CreateFile(rootItem.getPluginId(), journal.snapshotChecksum, records, newJournalFileSize);
+                    } else {
+                        writeErr = StorageJournal::AppendToFile(rootItem.getPluginId(), records);
+                    }
+                    if (writeErr == WUPS_STORAGE_ERROR_SUCCESS) {
+                        DEBUG_FUNCTION_LINE_VERBOSE("Appended %d bytes to the journal of \"%s\"", records.size(), rootItem.getPluginId().c_str());
+                        journal.journalFileSize = newJournalFileSize;
+                        return WUPS_STORAGE_ERROR_SUCCESS;
+                    }
+                    DEBUG_FUNCTION_LINE_WARN("Failed to append to the journal of \"%s\", writing a snapshot instead", rootItem.getPluginId().c_str());
+                }
+            }
+
+            auto res = WriteSnapshotToSD(rootItem, forceSave);
+            if (res != WUPS_STORAGE_ERROR_SUCCESS) {
+                // The pending records are gone, make sure the next save writes everything.
+                journal.requestSnapshot();
+            }
+            return res;
+        }
+
+        /**
+         * Binary items are serialized as base64 encoded string or as reference to a blob. The first time they are read they'll get converted into binary data.
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static WUPSStorageError FixBinaryItem(StorageItemRoot &rootItem, StorageItem &item) {
+            if (item.isBinaryConversionDone()) {
+                return WUPS_STORAGE_ERROR_SUCCESS;
+            }
+            uint32_t oldUsage = item.getMemoryUsage();
+            auto str          = item.getStringValue();
+            if (str && StorageBlobs::IsReference(*str)) {
+                std::vector<uint8_t> data;
+                if (auto err = StorageBlobs::LoadBlob(rootItem.getPluginId(), *str, data); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                    return err;
+                }
+                if (!item.setValue(std::move(data))) {
+                    return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+                }
+            } else if (!item.attemptBinaryConversion()) {
+                return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+            }
+            rootItem.updateMemoryUsage(oldUsage, item.getMemoryUsage());
+            return WUPS_STORAGE_ERROR_SUCCESS;
+        }
+
+        /**
+         * Checks if replacing an item which uses oldUsage bytes with one that uses newUsage bytes is within the quotas.
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static WUPSStorageError CheckQuota(StorageItemRoot &rootItem, uint32_t oldUsage, uint32_t newUsage) {
+            if (newUsage <= oldUsage) {
+                return WUPS_STORAGE_ERROR_SUCCESS;
+            }
+            uint64_t usage     = (uint64_t) rootItem.getMemoryUsage() - oldUsage + newUsage;
+            uint32_t hardQuota = gStorageHardQuota.load(std::memory_order_relaxed);
+            if (hardQuota != 0 && usage > hardQuota) {
+                DEBUG_FUNCTION_LINE_WARN("Storage \"%s\" would exceed the hard quota (%llu > %u bytes)", rootItem.getPluginId().c_str(), usage, hardQuota);
+                return WUPS_STORAGE_ERROR_QUOTA_EXCEEDED;
+            }
+            uint32_t softQuota = gStorageSoftQuota.load(std::memory_order_relaxed);
+            if (softQuota != 0 && usage > softQuota && !rootItem.softQuotaExceeded) {
+                DEBUG_FUNCTION_LINE_WARN("Storage \"%s\" exceeds the soft quota (%llu > %u bytes)", rootItem.getPluginId().c_str(), usage, softQuota);
+                rootItem.softQuotaExceeded = true;
             }
             return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-        static StorageItem *createOrGetItem(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageError &error) {
-            auto subItem = getSubItem(root, parent);
+        template<typename T>
+        static size_t GetValueSize(const T &value) {
+            if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::vector<uint8_t>>) {
+                return value.size();
+            } else {
+                return 0;
+            }
+        }
+
+        /**
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static StorageItem *createOrGetItem(StorageSubItem *subItem, const char *key, WUPSStorageError &error) {
             if (!subItem) {
                 error = WUPS_STORAGE_ERROR_NOT_FOUND;
                 return {};
@@ -290,194 +608,584 @@ namespace StorageUtils {
             return res;
         }
 
+        /**
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
         template<typename T>
-        WUPSStorageError StoreItemGeneric(wups_storage_root_item root, wups_storage_item parent, const char *key, T value) {
+        WUPSStorageError StoreItemGeneric(StorageItemRoot &rootItem, StorageSubItem *subItem, const char *key, T value) {
+            if (!subItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            auto item         = subItem->getItem(key);
+            uint32_t oldUsage = item ? item->getMemoryUsage() : 0;
             WUPSStorageError err;
-            auto item = createOrGetItem(root, parent, key, err);
+            if ((err = CheckQuota(rootItem, oldUsage, StorageItem::GetMemoryUsage(strlen(key), GetValueSize(value)))) != WUPS_STORAGE_ERROR_SUCCESS) {
+                return err;
+            }
+            bool created = item == nullptr;
+            item         = createOrGetItem(subItem, key, err);
             if (item && err == WUPS_STORAGE_ERROR_SUCCESS) {
-                item->setValue(value);
+                if (!item->setValue(std::move(value))) {
+                    // Don't leave an empty item behind
+                    if (created) {
+                        subItem->deleteItem(key);
+                    }
+                    return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+                }
+                rootItem.updateMemoryUsage(oldUsage, item->getMemoryUsage());
+                addStoreRecord(rootItem, *subItem, *item);
                 return WUPS_STORAGE_ERROR_SUCCESS;
             }
             return err;
         }
 
-        template<typename T>
-        WUPSStorageError GetItemEx(wups_storage_root_item root, wups_storage_item parent, const char *key, T &result) {
-            auto subItem = getSubItem(root, parent);
-            if (!subItem) {
-                return WUPS_STORAGE_ERROR_NOT_FOUND;
-            }
-            auto item = subItem->getItem(key);
-            if (item) {
-                if (item->getValue(result)) {
-                    return WUPS_STORAGE_ERROR_SUCCESS;
+        /**
+         * The caller needs to hold a unique lock on rootItem.getMutex()
+         */
+        static WUPSStorageError StoreItemLocked(StorageItemRoot &rootItem, StorageSubItem *subItem, const char *key, WUPSStorageItemType itemType, void *data, uint32_t length) {
+            switch ((WUPSStorageItemTypes) itemType) {
+                case WUPS_STORAGE_ITEM_S32: {
+                    if (data == nullptr || length != sizeof(int32_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as S32: %d", key, *(int32_t *) data);
+                    return StoreItemGeneric<int32_t>(rootItem, subItem, key, *(int32_t *) data);
+                }
+                case WUPS_STORAGE_ITEM_S64: {
+                    if (data == nullptr || length != sizeof(int64_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as S64: %lld", key, *(int64_t *) data);
+                    return StoreItemGeneric<int64_t>(rootItem, subItem, key, *(int64_t *) data);
+                }
+                case WUPS_STORAGE_ITEM_U32: {
+                    if (data == nullptr || length != sizeof(uint32_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as u32: %u", key, *(uint32_t *) data);
+                    return StoreItemGeneric<uint32_t>(rootItem, subItem, key, *(uint32_t *) data);
+                }
+                case WUPS_STORAGE_ITEM_U64: {
+                    if (data == nullptr || length != sizeof(uint64_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as u64: %llu", key, *(uint64_t *) data);
+                    return StoreItemGeneric<uint64_t>(rootItem, subItem, key, *(uint64_t *) data);
+                }
+                case WUPS_STORAGE_ITEM_STRING: {
+                    if (data == nullptr) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    std::string_view tmp = length > 0 ? std::string_view((const char *) data, length) : std::string_view();
+
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as string: %.*s", key, (int) tmp.size(), tmp.data());
+                    return StoreItemGeneric<std::string_view>(rootItem, subItem, key, tmp);
+                }
+                case WUPS_STORAGE_ITEM_BINARY: {
+                    if (data == nullptr && length > 0) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    std::vector<uint8_t> tmp = (data != nullptr && length > 0) ? std::vector<uint8_t>((uint8_t *) data, ((uint8_t *) data) + length) : std::vector<uint8_t>();
+
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as binary: size %d", key, tmp.size());
+                    return StoreItemGeneric<std::vector<uint8_t>>(rootItem, subItem, key, std::move(tmp));
+                }
+                case WUPS_STORAGE_ITEM_BOOL: {
+                    if (data == nullptr || length != sizeof(bool)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as bool: %d", key, *(bool *) data);
+                    return StoreItemGeneric<bool>(rootItem, subItem, key, *(bool *) data);
+                }
+                case WUPS_STORAGE_ITEM_FLOAT: {
+                    if (data == nullptr || length != sizeof(float)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as float: %f", key, *(float *) data);
+                    return StoreItemGeneric<float>(rootItem, subItem, key, *(float *) data);
+                }
+                case WUPS_STORAGE_ITEM_DOUBLE: {
+                    if (data == nullptr || length != sizeof(double)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as double: %f", key, *(double *) data);
+                    return StoreItemGeneric<double>(rootItem, subItem, key, *(double *) data);
                 }
-                return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
             }
-            return WUPS_STORAGE_ERROR_NOT_FOUND;
+            DEBUG_FUNCTION_LINE_ERR("Store failed!");
+            return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
         }
 
+        /**
+         * The caller needs to hold a lock on rootItem.getMutex()
+         */
         template<typename T>
-        WUPSStorageError GetItemGeneric(wups_storage_root_item root, wups_storage_item parent, const char *key, T *result, uint32_t *outSize) {
+        WUPSStorageError GetItemGeneric(StorageSubItem *subItem, const char *key, T *result, uint32_t *outSize) {
             if (!result) {
                 return WUPS_STORAGE_ERROR_INVALID_ARGS;
             }
+            if (!subItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            auto item = subItem->getItem(key);
+            if (!item) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
             T tmp;
-            auto res = GetItemEx<T>(root, parent, key, tmp);
-            if (res == WUPS_STORAGE_ERROR_SUCCESS) {
-                *result = tmp;
-                if (outSize) {
-                    *outSize = sizeof(T);
-                }
+            if (!item->getValue(tmp)) {
+                return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
             }
-            return res;
+            *result = tmp;
+            if (outSize) {
+                *outSize = sizeof(T);
+            }
+            return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-
         /**
-        * Binary items are serialized as base64 encoded string. The first time they are read they'll get converted into binary data.
-        */
-        WUPSStorageError GetAndFixBinaryItem(wups_storage_root_item root, wups_storage_item parent, const char *key, std::vector<uint8_t> &result) {
-            auto subItem = getSubItem(root, parent);
+         * The caller needs to hold a lock on rootItem.getMutex()
+         */
+        static WUPSStorageError GetStringItem(StorageSubItem *subItem, const char *key, void *data, uint32_t maxSize, uint32_t *outSize) {
             if (!subItem) {
                 return WUPS_STORAGE_ERROR_NOT_FOUND;
             }
-            WUPSStorageError err = WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
-            auto item            = subItem->getItem(key);
-            if (item) {
-                // Trigger potential string->binary conversion
-                if (!item->attemptBinaryConversion()) {
-                    return WUPS_STORAGE_ERROR_MALLOC_FAILED;
-                }
-                if (item->getValue(result)) {
-                    return WUPS_STORAGE_ERROR_SUCCESS;
-                }
-                return err;
+            auto item = subItem->getItem(key);
+            if (!item) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
             }
-            return WUPS_STORAGE_ERROR_NOT_FOUND;
+            auto str = item->getStringValue();
+            if (!str) {
+                return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
+            }
+            if (maxSize <= str->size()) { // maxSize needs to be bigger because of the null-terminator
+                return WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL;
+            }
+            memcpy(data, str->data(), str->size());
+            ((char *) data)[str->size()] = '\0';
+            if (outSize) {
+                *outSize = strlen((char *) data) + 1;
+            }
+            return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-        static WUPSStorageError GetStringItem(wups_storage_root_item root, wups_storage_item parent, const char *key, void *data, uint32_t maxSize, uint32_t *outSize) {
-            std::string tmp;
-            auto res = GetItemEx<std::string>(root, parent, key, tmp);
-            if (res == WUPS_STORAGE_ERROR_SUCCESS) {
-                if (maxSize <= tmp.size()) { // maxSize needs to be bigger because of the null-terminator
-                    return WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL;
-                }
-                strncpy((char *) data, tmp.c_str(), tmp.size());
-                ((char *) data)[maxSize - 1] = '\0';
-                if (outSize) {
-                    *outSize = strlen((char *) data) + 1;
-                }
+        /**
+        * Because of the binary conversion reading a binary item requires a unique lock on rootItem.getMutex().
+        */
+        static WUPSStorageError GetBinaryItem(StorageItemRoot &rootItem, StorageSubItem *subItem, const char *key, void *data, uint32_t maxSize, uint32_t *outSize) {
+            if (!subItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            auto item = subItem->getItem(key);
+            if (!item) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            // Trigger potential string->binary conversion
+            if (auto fixErr = FixBinaryItem(rootItem, *item); fixErr != WUPS_STORAGE_ERROR_SUCCESS) {
+                return fixErr;
+            }
+            auto binary = item->getBinaryValue();
+            if (!binary) {
+                return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
+            }
+            if (binary->empty()) { // we need this to support getting empty std::vector
                 return WUPS_STORAGE_ERROR_SUCCESS;
             }
-            return res;
+            if (data == nullptr) {
+                return WUPS_STORAGE_ERROR_INVALID_ARGS;
+            }
+            if (maxSize < binary->size()) {
+                return WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL;
+            }
+            memcpy(data, binary->data(), binary->size());
+            if (outSize) {
+                *outSize = binary->size();
+            }
+            return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
-        static WUPSStorageError GetBinaryItem(wups_storage_root_item root, wups_storage_item parent, const char *key, const void *data, uint32_t maxSize, uint32_t *outSize) {
-            std::vector<uint8_t> tmp;
-            auto res = GetAndFixBinaryItem(root, parent, key, tmp);
-            if (res == WUPS_STORAGE_ERROR_SUCCESS) {
-                if (tmp.empty()) { // we need this to support getting empty std::vector
-                    return WUPS_STORAGE_ERROR_SUCCESS;
+        /**
+         * The caller needs to hold a lock on rootItem.getMutex(), a unique lock when reading binary items.
+         */
+        static WUPSStorageError GetItemLocked(StorageItemRoot &rootItem, StorageSubItem *subItem, const char *key, WUPSStorageItemType itemType, void *data, uint32_t maxSize, uint32_t *outSize) {
+            if (outSize) {
+                *outSize = 0;
+            }
+            switch ((WUPSStorageItemTypes) itemType) {
+                case WUPS_STORAGE_ITEM_STRING: {
+                    if (!data || maxSize == 0) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetStringItem(subItem, key, data, maxSize, outSize);
                 }
-                if (data == nullptr) {
-                    return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                case WUPS_STORAGE_ITEM_BINARY: {
+                    return GetBinaryItem(rootItem, subItem, key, data, maxSize, outSize);
+                }
+                case WUPS_STORAGE_ITEM_BOOL: {
+                    if (!data || maxSize != sizeof(bool)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<bool>(subItem, key, (bool *) data, outSize);
                 }
-                if (maxSize < tmp.size()) {
-                    return WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL;
+                case WUPS_STORAGE_ITEM_S32: {
+                    if (!data || maxSize != sizeof(int32_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<int32_t>(subItem, key, (int32_t *) data, outSize);
                 }
-                memcpy((uint8_t *) data, tmp.data(), tmp.size());
-                if (outSize) {
-                    *outSize = tmp.size();
+                case WUPS_STORAGE_ITEM_S64: {
+                    if (!data || maxSize != sizeof(int64_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<int64_t>(subItem, key, (int64_t *) data, outSize);
+                }
+                case WUPS_STORAGE_ITEM_U32: {
+                    if (!data || maxSize != sizeof(uint32_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<uint32_t>(subItem, key, (uint32_t *) data, outSize);
+                }
+                case WUPS_STORAGE_ITEM_U64: {
+                    if (!data || maxSize != sizeof(uint64_t)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<uint64_t>(subItem, key, (uint64_t *) data, outSize);
+                }
+                case WUPS_STORAGE_ITEM_FLOAT: {
+                    if (!data || maxSize != sizeof(float)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<float>(subItem, key, (float *) data, outSize);
+                }
+                case WUPS_STORAGE_ITEM_DOUBLE: {
+                    if (!data || maxSize != sizeof(double)) {
+                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
+                    }
+                    return GetItemGeneric<double>(subItem, key, (double *) data, outSize);
                 }
-                return WUPS_STORAGE_ERROR_SUCCESS;
             }
-            return res;
+            return WUPS_STORAGE_ERROR_NOT_FOUND;
+        }
+
+        /**
+         * Resolves the parent handles of a batch, every distinct handle is only looked up once.
+         * The caller needs to hold a lock on rootItem.getMutex()
+         */
+        class BatchParentCache {
+        public:
+            explicit BatchParentCache(StorageItemRoot &rootItem) : mRootItem(rootItem) {
+            }
+
+            StorageSubItem *get(wups_storage_item parent) {
+                for (const auto &[handle, subItem] : mResolved) {
+                    if (handle == parent) {
+                        return subItem;
+                    }
+                }
+                auto res = getSubItem(mRootItem, parent);
+                mResolved.emplace_back(parent, res);
+                return res;
+            }
+
+        private:
+            StorageItemRoot &mRootItem;
+            std::vector<std::pair<wups_storage_item, StorageSubItem *>> mResolved;
+        };
+
+        /**
+         * Sets the status of every entry to error and returns it.
+         */
+        static WUPSStorageError FailBatch(wups_storage_batch_entry_t *entries, uint32_t count, WUPSStorageError error) {
+            for (uint32_t i = 0; i < count; i++) {
+                entries[i].status = error;
+            }
+            return error;
         }
     } // namespace Helper
 
+    namespace Prefetch {
+        constexpr uint32_t PREFETCH_THREAD_STACK_SIZE = 0x10000;
+
+        struct PrefetchEntry {
+            std::string pluginId;
+            bool started = false;
+            bool done    = false;
+            // nullptr if loading failed
+            std::shared_ptr<StorageItemRoot> root;
+            // State of the files before they have been read
+            StorageCache::FileInfo fileInfo;
+        };
+
+        std::list<PrefetchEntry> gPrefetchEntries;
+        std::mutex gPrefetchMutex;
+        std::condition_variable gPrefetchCondition;
+        OSThread *gPrefetchThread   = nullptr;
+        void *gPrefetchThreadStack  = nullptr;
+        bool gPrefetchThreadRunning = false;
+
+        static void LoadEntry(PrefetchEntry &entry) {
+            entry.fileInfo = StorageCache::GetFileInfo(entry.pluginId);
+            auto root      = make_shared_nothrow<StorageItemRoot>(entry.pluginId);
+            if (!root) {
+                return;
+            }
+            auto err = Helper::LoadFromFile(entry.pluginId, *root);
+            if (err == WUPS_STORAGE_ERROR_SUCCESS || err == WUPS_STORAGE_ERROR_NOT_FOUND) {
+                entry.root = std::move(root);
+            }
+        }
+
+        static int PrefetchThreadEntry(int, const char **) {
+            std::unique_lock lock(gPrefetchMutex);
+            while (true) {
+                auto it = std::find_if(gPrefetchEntries.begin(), gPrefetchEntries.end(), [](const auto &cur) { return !cur.started; });
+                if (it == gPrefetchEntries.end()) {
+                    gPrefetchThreadRunning = false;
+                    return 0;
+                }
+                it->started = true;
+
+                // Entries are only removed once they are done, so "it" stays valid while loading without holding the lock.
+                lock.unlock();
+                LoadEntry(*it);
+                lock.lock();
+
+                it->done = true;
+                gPrefetchCondition.notify_all();
+            }
+        }
+
+        /**
+         * Must not be called while holding gPrefetchMutex, unless the thread has already finished.
+         */
+        static void JoinThread() {
+            if (gPrefetchThread) {
+                OSJoinThread(gPrefetchThread, nullptr);
+                free(gPrefetchThread);
+                free(gPrefetchThreadStack);
+                gPrefetchThread      = nullptr;
+                gPrefetchThreadStack = nullptr;
+            }
+        }
+
+        /**
+         * The caller needs to hold gPrefetchMutex
+         */
+        static bool StartThread() {
+            // The previous thread has already finished, but still needs to be joined.
+            JoinThread();
+            gPrefetchThread      = (OSThread *) memalign(0x10, sizeof(OSThread));
+            gPrefetchThreadStack = memalign(0x20, PREFETCH_THREAD_STACK_SIZE);
+            if (!gPrefetchThread || !gPrefetchThreadStack ||
+                !OSCreateThread(gPrefetchThread, PrefetchThreadEntry, 0, nullptr, (uint8_t *) gPrefetchThreadStack + PREFETCH_THREAD_STACK_SIZE, PREFETCH_THREAD_STACK_SIZE, 16, OS_THREAD_ATTRIB_AFFINITY_CPU2)) {
+                free(gPrefetchThread);
+                free(gPrefetchThreadStack);
+                gPrefetchThread      = nullptr;
+                gPrefetchThreadStack = nullptr;
+                return false;
+            }
+            OSSetThreadName(gPrefetchThread, "WUPS Storage Prefetch Thread");
+            gPrefetchThreadRunning = true;
+            OSResumeThread(gPrefetchThread);
+            return true;
+        }
+
+        /**
+         * Waits for the prefetched root of the given storage.
+         * @return nullptr if the storage hasn't been prefetched, loading failed or the files have changed since then.
+         */
+        static std::shared_ptr<StorageItemRoot> TakeRoot(std::string_view plugin_id) {
+            PrefetchEntry entry;
+            {
+                std::unique_lock lock(gPrefetchMutex);
+                auto it = std::find_if(gPrefetchEntries.begin(), gPrefetchEntries.end(), [&plugin_id](const auto &cur) { return cur.pluginId == plugin_id; });
+                if (it == gPrefetchEntries.end()) {
+                    return nullptr;
+                }
+                gPrefetchCondition.wait(lock, [&it] { return it->done; });
+                entry = std::move(*it);
+                gPrefetchEntries.erase(it);
+            }
+            if (!entry.root) {
+                DEBUG_FUNCTION_LINE_VERBOSE("Prefetching storage \"%s\" failed", entry.pluginId.c_str());
+                return nullptr;
+            }
+            if (StorageCache::GetFileInfo(plugin_id) != entry.fileInfo) {
+                DEBUG_FUNCTION_LINE_VERBOSE("Storage \"%s\" has been changed since it has been prefetched", entry.pluginId.c_str());
+                return nullptr;
+            }
+            return entry.root;
+        }
+    } // namespace Prefetch
+
     namespace API {
         namespace Internal {
             WUPSStorageError OpenStorage(std::string_view plugin_id, wups_storage_root_item &outItem) {
-                std::lock_guard lock(gStorageMutex);
-                gStorage.emplace_front(plugin_id);
-                auto &root = gStorage.front();
-
-                WUPSStorageError err = Helper::LoadFromFile(plugin_id, root);
-                if (err == WUPS_STORAGE_ERROR_NOT_FOUND) {
-                    // Create new clean StorageItemRoot if no existing storage was found
-                    root = StorageItemRoot(plugin_id);
-                } else if (err != WUPS_STORAGE_ERROR_SUCCESS) {
-                    // Return on any other error
-                    gStorage.pop_front();
-                    return err;
+                StorageStats::ScopedTimer timer(StorageStats::OPERATION_OPEN);
+                auto root = StorageCache::Take(plugin_id);
+                if (root) {
+                    DEBUG_FUNCTION_LINE_VERBOSE("Reuse cached storage \"%.*s\"", (int) plugin_id.size(), plugin_id.data());
+                } else if ((root = Prefetch::TakeRoot(plugin_id))) {
+                    DEBUG_FUNCTION_LINE_VERBOSE("Use prefetched storage \"%.*s\"", (int) plugin_id.size(), plugin_id.data());
+                } else {
+                    root = make_shared_nothrow<StorageItemRoot>(plugin_id);
+                    if (!root) {
+                        return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+                    }
+
+                    // The root isn't visible to other threads yet, so we can load it without holding the global lock.
+                    WUPSStorageError err = Helper::LoadFromFile(plugin_id, *root);
+                    if (err == WUPS_STORAGE_ERROR_NOT_FOUND) {
+                        // Use the new clean StorageItemRoot if no existing storage was found
+                    } else if (err != WUPS_STORAGE_ERROR_SUCCESS) {
+                        // Return on any other error
+                        return err;
+                    }
                 }
 
-                outItem = (wups_storage_root_item) root.getHandle();
+                outItem = (wups_storage_root_item) root->getHandle();
+
+                std::unique_lock lock(gStorageMutex);
+                gStorage.push_front(std::move(root));
 
                 return WUPS_STORAGE_ERROR_SUCCESS;
             }
 
             WUPSStorageError CloseStorage(wups_storage_root_item root) {
-                std::lock_guard lock(gStorageMutex);
+                StorageStats::ScopedTimer timer(StorageStats::OPERATION_CLOSE);
+                std::shared_ptr<StorageItemRoot> rootItem;
+                bool lastStorage = false;
+                {
+                    std::unique_lock lock(gStorageMutex);
+                    for (auto prev = gStorage.before_begin(), it = gStorage.begin(); it != gStorage.end(); prev = it, ++it) {
+                        if ((*it)->getHandle() == (uintptr_t) root) {
+                            rootItem = std::move(*it);
+                            gStorage.erase_after(prev);
+                            break;
+                        }
+                    }
+                    lastStorage = gStorage.empty();
+                }
+                if (!rootItem) {
+                    DEBUG_FUNCTION_LINE_WARN("Failed to close storage: Not opened (\"%08X\")", root);
+                    return WUPS_STORAGE_ERROR_NOT_FOUND;
+                }
 
-                auto res = StorageUtils::Helper::WriteStorageToSD(root, false);
                 // TODO: handle write error?
+                // Always compact the journal when closing.
+                auto res = StorageUtils::Helper::WriteStorageToSD(*rootItem, false, false);
+                if (res == WUPS_STORAGE_ERROR_SUCCESS) {
+                    // The root matches the file now, keep it around in case the storage gets opened again.
+                    StorageCache::Add(std::move(rootItem));
+                }
+                if (lastStorage) {
+                    StorageStats::PrintAndReset();
+                }
+                return res;
+            }
 
-                if (!remove_first_if(gStorage, [&root](auto &cur) { return cur.getHandle() == (uint32_t) root; })) {
-                    DEBUG_FUNCTION_LINE_WARN("Failed to close storage: Not opened (\"%08X\")", root);
+            void PrefetchStorage(std::string_view plugin_id) {
+                if (plugin_id.empty() || StorageCache::Contains(plugin_id)) {
+                    return;
+                }
+                std::lock_guard lock(Prefetch::gPrefetchMutex);
+                for (const auto &cur : Prefetch::gPrefetchEntries) {
+                    if (cur.pluginId == plugin_id) {
+                        return;
+                    }
+                }
+                auto &entry    = Prefetch::gPrefetchEntries.emplace_back();
+                entry.pluginId = plugin_id;
+                if (!Prefetch::gPrefetchThreadRunning && !Prefetch::StartThread()) {
+                    // OpenStorage will just load the storage itself.
+                    DEBUG_FUNCTION_LINE_WARN("Failed to start storage prefetch thread");
+                    Prefetch::gPrefetchEntries.clear();
+                }
+            }
+
+            WUPSStorageError GetMemoryUsage(wups_storage_root_item root, uint32_t &outUsage) {
+                auto rootItem = Helper::getRootItem(root);
+                if (!rootItem) {
                     return WUPS_STORAGE_ERROR_NOT_FOUND;
                 }
-                return res;
+                std::shared_lock lock(rootItem->getMutex());
+                outUsage = rootItem->getMemoryUsage();
+                return WUPS_STORAGE_ERROR_SUCCESS;
+            }
+
+            void SetQuotas(uint32_t softQuota, uint32_t hardQuota) {
+                gStorageSoftQuota = softQuota;
+                gStorageHardQuota = hardQuota;
+            }
+
+            void FinishPrefetch() {
+                // The thread only exits once all entries have been loaded. PrefetchStorage and FinishPrefetch are only called
+                // from the same thread, so no new thread can be started while waiting.
+                Prefetch::JoinThread();
+                std::lock_guard lock(Prefetch::gPrefetchMutex);
+                Prefetch::gPrefetchEntries.clear();
             }
         } // namespace Internal
 
         WUPSStorageError SaveStorage(wups_storage_root_item root, bool force) {
-            std::lock_guard lock(gStorageMutex);
-            return StorageUtils::Helper::WriteStorageToSD(root, force);
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_SAVE);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED;
+            }
+            return StorageUtils::Helper::WriteStorageToSD(*rootItem, force, true);
         }
 
         WUPSStorageError ForceReloadStorage(wups_storage_root_item root) {
-            std::lock_guard lock(gStorageMutex);
-
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_RELOAD);
             auto rootItem = Helper::getRootItem(root);
             if (!rootItem) {
                 return WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED;
             }
 
-            WUPSStorageError result;
-            if ((result = Helper::LoadFromFile(rootItem->getPluginId(), *rootItem)) != WUPS_STORAGE_ERROR_SUCCESS) {
-                return result;
-            }
-            return result;
+            return Helper::LoadFromFile(rootItem->getPluginId(), *rootItem);
         }
 
         WUPSStorageError WipeStorage(wups_storage_root_item root) {
-            std::lock_guard lock(gStorageMutex);
-
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_WIPE);
             auto rootItem = Helper::getRootItem(root);
             if (!rootItem) {
                 return WUPS_STORAGE_ERROR_NOT_FOUND;
             }
 
+            std::unique_lock lock(rootItem->getMutex());
             rootItem->wipe();
+            rootItem->getJournal().requestSnapshot();
 
             return WUPS_STORAGE_ERROR_SUCCESS;
         }
 
         WUPSStorageError CreateSubItem(wups_storage_root_item root, wups_storage_item parent, const char *key, wups_storage_item *outItem) {
-            if (!outItem) {
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_SUB_ITEM);
+            if (!outItem || !key) {
                 return WUPS_STORAGE_ERROR_INVALID_ARGS;
             }
-            std::lock_guard lock(gStorageMutex);
-            auto subItem = StorageUtils::Helper::getSubItem(root, parent);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            std::unique_lock lock(rootItem->getMutex());
+            auto subItem = StorageUtils::Helper::getSubItem(*rootItem, parent);
             if (subItem) {
+                // An existing key is reported as such even if the quota is used up.
+                if (subItem->getSubItem(std::string_view(key)) || subItem->getItem(key)) {
+                    return WUPS_STORAGE_ERROR_ALREADY_EXISTS;
+                }
+                uint32_t usage = StorageSubItem::GetMemoryUsage(strlen(key));
+                if (auto err = Helper::CheckQuota(*rootItem, 0, usage); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                    return err;
+                }
                 StorageSubItem::StorageSubItemError error = StorageSubItem::STORAGE_SUB_ITEM_ERROR_NONE;
                 auto res                                  = subItem->createSubItem(key, error);
                 if (!res) {
                     return StorageUtils::Helper::ConvertToWUPSError(error);
                 }
+                rootItem->updateMemoryUsage(0, usage);
+                rootItem->getJournal().addRecord(nlohmann::json::array({"c", Helper::getJournalPath(*subItem), std::string(res->getKey())}));
                 *outItem = (wups_storage_item) res->getHandle();
                 return WUPS_STORAGE_ERROR_SUCCESS;
             }
@@ -485,11 +1193,16 @@ namespace StorageUtils {
         }
 
         WUPSStorageError GetSubItem(wups_storage_root_item root, wups_storage_item parent, const char *key, wups_storage_item *outItem) {
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_SUB_ITEM);
             if (!outItem) {
                 return WUPS_STORAGE_ERROR_INVALID_ARGS;
             }
-            std::lock_guard lock(gStorageMutex);
-            auto subItem = StorageUtils::Helper::getSubItem(root, parent);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            std::shared_lock lock(rootItem->getMutex());
+            auto subItem = StorageUtils::Helper::getSubItem(*rootItem, parent);
             if (subItem) {
                 auto res = subItem->getSubItem(key);
                 if (!res) {
@@ -502,27 +1215,53 @@ namespace StorageUtils {
         }
 
         WUPSStorageError DeleteItem(wups_storage_root_item root, wups_storage_item parent, const char *key) {
-            std::lock_guard lock(gStorageMutex);
-            auto subItem = StorageUtils::Helper::getSubItem(root, parent);
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_DELETE);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            std::unique_lock lock(rootItem->getMutex());
+            auto subItem = StorageUtils::Helper::getSubItem(*rootItem, parent);
             if (subItem) {
+                uint32_t usage = 0;
+                if (auto item = subItem->getItem(key)) {
+                    usage = item->getMemoryUsage();
+                } else if (auto childItem = subItem->getSubItem(std::string_view(key))) {
+                    usage = childItem->getTreeMemoryUsage();
+                }
+                Helper::removeStoreRecords(*rootItem, *subItem, key);
                 auto res = subItem->deleteItem(key);
                 if (!res) {
                     return WUPS_STORAGE_ERROR_NOT_FOUND;
                 }
+                rootItem->updateMemoryUsage(usage, 0);
+                rootItem->getJournal().addRecord(nlohmann::json::array({"d", Helper::getJournalPath(*subItem), key}));
                 return WUPS_STORAGE_ERROR_SUCCESS;
             }
             return WUPS_STORAGE_ERROR_NOT_FOUND;
         }
 
         WUPSStorageError GetItemSize(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, uint32_t *outSize) {
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_GET_SIZE);
             if (!outSize) {
                 return WUPS_STORAGE_ERROR_INVALID_ARGS;
             }
             if (itemType != WUPS_STORAGE_ITEM_STRING && itemType != WUPS_STORAGE_ITEM_BINARY) {
                 return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
             }
-            std::lock_guard lock(gStorageMutex);
-            auto subItem = StorageUtils::Helper::getSubItem(root, parent);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            // Binary items might need to be converted first, which modifies the item.
+            std::shared_lock sharedLock(rootItem->getMutex(), std::defer_lock);
+            std::unique_lock uniqueLock(rootItem->getMutex(), std::defer_lock);
+            if (itemType == WUPS_STORAGE_ITEM_BINARY) {
+                uniqueLock.lock();
+            } else {
+                sharedLock.lock();
+            }
+            auto subItem = StorageUtils::Helper::getSubItem(*rootItem, parent);
             if (!subItem) {
                 return WUPS_STORAGE_ERROR_NOT_FOUND;
             }
@@ -530,8 +1269,8 @@ namespace StorageUtils {
             if (item) {
                 if (itemType == WUPS_STORAGE_ITEM_BINARY) {
                     // Trigger potential string -> binary conversion.
-                    if (!item->attemptBinaryConversion()) {
-                        return WUPS_STORAGE_ERROR_MALLOC_FAILED;
+                    if (auto err = Helper::FixBinaryItem(*rootItem, *item); err != WUPS_STORAGE_ERROR_SUCCESS) {
+                        return err;
                     }
                 }
                 uint32_t tmp = 0;
@@ -552,139 +1291,104 @@ namespace StorageUtils {
         }
 
         WUPSStorageError StoreItem(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t length) {
-            std::lock_guard lock(gStorageMutex);
-            switch ((WUPSStorageItemTypes) itemType) {
-                case WUPS_STORAGE_ITEM_S32: {
-                    if (data == nullptr || length != sizeof(int32_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as S32: %d", key, *(int32_t *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<int32_t>(root, parent, key, *(int32_t *) data);
-                }
-                case WUPS_STORAGE_ITEM_S64: {
-                    if (data == nullptr || length != sizeof(int64_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as S64: %lld", key, *(int64_t *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<int64_t>(root, parent, key, *(int64_t *) data);
-                }
-                case WUPS_STORAGE_ITEM_U32: {
-                    if (data == nullptr || length != sizeof(uint32_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as u32: %u", key, *(uint32_t *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<uint32_t>(root, parent, key, *(uint32_t *) data);
-                }
-                case WUPS_STORAGE_ITEM_U64: {
-                    if (data == nullptr || length != sizeof(uint64_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as u64: %llu", key, *(uint64_t *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<uint64_t>(root, parent, key, *(uint64_t *) data);
-                }
-                case WUPS_STORAGE_ITEM_STRING: {
-                    if (data == nullptr) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    std::string tmp = length > 0 ? std::string((const char *) data, length) : std::string();
-
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as string: %s", key, tmp.c_str());
-                    return StorageUtils::Helper::StoreItemGeneric<std::string>(root, parent, key, tmp);
-                }
-                case WUPS_STORAGE_ITEM_BINARY: {
-                    if (data == nullptr && length > 0) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    std::vector<uint8_t> tmp = (data != nullptr && length > 0) ? std::vector<uint8_t>((uint8_t *) data, ((uint8_t *) data) + length) : std::vector<uint8_t>();
-
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as binary: size %d", key, tmp.size());
-                    return StorageUtils::Helper::StoreItemGeneric<std::vector<uint8_t>>(root, parent, key, tmp);
-                }
-                case WUPS_STORAGE_ITEM_BOOL: {
-                    if (data == nullptr || length != sizeof(bool)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as bool: %d", key, *(bool *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<bool>(root, parent, key, *(bool *) data);
-                }
-                case WUPS_STORAGE_ITEM_FLOAT: {
-                    if (data == nullptr || length != sizeof(float)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as float: %f", key, *(float *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<float>(root, parent, key, *(float *) data);
-                }
-                case WUPS_STORAGE_ITEM_DOUBLE: {
-                    if (data == nullptr || length != sizeof(double)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    DEBUG_FUNCTION_LINE_VERBOSE("Store %s as double: %f", key, *(double *) data);
-                    return StorageUtils::Helper::StoreItemGeneric<double>(root, parent, key, *(double *) data);
-                }
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_STORE);
+            if (!key) {
+                return WUPS_STORAGE_ERROR_INVALID_ARGS;
             }
-            DEBUG_FUNCTION_LINE_ERR("Store failed!");
-            return WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE;
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            std::unique_lock lock(rootItem->getMutex());
+            return Helper::StoreItemLocked(*rootItem, Helper::getSubItem(*rootItem, parent), key, itemType, data, length);
         }
 
         WUPSStorageError GetItem(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t maxSize, uint32_t *outSize) {
-            std::lock_guard lock(gStorageMutex);
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_GET);
             if (outSize) {
                 *outSize = 0;
             }
-            switch ((WUPSStorageItemTypes) itemType) {
-                case WUPS_STORAGE_ITEM_STRING: {
-                    if (!data || maxSize == 0) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetStringItem(root, parent, key, data, maxSize, outSize);
-                }
-                case WUPS_STORAGE_ITEM_BINARY: {
-                    return StorageUtils::Helper::GetBinaryItem(root, parent, key, data, maxSize, outSize);
-                }
-                case WUPS_STORAGE_ITEM_BOOL: {
-                    if (!data || maxSize != sizeof(bool)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<bool>(root, parent, key, (bool *) data, outSize);
-                }
-                case WUPS_STORAGE_ITEM_S32: {
-                    if (!data || maxSize != sizeof(int32_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<int32_t>(root, parent, key, (int32_t *) data, outSize);
-                }
-                case WUPS_STORAGE_ITEM_S64: {
-                    if (!data || maxSize != sizeof(int64_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<int64_t>(root, parent, key, (int64_t *) data, outSize);
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return WUPS_STORAGE_ERROR_NOT_FOUND;
+            }
+            // Binary items might need to be converted first, which modifies the item.
+            std::shared_lock sharedLock(rootItem->getMutex(), std::defer_lock);
+            std::unique_lock uniqueLock(rootItem->getMutex(), std::defer_lock);
+            if (itemType == WUPS_STORAGE_ITEM_BINARY) {
+                uniqueLock.lock();
+            } else {
+                sharedLock.lock();
+            }
+            return Helper::GetItemLocked(*rootItem, Helper::getSubItem(*rootItem, parent), key, itemType, data, maxSize, outSize);
+        }
+
+        WUPSStorageError StoreItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count) {
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_STORE_BATCH);
+            if (entries == nullptr && count > 0) {
+                return WUPS_STORAGE_ERROR_INVALID_ARGS;
+            }
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return Helper::FailBatch(entries, count, WUPS_STORAGE_ERROR_NOT_FOUND);
+            }
+            WUPSStorageError res = WUPS_STORAGE_ERROR_SUCCESS;
+            std::unique_lock lock(rootItem->getMutex());
+            Helper::BatchParentCache parents(*rootItem);
+            for (uint32_t i = 0; i < count; i++) {
+                auto &entry   = entries[i];
+                entry.outSize = 0;
+                if (entry.key == nullptr) {
+                    entry.status = WUPS_STORAGE_ERROR_INVALID_ARGS;
+                } else {
+                    entry.status = Helper::StoreItemLocked(*rootItem, parents.get(entry.parent), entry.key, entry.type, entry.data, entry.size);
                 }
-                case WUPS_STORAGE_ITEM_U32: {
-                    if (!data || maxSize != sizeof(uint32_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<uint32_t>(root, parent, key, (uint32_t *) data, outSize);
+                if (entry.status != WUPS_STORAGE_ERROR_SUCCESS && res == WUPS_STORAGE_ERROR_SUCCESS) {
+                    res = entry.status;
                 }
-                case WUPS_STORAGE_ITEM_U64: {
-                    if (!data || maxSize != sizeof(uint64_t)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<uint64_t>(root, parent, key, (uint64_t *) data, outSize);
+            }
+            return res;
+        }
+
+        WUPSStorageError GetItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count) {
+            StorageStats::ScopedTimer timer(StorageStats::OPERATION_GET_BATCH);
+            if (entries == nullptr && count > 0) {
+                return WUPS_STORAGE_ERROR_INVALID_ARGS;
+            }
+            auto rootItem = Helper::getRootItem(root);
+            if (!rootItem) {
+                return Helper::FailBatch(entries, count, WUPS_STORAGE_ERROR_NOT_FOUND);
+            }
+            // Only take the unique lock if a binary item might need to be converted.
+            bool needsUniqueLock = false;
+            for (uint32_t i = 0; i < count; i++) {
+                if (entries[i].type == WUPS_STORAGE_ITEM_BINARY) {
+                    needsUniqueLock = true;
+                    break;
                 }
-                case WUPS_STORAGE_ITEM_FLOAT: {
-                    if (!data || maxSize != sizeof(float)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<float>(root, parent, key, (float *) data, outSize);
+            }
+            std::shared_lock sharedLock(rootItem->getMutex(), std::defer_lock);
+            std::unique_lock uniqueLock(rootItem->getMutex(), std::defer_lock);
+            if (needsUniqueLock) {
+                uniqueLock.lock();
+            } else {
+                sharedLock.lock();
+            }
+            WUPSStorageError res = WUPS_STORAGE_ERROR_SUCCESS;
+            Helper::BatchParentCache parents(*rootItem);
+            for (uint32_t i = 0; i < count; i++) {
+                auto &entry = entries[i];
+                if (entry.key == nullptr) {
+                    entry.outSize = 0;
+                    entry.status  = WUPS_STORAGE_ERROR_INVALID_ARGS;
+                } else {
+                    entry.status = Helper::GetItemLocked(*rootItem, parents.get(entry.parent), entry.key, entry.type, entry.data, entry.size, &entry.outSize);
                 }
-                case WUPS_STORAGE_ITEM_DOUBLE: {
-                    if (!data || maxSize != sizeof(double)) {
-                        return WUPS_STORAGE_ERROR_INVALID_ARGS;
-                    }
-                    return StorageUtils::Helper::GetItemGeneric<double>(root, parent, key, (double *) data, outSize);
+                if (entry.status != WUPS_STORAGE_ERROR_SUCCESS && res == WUPS_STORAGE_ERROR_SUCCESS) {
+                    res = entry.status;
                 }
             }
-            return WUPS_STORAGE_ERROR_NOT_FOUND;
+            return res;
         }
     } // namespace API
 } // namespace StorageUtils
\ No newline at end of file
@@ -1,11 +1,63 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
 #include <wups/storage.h>
 
+/**
+ * Returned by StoreItem and CreateSubItem if the change would exceed the hard quota of the storage.
+ * Not (yet) part of the WUPS headers.
+ */
+constexpr auto WUPS_STORAGE_ERROR_QUOTA_EXCEEDED = (WUPSStorageError) -0x07;
+
+/**
+ * A single get or store of a batch, see StorageUtils::API::GetItems and StorageUtils::API::StoreItems.
+ * Not (yet) part of the WUPS headers.
+ */
+typedef struct wups_storage_batch_entry_t {
+    wups_storage_item parent;
+    const char *key;
+    WUPSStorageItemType type;
+    // Value to store or buffer to read into
+    void *data;
+    // Length of the value to store or size of the buffer
+    uint32_t size;
+    // Set by GetItems to the size of the read value
+    uint32_t outSize;
+    // Set for every entry
+    WUPSStorageError status;
+} wups_storage_batch_entry_t;
+
+namespace StorageUtils {
+    constexpr uint32_t DEFAULT_STORAGE_SOFT_QUOTA = 512 * 1024;
+    constexpr uint32_t DEFAULT_STORAGE_HARD_QUOTA = 2 * 1024 * 1024;
+} // namespace StorageUtils
+
 namespace StorageUtils::API {
     namespace Internal {
         WUPSStorageError OpenStorage(std::string_view plugin_id, wups_storage_root_item &outItem);
         WUPSStorageError CloseStorage(wups_storage_root_item item);
+
+        /**
+         * Starts loading the storage in the background. OpenStorage uses the prefetched storage if its files haven't been changed in the meantime.
+         */
+        void PrefetchStorage(std::string_view plugin_id);
+
+        /**
+         * Waits for the prefetch thread and drops all prefetched storages which haven't been opened.
+         */
+        void FinishPrefetch();
+
+        /**
+         * Returns the memory used by the item tree of the given storage in bytes.
+         */
+        WUPSStorageError GetMemoryUsage(wups_storage_root_item root, uint32_t &outUsage);
+
+        /**
+         * Exceeding the soft quota only logs a warning, StoreItem and CreateSubItem fail if the hard quota would be exceeded.
+         * A quota of 0 disables it.
+         */
+        void SetQuotas(uint32_t softQuota, uint32_t hardQuota);
     } // namespace Internal
 
     WUPSStorageError SaveStorage(wups_storage_root_item root, bool force);
@@ -18,4 +70,12 @@ namespace StorageUtils::API {
     WUPSStorageError StoreItem(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t length);
     WUPSStorageError GetItem(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t maxSize, uint32_t *outSize);
     WUPSStorageError GetItemSize(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, uint32_t *outSize);
+
+    /**
+     * Processes all entries while holding the lock of the root once, each distinct parent only gets resolved once.
+     * Entries are processed in order, a failing entry doesn't stop the batch.
+     * @return WUPS_STORAGE_ERROR_SUCCESS if all entries succeeded, otherwise the status of the first failed entry.
+     */
+    WUPSStorageError StoreItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count);
+    WUPSStorageError GetItems(wups_storage_root_item root, wups_storage_batch_entry_t *entries, uint32_t count);
 } // namespace StorageUtils::API
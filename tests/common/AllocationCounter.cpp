@@ -0,0 +1,63 @@
+#include "TestUtils.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete to count allocations for the benchmarks.
+// Allocations done via malloc/memalign directly (e.g. the compression buffers) are not counted.
+
+namespace {
+    std::atomic<uint64_t> sAllocationCount;
+    std::atomic<uint64_t> sAllocatedBytes;
+
+    void *CountedAlloc(size_t size) {
+        sAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        sAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return malloc(size ? size : 1);
+    }
+} // namespace
+
+uint64_t TestUtils::GetAllocationCount() {
+    return sAllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t TestUtils::GetAllocatedBytes() {
+    return sAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size) {
+    void *ptr = CountedAlloc(size);
+    if (!ptr) {
+        abort();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return CountedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return CountedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
@@ -0,0 +1,231 @@
+#include "NotificationsUtils.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <coreinit/debug.h>
+#include <coreinit/memory.h>
+#include <coreinit/thread.h>
+#include <coreinit/time.h>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <function_patcher/function_patching.h>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <whb/log.h>
+#include <wups/config.h>
+#include <wups/storage.h>
+
+uint32_t TestUtils::gFailedChecks = 0;
+
+namespace {
+    std::string sPluginPath;
+
+    bool sLoggingEnabled = getenv("TEST_VERBOSE") != nullptr;
+} // namespace
+
+std::string getPluginPath() {
+    return sPluginPath;
+}
+
+std::string TestUtils::CreateTempPluginPath() {
+    char path[] = "/tmp/wups-test-XXXXXX";
+    if (!mkdtemp(path)) {
+        perror("mkdtemp");
+        exit(1);
+    }
+    sPluginPath = path;
+    std::filesystem::create_directories(sPluginPath + "/config");
+    return sPluginPath;
+}
+
+void TestUtils::RemoveTempPluginPath() {
+    if (!sPluginPath.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(sPluginPath, ec);
+        sPluginPath.clear();
+    }
+}
+
+extern "C" int WHBLogPrintf(const char *fmt, ...) {
+    if (sLoggingEnabled) {
+        va_list va;
+        va_start(va, fmt);
+        vfprintf(stderr, fmt, va);
+        va_end(va);
+        fputc('\n', stderr);
+    }
+    return 0;
+}
+
+extern "C" int WHBLogWritef(const char *fmt, ...) {
+    if (sLoggingEnabled) {
+        va_list va;
+        va_start(va, fmt);
+        vfprintf(stderr, fmt, va);
+        va_end(va);
+    }
+    return 0;
+}
+
+extern "C" void OSReport(const char *fmt, ...) {
+    if (sLoggingEnabled) {
+        va_list va;
+        va_start(va, fmt);
+        vfprintf(stderr, fmt, va);
+        va_end(va);
+    }
+}
+
+extern "C" void OSFatal(const char *msg) {
+    fprintf(stderr, "OSFatal: %s\n", msg);
+    abort();
+}
+
+extern "C" OSTime OSGetTime() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (OSTime) ((__int128) ns * OSTimerClockSpeed / 1000000000);
+}
+
+extern "C" OSTime OSGetSystemTime() {
+    return OSGetTime();
+}
+
+extern "C" void OSSleepTicks(OSTime ticks) {
+    std::this_thread::sleep_for(std::chrono::microseconds(OSTicksToMicroseconds(ticks)));
+}
+
+extern "C" BOOL OSCreateThread(OSThread *thread, OSThreadEntryPointFn entry, int32_t argc, char *argv, void *, uint32_t, int32_t, int) {
+    // The thread is started suspended, OSResumeThread starts it.
+    auto *start       = new std::function<void()>([entry, argc, argv]() { entry(argc, (const char **) argv); });
+    thread->hostThread = start;
+    thread->started    = false;
+    return true;
+}
+
+extern "C" int32_t OSResumeThread(OSThread *thread) {
+    if (thread->started) {
+        return 0;
+    }
+    auto *start        = (std::function<void()> *) thread->hostThread;
+    thread->hostThread = new std::thread(std::move(*start));
+    thread->started    = true;
+    delete start;
+    return 1;
+}
+
+extern "C" BOOL OSJoinThread(OSThread *thread, int *threadResult) {
+    if (!thread->started) {
+        return false;
+    }
+    auto *hostThread = (std::thread *) thread->hostThread;
+    hostThread->join();
+    delete hostThread;
+    thread->hostThread = nullptr;
+    thread->started    = false;
+    if (threadResult) {
+        *threadResult = 0;
+    }
+    return true;
+}
+
+extern "C" void OSSetThreadName(OSThread *, const char *) {
+}
+
+/**
+ * The system font of the console isn't available, the font is loaded from the path in WUPS_TEST_FONT instead.
+ */
+extern "C" BOOL OSGetSharedData(OSSharedDataType type, uint32_t, void **outPtr, uint32_t *outSize) {
+    static std::vector<char> sFont;
+    const char *path = getenv("WUPS_TEST_FONT");
+    if (type != OS_SHAREDDATATYPE_FONT_STANDARD || path == nullptr) {
+        return false;
+    }
+    if (sFont.empty()) {
+        std::ifstream file(path, std::ios::binary);
+        sFont.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (sFont.empty()) {
+            fprintf(stderr, "Failed to load the font %s\n", path);
+            return false;
+        }
+    }
+    *outPtr  = sFont.data();
+    *outSize = sFont.size();
+    return true;
+}
+
+extern "C" void OSMemoryBarrier() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+extern "C" FunctionPatcherStatus FunctionPatcher_AddFunctionPatch(function_replacement_data_t *, PatchedFunctionHandle *, bool *) {
+    return FUNCTION_PATCHER_RESULT_UNKNOWN_ERROR;
+}
+
+extern "C" FunctionPatcherStatus FunctionPatcher_RemoveFunctionPatch(PatchedFunctionHandle) {
+    return FUNCTION_PATCHER_RESULT_UNKNOWN_ERROR;
+}
+
+// The notification module isn't available, the message is only logged.
+bool DisplayInfoNotificationMessage(std::string_view text, float) {
+    printf("Notification: %.*s\n", (int) text.size(), text.data());
+    return true;
+}
+
+bool DisplayErrorNotificationMessage(std::string_view text, float) {
+    printf("Error notification: %.*s\n", (int) text.size(), text.data());
+    return true;
+}
+
+extern "C" const char *WUPSConfigAPI_GetStatusStr(WUPSConfigAPIStatus status) {
+    switch (status) {
+        case WUPSCONFIG_API_RESULT_SUCCESS:
+            return "WUPSCONFIG_API_RESULT_SUCCESS";
+        case WUPSCONFIG_API_RESULT_INVALID_ARGUMENT:
+            return "WUPSCONFIG_API_RESULT_INVALID_ARGUMENT";
+        case WUPSCONFIG_API_RESULT_OUT_OF_MEMORY:
+            return "WUPSCONFIG_API_RESULT_OUT_OF_MEMORY";
+        case WUPSCONFIG_API_RESULT_NOT_FOUND:
+            return "WUPSCONFIG_API_RESULT_NOT_FOUND";
+        case WUPSCONFIG_API_RESULT_MISSING_CALLBACK:
+            return "WUPSCONFIG_API_RESULT_MISSING_CALLBACK";
+        case WUPSCONFIG_API_RESULT_UNSUPPORTED_VERSION:
+            return "WUPSCONFIG_API_RESULT_UNSUPPORTED_VERSION";
+        default:
+            break;
+    }
+    return "WUPSCONFIG_API_RESULT_UNKNOWN_ERROR";
+}
+
+extern "C" const char *WUPSStorageAPI_GetStatusStr(WUPSStorageError status) {
+    switch (status) {
+        case WUPS_STORAGE_ERROR_SUCCESS:
+            return "WUPS_STORAGE_ERROR_SUCCESS";
+        case WUPS_STORAGE_ERROR_INVALID_ARGS:
+            return "WUPS_STORAGE_ERROR_INVALID_ARGS";
+        case WUPS_STORAGE_ERROR_MALLOC_FAILED:
+            return "WUPS_STORAGE_ERROR_MALLOC_FAILED";
+        case WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE:
+            return "WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE";
+        case WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL:
+            return "WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL";
+        case WUPS_STORAGE_ERROR_ALREADY_EXISTS:
+            return "WUPS_STORAGE_ERROR_ALREADY_EXISTS";
+        case WUPS_STORAGE_ERROR_IO_ERROR:
+            return "WUPS_STORAGE_ERROR_IO_ERROR";
+        case WUPS_STORAGE_ERROR_NOT_FOUND:
+            return "WUPS_STORAGE_ERROR_NOT_FOUND";
+        case WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED:
+            return "WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED";
+        case WUPS_STORAGE_ERROR_INTERNAL_INVALID_VERSION:
+            return "WUPS_STORAGE_ERROR_INTERNAL_INVALID_VERSION";
+        case WUPS_STORAGE_ERROR_UNKNOWN_ERROR:
+            return "WUPS_STORAGE_ERROR_UNKNOWN_ERROR";
+    }
+    return "WUPS_STORAGE_ERROR_UNKNOWN";
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal helpers shared by the host tests and benchmarks.
+ * Tests use CHECK and return TestUtils::Finish() from main, failing checks don't abort the test.
+ */
+namespace TestUtils {
+    extern uint32_t gFailedChecks;
+
+    /**
+     * Creates a fresh temp dir (including the config sub dir) and returns it from getPluginPath().
+     */
+    std::string CreateTempPluginPath();
+
+    void RemoveTempPluginPath();
+
+    /**
+     * Number and size of the operator new calls since the start of the process.
+     */
+    uint64_t GetAllocationCount();
+    uint64_t GetAllocatedBytes();
+
+    inline int Finish(const char *testName) {
+        if (gFailedChecks > 0) {
+            printf("%s: %u check(s) FAILED\n", testName, gFailedChecks);
+            return 1;
+        }
+        printf("%s: OK\n", testName);
+        return 0;
+    }
+
+    class Stopwatch {
+    public:
+        Stopwatch() : mStart(std::chrono::steady_clock::now()) {
+        }
+
+        [[nodiscard]] uint64_t elapsedNs() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+    /**
+     * Collects single durations and prints their percentiles.
+     */
+    class LatencyStats {
+    public:
+        void add(uint64_t durationNs) {
+            mSamples.push_back(durationNs);
+        }
+
+        void print(const char *name) {
+            if (mSamples.empty()) {
+                printf("  %-28s no samples\n", name);
+                return;
+            }
+            std::sort(mSamples.begin(), mSamples.end());
+            uint64_t total = 0;
+            for (auto sample : mSamples) {
+                total += sample;
+            }
+            printf("  %-28s n: %7zu avg: %9.2f us p50: %9.2f us p90: %9.2f us p99: %9.2f us max: %9.2f us\n",
+                   name, mSamples.size(), (double) total / (double) mSamples.size() / 1000.0,
+                   getPercentile(50) / 1000.0, getPercentile(90) / 1000.0, getPercentile(99) / 1000.0, (double) mSamples.back() / 1000.0);
+        }
+
+        void merge(const LatencyStats &other) {
+            mSamples.insert(mSamples.end(), other.mSamples.begin(), other.mSamples.end());
+        }
+
+    private:
+        // Nearest rank, mSamples must be sorted
+        [[nodiscard]] double getPercentile(uint32_t percentile) const {
+            size_t rank = (mSamples.size() * percentile + 99) / 100;
+            return (double) mSamples[std::max<size_t>(rank, 1) - 1];
+        }
+
+        std::vector<uint64_t> mSamples;
+    };
+} // namespace TestUtils
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);         \
+            TestUtils::gFailedChecks++;                                             \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_STATUS(expr, expected)                                                                                  \
+    do {                                                                                                              \
+        auto _res = (expr);                                                                                           \
+        if (_res != (expected)) {                                                                                     \
+            printf("%s:%d: %s returned %s, expected %s\n", __FILE__, __LINE__, #expr, WUPSStorageAPI_GetStatusStr(_res), \
+                   WUPSStorageAPI_GetStatusStr(expected));                                                            \
+            TestUtils::gFailedChecks++;                                                                               \
+        }                                                                                                             \
+    } while (0)
@@ -0,0 +1,319 @@
+#include "ConfigMenuHarness.h"
+#include "config/WUPSConfigAPI.h"
+#include "globals.h"
+#include "hooks.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <utility>
+
+namespace WUPSConfigAPIBackend {
+    // Exported as WUPSConfigAPI_InitEx for the plugins, the backend doesn't declare it in a header.
+    WUPSConfigAPIStatus InitEx(uintptr_t pluginIdentifier, WUPSConfigAPIOptions options, WUPSConfigAPI_MenuOpenedCallback openedCallback, WUPSConfigAPI_MenuClosedCallback closedCallback);
+} // namespace WUPSConfigAPIBackend
+
+// The real factories parse the plugin files, the harness fills in the information of its fake plugins instead. Both
+// classes are friends of the information classes, the real ones are not part of the host build.
+class PluginMetaInformationFactory {
+public:
+    static PluginMetaInformation Create(const FakePlugin &plugin) {
+        PluginMetaInformation info;
+        info.setName(plugin.name);
+        info.setAuthor(plugin.author);
+        info.setVersion(plugin.version);
+        info.setStorageId(plugin.name);
+        info.setWUPSVersion(0, 8, 0);
+        return info;
+    }
+};
+
+class PluginInformationFactory {
+public:
+    static PluginInformation Create(void *initConfigHook) {
+        PluginInformation info;
+        info.addHookData(HookData(initConfigHook, WUPS_LOADER_HOOK_INIT_CONFIG));
+        return info;
+    }
+};
+
+/**
+ * Same as in ConfigUtils.cpp, which isn't part of the host build because it sets up the real screens and controllers.
+ */
+WUPS_CONFIG_SIMPLE_INPUT ConfigUtils::convertInputs(uint32_t buttons) {
+    const std::pair<uint32_t, WUPS_CONFIG_SIMPLE_INPUT> mapping[] = {
+            {Input::eButtons::BUTTON_A, WUPS_CONFIG_BUTTON_A},
+            {Input::eButtons::BUTTON_LEFT, WUPS_CONFIG_BUTTON_LEFT},
+            {Input::eButtons::BUTTON_RIGHT, WUPS_CONFIG_BUTTON_RIGHT},
+            {Input::eButtons::BUTTON_L, WUPS_CONFIG_BUTTON_L},
+            {Input::eButtons::BUTTON_R, WUPS_CONFIG_BUTTON_R},
+            {Input::eButtons::BUTTON_ZL, WUPS_CONFIG_BUTTON_ZL},
+            {Input::eButtons::BUTTON_ZR, WUPS_CONFIG_BUTTON_ZR},
+            {Input::eButtons::BUTTON_X, WUPS_CONFIG_BUTTON_X},
+            {Input::eButtons::BUTTON_Y, WUPS_CONFIG_BUTTON_Y},
+            {Input::eButtons::BUTTON_STICK_L, WUPS_CONFIG_BUTTON_STICK_L},
+            {Input::eButtons::BUTTON_STICK_R, WUPS_CONFIG_BUTTON_STICK_R},
+            {Input::eButtons::BUTTON_PLUS, WUPS_CONFIG_BUTTON_PLUS},
+            {Input::eButtons::BUTTON_MINUS, WUPS_CONFIG_BUTTON_MINUS},
+            {Input::eButtons::BUTTON_B, WUPS_CONFIG_BUTTON_B},
+            {Input::eButtons::BUTTON_UP, WUPS_CONFIG_BUTTON_UP},
+            {Input::eButtons::BUTTON_DOWN, WUPS_CONFIG_BUTTON_DOWN},
+    };
+    WUPSConfigButtons pressedButtons = WUPS_CONFIG_BUTTON_NONE;
+    for (const auto &[button, configButton] : mapping) {
+        if (buttons & button) {
+            pressedButtons |= configButton;
+        }
+    }
+    return (WUPS_CONFIG_SIMPLE_INPUT) pressedButtons;
+}
+
+namespace {
+    // The config callbacks of the plugins have no context, they use the harness that is currently running.
+    ConfigMenuHarness *sActiveHarness = nullptr;
+    // The harness DrawUtils currently renders for
+    const ConfigMenuHarness *sBackendOwner = nullptr;
+
+    constexpr uint32_t MAX_PLUGINS = 16;
+    // gLoadedPlugins must never grow, the ConfigDisplayItems and the handles point to the containers.
+    constexpr uint32_t MAX_LOADED_PLUGINS = 256;
+
+    namespace Item {
+        int32_t GetCurrentValueDisplay(void *context, char *out_buf, int32_t out_size) {
+            auto *item = (FakeItem *) context;
+            snprintf(out_buf, out_size, "%d", item->value);
+            return 0;
+        }
+
+        int32_t GetCurrentValueSelectedDisplay(void *context, char *out_buf, int32_t out_size) {
+            auto *item = (FakeItem *) context;
+            snprintf(out_buf, out_size, item->editing ? "[ %d ]" : "< %d >", item->value);
+            return 0;
+        }
+
+        void OnSelected(void *context, bool isSelected) {
+            auto *item     = (FakeItem *) context;
+            item->selected = isSelected;
+            item->selectedCallCount++;
+        }
+
+        void RestoreDefault(void *context) {
+            auto *item  = (FakeItem *) context;
+            item->value = item->defaultValue;
+        }
+
+        bool IsMovementAllowed(void *context) {
+            return !((FakeItem *) context)->editing;
+        }
+
+        void OnCloseCallback(void *context) {
+            ((FakeItem *) context)->closeCount++;
+        }
+
+        void OnInput(void *context, WUPSConfigSimplePadData input) {
+            auto *item = (FakeItem *) context;
+            if (item->editable) {
+                if (!item->editing && (input.buttons_d & WUPS_CONFIG_BUTTON_A)) {
+                    item->editing = true;
+                    return;
+                }
+                if (item->editing && (input.buttons_d & WUPS_CONFIG_BUTTON_B)) {
+                    item->editing = false;
+                    return;
+                }
+                if (!item->editing) {
+                    return;
+                }
+            }
+            if (input.buttons_d & WUPS_CONFIG_BUTTON_LEFT) {
+                item->value = std::max(item->min, item->value - 1);
+            } else if (input.buttons_d & WUPS_CONFIG_BUTTON_RIGHT) {
+                item->value = std::min(item->max, item->value + 1);
+            }
+        }
+
+        void OnInputEx(void *context, WUPSConfigComplexPadData) {
+            ((FakeItem *) context)->inputExCount++;
+        }
+
+        void OnDelete(void *) {
+            // The items are owned by the harness
+        }
+    } // namespace Item
+
+    WUPSConfigAPIStatus AddCategoryContent(WUPSConfigCategoryHandle parent, FakeCategory &category) {
+        using namespace WUPSConfigAPIBackend;
+        for (auto &subCategory : category.categories) {
+            WUPSConfigAPICreateCategoryOptions options = {.version = WUPS_API_CATEGORY_OPTION_VERSION_V1, .data = {.v1 = {.name = subCategory.name.c_str()}}};
+            WUPSConfigCategoryHandle handle;
+            auto res = Category::Create(options, &handle);
+            if (res == WUPSCONFIG_API_RESULT_SUCCESS) {
+                res = AddCategoryContent(handle, subCategory);
+            }
+            if (res == WUPSCONFIG_API_RESULT_SUCCESS) {
+                res = Category::AddCategory(parent, handle);
+            }
+            if (res != WUPSCONFIG_API_RESULT_SUCCESS) {
+                return res;
+            }
+        }
+        for (auto &item : category.items) {
+            WUPSConfigAPIItemCallbacksV2 callbacks = {
+                    .getCurrentValueDisplay         = &Item::GetCurrentValueDisplay,
+                    .getCurrentValueSelectedDisplay = &Item::GetCurrentValueSelectedDisplay,
+                    .onSelected                     = &Item::OnSelected,
+                    .restoreDefault                 = &Item::RestoreDefault,
+                    .isMovementAllowed              = &Item::IsMovementAllowed,
+                    .onCloseCallback                = &Item::OnCloseCallback,
+                    .onInput                        = &Item::OnInput,
+                    .onInputEx                      = item.usesInputEx ? &Item::OnInputEx : nullptr,
+                    .onDelete                       = &Item::OnDelete,
+            };
+            WUPSConfigAPICreateItemOptions options = {.version = WUPS_API_ITEM_OPTION_VERSION_V2, .data = {.v2 = {.displayName = item.name.c_str(), .context = &item, .callbacks = callbacks}}};
+            WUPSConfigItemHandle handle;
+            auto res = WUPSConfigAPIBackend::Item::Create(options, &handle);
+            if (res == WUPSCONFIG_API_RESULT_SUCCESS) {
+                res = Category::AddItem(parent, handle);
+            }
+            if (res != WUPSCONFIG_API_RESULT_SUCCESS) {
+                return res;
+            }
+        }
+        return WUPSCONFIG_API_RESULT_SUCCESS;
+    }
+
+    template<uint32_t Plugin>
+    WUPSConfigAPICallbackStatus MenuOpened(WUPSConfigCategoryHandle root) {
+        auto &plugin = sActiveHarness->getPlugin(Plugin);
+        plugin.menuOpenedCount++;
+        auto res = AddCategoryContent(root, plugin.root);
+        if (res != WUPSCONFIG_API_RESULT_SUCCESS) {
+            printf("Failed to create the config of %s: %s\n", plugin.name.c_str(), WUPSConfigAPI_GetStatusStr(res));
+            return WUPSCONFIG_API_CALLBACK_RESULT_ERROR;
+        }
+        return WUPSCONFIG_API_CALLBACK_RESULT_SUCCESS;
+    }
+
+    template<uint32_t Plugin>
+    void MenuClosed() {
+        sActiveHarness->getPlugin(Plugin).menuClosedCount++;
+    }
+
+    template<uint32_t Plugin>
+    WUPSConfigAPIStatus InitConfig(wups_loader_init_config_args_t args) {
+        auto &plugin                 = sActiveHarness->getPlugin(Plugin);
+        auto &name                   = plugin.configName.empty() ? plugin.name : plugin.configName;
+        WUPSConfigAPIOptions options = {.version = 1, .data = {.v1 = {.name = name.c_str()}}};
+        return WUPSConfigAPIBackend::InitEx(args.plugin_identifier, options, &MenuOpened<Plugin>, &MenuClosed<Plugin>);
+    }
+
+    template<uint32_t... Plugins>
+    std::array<void *, MAX_PLUGINS> GetInitConfigHooks(std::integer_sequence<uint32_t, Plugins...>) {
+        return {(void *) &InitConfig<Plugins>...};
+    }
+
+    const auto INIT_CONFIG_HOOKS = GetInitConfigHooks(std::make_integer_sequence<uint32_t, MAX_PLUGINS>());
+} // namespace
+
+ConfigMenuHarness::ConfigMenuHarness(std::vector<FakePlugin> plugins, HostScreenBackend &backend) : mBackend(backend) {
+    assert(plugins.size() <= MAX_PLUGINS);
+    if (gLoadedPlugins.capacity() < MAX_LOADED_PLUGINS) {
+        assert(gLoadedPlugins.empty());
+        gLoadedPlugins.reserve(MAX_LOADED_PLUGINS);
+    }
+    assert(gLoadedPlugins.size() + plugins.size() <= MAX_LOADED_PLUGINS);
+
+    activate();
+    mFirstPluginIndex = gLoadedPlugins.size();
+    for (uint32_t i = 0; i < plugins.size(); i++) {
+        mPlugins.push_back(std::make_unique<FakePlugin>(std::move(plugins[i])));
+        auto data = std::make_shared<PluginData>(std::vector<uint8_t>(), "fake:" + mPlugins[i]->name);
+        gLoadedPlugins.emplace_back(PluginMetaInformationFactory::Create(*mPlugins[i]), PluginInformationFactory::Create(INIT_CONFIG_HOOKS[i]), data);
+        CallHook(gLoadedPlugins.back(), WUPS_LOADER_HOOK_INIT_CONFIG);
+    }
+
+    // Same as ConfigUtils::displayMenu()
+    std::vector<ConfigDisplayItem> configs;
+    for (uint32_t i = mFirstPluginIndex; i < gLoadedPlugins.size(); i++) {
+        const auto &plugin = gLoadedPlugins[i];
+        GeneralConfigInformation info;
+        info.name    = plugin.getMetaInformation().getName();
+        info.author  = plugin.getMetaInformation().getAuthor();
+        info.version = plugin.getMetaInformation().getVersion();
+        configs.emplace_back(info, plugin);
+    }
+    std::sort(configs.begin(), configs.end(), [](const ConfigDisplayItem &lhs, const ConfigDisplayItem &rhs) {
+        auto &str1 = lhs.getConfigInformation().name;
+        auto &str2 = rhs.getConfigInformation().name;
+        return std::lexicographical_compare(str1.begin(), str1.end(), str2.begin(), str2.end(), [](char char1, char char2) {
+            return tolower(char1) < tolower(char2);
+        });
+    });
+    mRenderer = std::make_unique<ConfigRenderer>(std::move(configs));
+}
+
+ConfigMenuHarness::~ConfigMenuHarness() {
+    activate();
+    // Deletes the config items, their context has to be still valid
+    mRenderer.reset();
+    assert(gLoadedPlugins.size() == mFirstPluginIndex + mPlugins.size());
+    gLoadedPlugins.erase(gLoadedPlugins.begin() + mFirstPluginIndex, gLoadedPlugins.end());
+    if (sBackendOwner == this) {
+        sBackendOwner = nullptr;
+    }
+    sActiveHarness = nullptr;
+}
+
+void ConfigMenuHarness::activate() {
+    sActiveHarness = this;
+    if (sBackendOwner != this) {
+        DrawUtils::initBackend(&mBackend);
+        sBackendOwner = this;
+    }
+}
+
+bool ConfigMenuHarness::runFrame(uint32_t buttonsHeld) {
+    activate();
+
+    Input input;
+    input.data.buttons_h = buttonsHeld;
+    input.data.buttons_d = buttonsHeld & ~mLastButtonsHeld;
+    input.data.buttons_r = mLastButtonsHeld & ~buttonsHeld;
+    mLastButtonsHeld     = buttonsHeld;
+
+    WUPSConfigSimplePadData simpleData{};
+    simpleData.buttons_d = ConfigUtils::convertInputs(input.data.buttons_d);
+    simpleData.buttons_r = ConfigUtils::convertInputs(input.data.buttons_r);
+    simpleData.buttons_h = ConfigUtils::convertInputs(input.data.buttons_h);
+
+    WUPSConfigComplexPadData complexData{};
+    mRequestedComplexInput = mRenderer->NeedsComplexInput();
+
+    mRenderedLastFrame = false;
+    if (mRenderer->Update(input, simpleData, complexData) != SUB_STATE_RUNNING) {
+        return false;
+    }
+    if (mRenderingEnabled && mRenderer->NeedsRedraw()) {
+        mRenderer->Render();
+        mFrameTimes.push_back(DrawUtils::getLastFrameTime());
+        mRenderedLastFrame = true;
+    }
+    mRenderer->ResetNeedsRedraw();
+    return true;
+}
+
+bool ConfigMenuHarness::press(uint32_t buttons) {
+    return runFrame(buttons) && runFrame(0);
+}
+
+void ConfigMenuHarness::render() {
+    activate();
+    mRenderer->Render();
+    mRenderer->ResetNeedsRedraw();
+}
+
+void ConfigMenuHarness::close() {
+    activate();
+    mRenderer->CallMenuClosedCallbacks();
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "../draw/HostScreenBackend.h"
+#include "utils/config/ConfigRenderer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Config item of a fake plugin, implemented with the WUPSConfigAPIItemCallbacksV2.
+ * LEFT/RIGHT change the value. Editable items need A to start editing, while editing the cursor can't be moved and
+ * B stops editing.
+ */
+struct FakeItem {
+    std::string name;
+    int32_t value        = 0;
+    int32_t defaultValue = 0;
+    int32_t min          = 0;
+    int32_t max          = 10;
+    bool editable        = false;
+    // Sets the onInputEx callback, so the menu has to collect the complex pad data while the item is selected
+    bool usesInputEx = false;
+
+    bool editing               = false;
+    bool selected              = false;
+    uint32_t inputExCount      = 0;
+    uint32_t closeCount        = 0;
+    uint32_t selectedCallCount = 0;
+};
+
+struct FakeCategory {
+    std::string name;
+    std::vector<FakeCategory> categories;
+    std::vector<FakeItem> items;
+};
+
+/**
+ * Plugin whose config is created through the WUPSConfigAPI like a real plugin: the INIT_CONFIG hook calls InitEx and
+ * the menu opened callback builds the tree of root.
+ */
+struct FakePlugin {
+    std::string name;
+    std::string author;
+    std::string version;
+    // Name passed to WUPSConfigAPI_InitEx, the name of the plugin if empty
+    std::string configName;
+    FakeCategory root;
+
+    uint32_t menuOpenedCount = 0;
+    uint32_t menuClosedCount = 0;
+};
+
+/**
+ * Runs the loop of ConfigUtils::displayMenu() with scripted inputs and renders into a HostScreenBackend.
+ *
+ * The plugins are added to gLoadedPlugins for the lifetime of the harness. Multiple harnesses can exist at the same
+ * time (e.g. to render a reference), but they have to be destroyed in reverse order.
+ */
+class ConfigMenuHarness {
+public:
+    ConfigMenuHarness(std::vector<FakePlugin> plugins, HostScreenBackend &backend);
+
+    ~ConfigMenuHarness();
+
+    ConfigMenuHarness(const ConfigMenuHarness &) = delete;
+
+    /**
+     * Runs one iteration of the menu loop with buttonsHeld (Input::eButtons) being held, pressed and released buttons
+     * are derived from the previous frame. Doesn't render if rendering is disabled.
+     * Returns false once the menu has been left.
+     */
+    bool runFrame(uint32_t buttonsHeld);
+
+    /**
+     * Holds the buttons for one frame and releases them in the next one.
+     */
+    bool press(uint32_t buttons);
+
+    /**
+     * Renders everything that is pending, even if rendering is disabled.
+     */
+    void render();
+
+    /**
+     * Calls the menu closed callbacks like the menu does when it's left.
+     */
+    void close();
+
+    void setRenderingEnabled(bool enabled) {
+        mRenderingEnabled = enabled;
+    }
+
+    [[nodiscard]] bool hasRenderedLastFrame() const {
+        return mRenderedLastFrame;
+    }
+
+    /**
+     * Whether the complex pad data was requested in the last frame.
+     */
+    [[nodiscard]] bool hasRequestedComplexInput() const {
+        return mRequestedComplexInput;
+    }
+
+    [[nodiscard]] FakePlugin &getPlugin(uint32_t index) {
+        return *mPlugins[index];
+    }
+
+    /**
+     * Render times of the frames (DrawUtils::getLastFrameTime()) in microseconds.
+     */
+    [[nodiscard]] const std::vector<uint32_t> &getFrameTimes() const {
+        return mFrameTimes;
+    }
+
+private:
+    void activate();
+
+    // Owned by the harness, the items are used as the context of the config items.
+    std::vector<std::unique_ptr<FakePlugin>> mPlugins;
+    HostScreenBackend &mBackend;
+    uint32_t mFirstPluginIndex = 0;
+    std::unique_ptr<ConfigRenderer> mRenderer;
+
+    uint32_t mLastButtonsHeld   = 0;
+    bool mRenderingEnabled      = true;
+    bool mRenderedLastFrame     = false;
+    bool mRequestedComplexInput = false;
+    std::vector<uint32_t> mFrameTimes;
+};
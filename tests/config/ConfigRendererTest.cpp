@@ -0,0 +1,406 @@
+#include "../common/TestUtils.h"
+#include "ConfigMenuHarness.h"
+#include "utils/DrawUtils.h"
+#include "utils/config/ConfigDefines.h"
+
+#include <clocale>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Drives the config menu with scripted inputs and fake plugins and renders it into memory.
+ *
+ * The menu only redraws what changed, so after every rendered frame the displayed TV and DRC frames are compared with a
+ * full redraw of the same state: a second harness replays the inputs so far without rendering and then renders once.
+ *
+ * Needs a TTF font (WUPS_TEST_FONT, set by the Makefile), without it the test is skipped.
+ * config_renderer_test --dump DIR writes every rendered frame as PNG to DIR.
+ */
+namespace {
+    using Screen = HostScreenBackend::Screen;
+
+    const char *sDumpDir = nullptr;
+
+    // Time to render a frame by TV width, over all scenarios
+    std::map<uint32_t, TestUtils::LatencyStats> sFrameTimes;
+
+    FakeItem CreateItem(const std::string &name, int32_t value) {
+        FakeItem item;
+        item.name         = name;
+        item.value        = value;
+        item.defaultValue = value;
+        return item;
+    }
+
+    FakePlugin CreatePlugin(const std::string &name) {
+        FakePlugin plugin;
+        plugin.name      = name;
+        plugin.author    = "Tester";
+        plugin.version   = "v1.0";
+        plugin.root.name = name;
+        return plugin;
+    }
+
+    enum AlphaItems {
+        ALPHA_CATEGORY_ADVANCED = 0,
+        ALPHA_ITEM_VOLUME       = 1,
+        ALPHA_ITEM_BRIGHTNESS   = 2,
+        ALPHA_ITEM_MOTION       = 3,
+        ALPHA_ITEM_LONG_NAME    = 4,
+    };
+
+    /**
+     * Alpha:  Advanced (category), Volume, Brightness (editable), Motion (complex input), long name, the config has
+     *         a different name than the plugin
+     * Beta:   12 items, more than fit on the screen
+     * Empty:  no items
+     * 8 plugins with single item, so the plugin list has to scroll
+     */
+    std::vector<FakePlugin> CreatePlugins() {
+        std::vector<FakePlugin> plugins;
+
+        auto alpha = CreatePlugin("Alpha");
+        FakeCategory more;
+        more.name = "More";
+        more.items.push_back(CreateItem("Deep", 1));
+        FakeCategory advanced;
+        advanced.name = "Advanced";
+        advanced.categories.push_back(more);
+        advanced.items.push_back(CreateItem("Depth", 3));
+        alpha.root.categories.push_back(advanced);
+        alpha.root.items.push_back(CreateItem("Volume", 5));
+        auto brightness     = CreateItem("Brightness", 7);
+        brightness.editable = true;
+        alpha.root.items.push_back(brightness);
+        auto motion        = CreateItem("Motion", 0);
+        motion.usesInputEx = true;
+        alpha.root.items.push_back(motion);
+        alpha.root.items.push_back(CreateItem("An item with a name that is way too long to fit on the screen next to its value", 2));
+        alpha.configName = "Zeta";
+        plugins.push_back(alpha);
+
+        auto beta = CreatePlugin("Beta");
+        for (int32_t i = 0; i < 12; i++) {
+            beta.root.items.push_back(CreateItem("Setting " + std::to_string(i), i % 10));
+        }
+        plugins.push_back(beta);
+
+        plugins.push_back(CreatePlugin("Empty"));
+
+        for (int32_t i = 1; i <= 8; i++) {
+            auto plugin = CreatePlugin("Plugin " + std::to_string(i));
+            plugin.root.items.push_back(CreateItem("Enabled", 1));
+            plugins.push_back(plugin);
+        }
+        return plugins;
+    }
+
+    /**
+     * Runs the menu and checks every rendered frame against a full redraw.
+     */
+    class Scenario {
+    public:
+        Scenario(const char *name, const std::vector<FakePlugin> &plugins, uint32_t tvWidth)
+            : mName(std::string(name) + "_" + std::to_string(tvWidth)), mInitialPlugins(plugins), mTVWidth(tvWidth), mBackend(tvWidth), mHarness(plugins, mBackend) {
+        }
+
+        ~Scenario() {
+            for (auto time : mHarness.getFrameTimes()) {
+                sFrameTimes[mTVWidth].add((uint64_t) time * 1000);
+            }
+        }
+
+        /**
+         * Runs one frame with buttonsHeld being held, returns false once the menu has been left.
+         */
+        bool frame(uint32_t buttonsHeld) {
+            mScript.push_back(buttonsHeld);
+            bool running = mHarness.runFrame(buttonsHeld);
+            if (running && mHarness.hasRenderedLastFrame()) {
+                verify();
+            }
+            return running;
+        }
+
+        bool press(uint32_t buttons) {
+            return frame(buttons) && frame(0);
+        }
+
+        bool press(uint32_t buttons, uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (!press(buttons)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        ConfigMenuHarness &harness() {
+            return mHarness;
+        }
+
+        HostScreenBackend &backend() {
+            return mBackend;
+        }
+
+        /**
+         * Whether the displayed frames are identical to the first frame of the menu.
+         */
+        bool matchesInitialFrame() {
+            HostScreenBackend reference(mTVWidth);
+            ConfigMenuHarness initial(mInitialPlugins, reference);
+            initial.runFrame(0);
+            return mBackend.countDifferentPixels(reference, HostScreenBackend::SCREEN_TV) == 0 &&
+                   mBackend.countDifferentPixels(reference, HostScreenBackend::SCREEN_DRC) == 0;
+        }
+
+        /**
+         * Height of the DRC rows presented by the last rendered frame.
+         */
+        uint32_t getPresentedHeight() {
+            auto rows = mBackend.getLastPresentedRows(HostScreenBackend::SCREEN_DRC);
+            return rows.end - rows.start;
+        }
+
+    private:
+        void verify() {
+            HostScreenBackend reference(mTVWidth);
+            {
+                ConfigMenuHarness replay(mInitialPlugins, reference);
+                replay.setRenderingEnabled(false);
+                for (auto buttons : mScript) {
+                    replay.runFrame(buttons);
+                }
+                replay.render();
+            }
+
+            uint32_t frame = mScript.size() - 1;
+            if (sDumpDir) {
+                save(mBackend, frame, "");
+            }
+            for (auto screen : {HostScreenBackend::SCREEN_TV, HostScreenBackend::SCREEN_DRC}) {
+                uint32_t differentPixels = mBackend.countDifferentPixels(reference, screen);
+                if (differentPixels != 0) {
+                    printf("%s: frame %u: %u pixels on the %s differ from a full redraw\n", mName.c_str(), frame, differentPixels, screen == HostScreenBackend::SCREEN_TV ? "TV" : "DRC");
+                    TestUtils::gFailedChecks++;
+                    if (sDumpDir) {
+                        save(reference, frame, "_reference");
+                    }
+                }
+            }
+            if (mBackend.getUnpresentedRowCount() != 0) {
+                printf("%s: frame %u: %u rows have been modified without being presented\n", mName.c_str(), frame, mBackend.getUnpresentedRowCount());
+                TestUtils::gFailedChecks++;
+            }
+        }
+
+        void save(const HostScreenBackend &backend, uint32_t frame, const char *suffix) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s_%04u_tv%s.png", sDumpDir, mName.c_str(), frame, suffix);
+            backend.savePNG(HostScreenBackend::SCREEN_TV, path);
+            snprintf(path, sizeof(path), "%s/%s_%04u_drc%s.png", sDumpDir, mName.c_str(), frame, suffix);
+            backend.savePNG(HostScreenBackend::SCREEN_DRC, path);
+        }
+
+        std::string mName;
+        std::vector<FakePlugin> mInitialPlugins;
+        uint32_t mTVWidth;
+        std::vector<uint32_t> mScript;
+        HostScreenBackend mBackend;
+        ConfigMenuHarness mHarness;
+    };
+
+    void TestPluginList(uint32_t tvWidth) {
+        auto plugins = CreatePlugins();
+        Scenario scenario("plugin_list", plugins, tvWidth);
+        auto &harness = scenario.harness();
+        auto &backend = scenario.backend();
+
+        // The first frame is drawn completely
+        CHECK(scenario.frame(0));
+        CHECK(harness.hasRenderedLastFrame());
+        CHECK(backend.getPresentCount() == 1);
+        CHECK(scenario.getPresentedHeight() == backend.getHeight(HostScreenBackend::SCREEN_DRC));
+
+        // Nothing changed
+        CHECK(scenario.frame(0));
+        CHECK(!harness.hasRenderedLastFrame());
+        CHECK(backend.getPresentCount() == 1);
+
+        // The other buffer hasn't been drawn yet, so it's drawn completely as well
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.getPresentedHeight() == backend.getHeight(HostScreenBackend::SCREEN_DRC));
+
+        // From now on a frame redraws its changes and those of the previous frame, which went into the other buffer.
+        // Moving the cursor twice touches three rows.
+        CHECK(scenario.frame(Input::eButtons::BUTTON_DOWN));
+        CHECK(harness.hasRenderedLastFrame());
+        CHECK(scenario.getPresentedHeight() <= 3 * ConfigLayout::ROW_HEIGHT);
+        CHECK(scenario.frame(0));
+        CHECK(!harness.hasRenderedLastFrame());
+
+        // Scroll down until the list has to move, then wrap around in both directions
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN, 8));
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN, 2));
+        CHECK(scenario.press(Input::eButtons::BUTTON_UP, 12));
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+
+        // The configs are only created when they are opened
+        for (uint32_t i = 0; i < plugins.size(); i++) {
+            CHECK(harness.getPlugin(i).menuOpenedCount == 0);
+        }
+
+        CHECK(!scenario.frame(Input::eButtons::BUTTON_B));
+        harness.close();
+        for (uint32_t i = 0; i < plugins.size(); i++) {
+            CHECK(harness.getPlugin(i).menuClosedCount == 0);
+        }
+    }
+
+    void TestCategories(uint32_t tvWidth) {
+        Scenario scenario("categories", CreatePlugins(), tvWidth);
+        auto &harness = scenario.harness();
+        auto &alpha   = harness.getPlugin(0);
+        auto &beta    = harness.getPlugin(1);
+        auto &items   = alpha.root.items;
+
+        CHECK(scenario.frame(0));
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(alpha.menuOpenedCount == 1);
+        CHECK(beta.menuOpenedCount == 0);
+
+        // Change a value twice, the second time only its row is redrawn in both buffers
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        auto &volume = items[ALPHA_ITEM_VOLUME - 1];
+        CHECK(volume.selected);
+        CHECK(scenario.press(Input::eButtons::BUTTON_RIGHT));
+        CHECK(scenario.frame(Input::eButtons::BUTTON_RIGHT));
+        CHECK(volume.value == 7);
+        CHECK(harness.hasRenderedLastFrame());
+        CHECK(scenario.getPresentedHeight() <= ConfigLayout::ROW_HEIGHT);
+        CHECK(scenario.frame(0));
+        CHECK(scenario.press(Input::eButtons::BUTTON_LEFT, 8));
+        CHECK(volume.value == volume.min);
+
+        // The cursor can't be moved while an item is being edited
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        auto &brightness = items[ALPHA_ITEM_BRIGHTNESS - 1];
+        CHECK(scenario.press(Input::eButtons::BUTTON_RIGHT));
+        CHECK(brightness.value == 7);
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(brightness.editing);
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(brightness.selected);
+        CHECK(scenario.press(Input::eButtons::BUTTON_RIGHT));
+        CHECK(brightness.value == 8);
+        // B only stops editing
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+        CHECK(!brightness.editing);
+
+        // The complex input is only needed while an item using it is selected
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        auto &motion = items[ALPHA_ITEM_MOTION - 1];
+        CHECK(motion.selected);
+        CHECK(scenario.frame(0));
+        CHECK(harness.hasRequestedComplexInput());
+        CHECK(motion.inputExCount > 0);
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.frame(0));
+        CHECK(!harness.hasRequestedComplexInput());
+
+        // Holding the stick scrolls a long name, each step redraws the row
+        for (uint32_t i = 0; i < 12; i++) {
+            CHECK(scenario.frame(Input::eButtons::STICK_L_RIGHT));
+            CHECK(harness.hasRenderedLastFrame());
+            // The first step also redraws the rows of the previous cursor move
+            CHECK(scenario.getPresentedHeight() <= (i == 0 ? 2 : 1) * ConfigLayout::ROW_HEIGHT);
+        }
+        for (uint32_t i = 0; i < 4; i++) {
+            CHECK(scenario.frame(Input::eButtons::STICK_L_LEFT));
+        }
+        CHECK(scenario.frame(0));
+
+        // Wrap around to the sub category and open it and its sub category
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(scenario.press(Input::eButtons::BUTTON_RIGHT));
+        CHECK(alpha.root.categories[0].categories[0].items[0].value == 2);
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.press(Input::eButtons::BUTTON_LEFT));
+        CHECK(alpha.root.categories[0].items[0].value == 2);
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+
+        // Opening the same plugin again keeps its config
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(alpha.menuOpenedCount == 1);
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+        // The list still shows the name of the plugin, not the one of its config
+        CHECK(scenario.matchesInitialFrame());
+
+        // A category with more items than fit on the screen
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(beta.menuOpenedCount == 1);
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN, 13));
+        CHECK(scenario.press(Input::eButtons::BUTTON_UP, 3));
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+
+        // A config without any items
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.press(Input::eButtons::BUTTON_A));
+        CHECK(harness.getPlugin(2).menuOpenedCount == 1);
+        CHECK(scenario.press(Input::eButtons::BUTTON_DOWN));
+        CHECK(scenario.press(Input::eButtons::BUTTON_B));
+
+        // Leaving the menu notifies the opened plugins and their items
+        CHECK(!scenario.frame(Input::eButtons::BUTTON_B));
+        harness.close();
+        CHECK(alpha.menuClosedCount == 1);
+        CHECK(beta.menuClosedCount == 1);
+        CHECK(harness.getPlugin(3).menuClosedCount == 0);
+        for (const auto &item : items) {
+            CHECK(item.closeCount == 1);
+        }
+        CHECK(alpha.root.categories[0].categories[0].items[0].closeCount == 1);
+        CHECK(beta.root.items[11].closeCount == 1);
+        CHECK(harness.getPlugin(3).root.items[0].closeCount == 0);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            sDumpDir = argv[++i];
+        } else {
+            printf("Usage: %s [--dump DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // The texts of the menu are UTF-8, DrawUtils converts them with mbstowcs() which needs a UTF-8 locale on the host.
+    setlocale(LC_ALL, "C.UTF-8");
+
+    if (!DrawUtils::initFont()) {
+        printf("config_renderer_test: SKIPPED, no font (set WUPS_TEST_FONT to a TTF file)\n");
+        return 0;
+    }
+
+    // 640, 854 and 1920 scale the TV differently than 1280
+    for (uint32_t tvWidth : {1280, 640, 854, 1920}) {
+        TestPluginList(tvWidth);
+        TestCategories(tvWidth);
+    }
+
+    printf("Frame times:\n");
+    for (auto &[tvWidth, stats] : sFrameTimes) {
+        stats.print(("TV width " + std::to_string(tvWidth)).c_str());
+    }
+
+    DrawUtils::deinitFont();
+    return TestUtils::Finish("config_renderer_test");
+}
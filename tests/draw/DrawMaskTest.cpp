@@ -0,0 +1,249 @@
+#include "../common/TestUtils.h"
+#include "HostScreenBackend.h"
+#include "utils/DrawUtils.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Golden-image test of DrawUtils::drawMask().
+ *
+ * The reference is drawn without DrawUtils: masks are blended pixel by pixel and row by row like glyphs were drawn
+ * before drawMask() existed (draw_freetype_bitmap() calling blendMaskSpan() for each row), the TV is scaled from it
+ * pixel by pixel. Both screens have to be identical.
+ *
+ * draw_mask_test --dump DIR writes both outputs of a failing scene as PNG to DIR.
+ */
+namespace {
+    const char *sDumpDir = nullptr;
+
+    const Color BACKGROUND(238, 238, 238, 255);
+
+    struct Mask {
+        int32_t x;
+        int32_t y;
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> coverage;
+        Color color;
+        // Clip rect, w == 0 if not clipped
+        DrawRect clip;
+    };
+
+    struct Rect {
+        DrawRect rect;
+        Color color;
+    };
+
+    // Rounded division by 255 for values up to 255 * 255
+    uint32_t Div255(uint32_t value) {
+        value += 128;
+        return (value + (value >> 8)) >> 8;
+    }
+
+    uint8_t BlendChannel(uint8_t dst, uint8_t src, uint32_t alpha) {
+        return (uint8_t) Div255(src * alpha + dst * (255 - alpha));
+    }
+
+    Color BlendPixel(Color dst, Color src, uint32_t alpha) {
+        return {BlendChannel(dst.r, src.r, alpha), BlendChannel(dst.g, src.g, alpha), BlendChannel(dst.b, src.b, alpha), BlendChannel(dst.a, src.a, alpha)};
+    }
+
+    /**
+     * Draws the scene like DrawUtils did before drawMask(), the screen is SCREEN_WIDTH x SCREEN_HEIGHT pixels.
+     */
+    std::vector<Color> DrawReference(const std::vector<Rect> &rects, const std::vector<Mask> &masks) {
+        std::vector<Color> screen(SCREEN_WIDTH * SCREEN_HEIGHT, BACKGROUND);
+        for (const auto &rect : rects) {
+            for (uint32_t y = rect.rect.y; y < rect.rect.y + rect.rect.h; y++) {
+                for (uint32_t x = rect.rect.x; x < rect.rect.x + rect.rect.w; x++) {
+                    screen[y * SCREEN_WIDTH + x] = rect.color;
+                }
+            }
+        }
+
+        for (const auto &mask : masks) {
+            int32_t clipX0 = 0, clipY0 = 0, clipX1 = SCREEN_WIDTH, clipY1 = SCREEN_HEIGHT;
+            if (mask.clip.w != 0) {
+                clipX0 = std::max<int32_t>(clipX0, mask.clip.x);
+                clipY0 = std::max<int32_t>(clipY0, mask.clip.y);
+                clipX1 = std::min<int32_t>(clipX1, mask.clip.x + mask.clip.w);
+                clipY1 = std::min<int32_t>(clipY1, mask.clip.y + mask.clip.h);
+            }
+            for (uint32_t row = 0; row < mask.height; row++) {
+                int32_t y = mask.y + (int32_t) row;
+                if (y < clipY0 || y >= clipY1) {
+                    continue;
+                }
+                for (uint32_t column = 0; column < mask.width; column++) {
+                    int32_t x = mask.x + (int32_t) column;
+                    if (x < clipX0 || x >= clipX1) {
+                        continue;
+                    }
+                    uint32_t alpha = mask.coverage[row * mask.width + column];
+                    if (alpha == 0 || mask.color.a == 0) {
+                        continue;
+                    }
+                    if (mask.color.a != 0xFF) {
+                        alpha = Div255(alpha * mask.color.a);
+                    }
+                    auto &pixel = screen[y * SCREEN_WIDTH + x];
+                    if (alpha == 0xFF) {
+                        pixel = mask.color;
+                    } else if (alpha != 0) {
+                        pixel = BlendPixel(pixel, mask.color, alpha);
+                    }
+                }
+            }
+        }
+        return screen;
+    }
+
+    /**
+     * Screen pixel every TV pixel shows when each screen pixel is scaled on its own: pixel i covers
+     * [i * scale, i * scale + (uint32_t) scale), a TV pixel covered by two screen pixels shows the second one.
+     * -1 if the TV pixel isn't covered.
+     */
+    std::vector<int32_t> GetTVSources(uint32_t count, uint32_t tvCount, float scale) {
+        std::vector<int32_t> sources(tvCount, -1);
+        for (uint32_t i = 0; i < count; i++) {
+            auto start  = (uint32_t) (i * scale);
+            float limit = (i * scale) + (uint32_t) scale;
+            for (uint32_t tv = start; tv < limit && tv < tvCount; tv++) {
+                sources[tv] = (int32_t) i;
+            }
+        }
+        return sources;
+    }
+
+    /**
+     * Writes the reference into the back buffers of backend and presents them.
+     */
+    void PresentReference(HostScreenBackend &backend, const std::vector<Color> &screen) {
+        backend.clear(BACKGROUND.color);
+        auto drc        = backend.getDRCSurface();
+        auto *drcPixels = (Color *) (drc.buffer + backend.getBackBufferIndex() * (drc.size / 2));
+        for (uint32_t y = 0; y < SCREEN_HEIGHT; y++) {
+            memcpy(drcPixels + y * drc.pitch, &screen[y * SCREEN_WIDTH], SCREEN_WIDTH * sizeof(Color));
+        }
+
+        auto tv        = backend.getTVSurface();
+        auto *tvPixels = (Color *) (tv.buffer + backend.getBackBufferIndex() * (tv.size / 2));
+        auto columns   = GetTVSources(SCREEN_WIDTH, tv.pitch, backend.getTVScale());
+        auto rows      = GetTVSources(SCREEN_HEIGHT, tv.height, backend.getTVScale());
+        for (uint32_t y = 0; y < tv.height; y++) {
+            for (uint32_t x = 0; x < tv.pitch; x++) {
+                if (rows[y] >= 0 && columns[x] >= 0) {
+                    tvPixels[y * tv.pitch + x] = screen[rows[y] * SCREEN_WIDTH + columns[x]];
+                }
+            }
+        }
+        backend.present({0, tv.height}, {0, drc.height});
+    }
+
+    void DrawScene(HostScreenBackend &backend, const std::vector<Rect> &rects, const std::vector<Mask> &masks) {
+        DrawUtils::initBackend(&backend);
+        DrawUtils::beginDraw();
+        DrawUtils::clear(BACKGROUND);
+        for (const auto &rect : rects) {
+            DrawUtils::drawRectFilled(rect.rect.x, rect.rect.y, rect.rect.w, rect.rect.h, rect.color);
+        }
+        for (const auto &mask : masks) {
+            if (mask.clip.w != 0) {
+                DrawUtils::setClipRect(mask.clip);
+            }
+            DrawUtils::drawMask(mask.x, mask.y, mask.coverage.data(), mask.width, mask.height, mask.color);
+            DrawUtils::resetClipRect();
+        }
+        DrawUtils::endDraw();
+    }
+
+    /**
+     * Glyph-like masks: mostly empty or fully covered with anti-aliased pixels in between.
+     */
+    Mask CreateMask(std::mt19937 &rng, uint32_t maxSize) {
+        Mask mask{};
+        mask.width  = 1 + rng() % maxSize;
+        mask.height = 1 + rng() % maxSize;
+        // Partially off-screen on every side
+        mask.x = (int32_t) (rng() % (SCREEN_WIDTH + mask.width)) - (int32_t) mask.width / 2;
+        mask.y = (int32_t) (rng() % (SCREEN_HEIGHT + mask.height)) - (int32_t) mask.height / 2;
+        mask.coverage.resize(mask.width * mask.height);
+        for (auto &coverage : mask.coverage) {
+            auto kind = rng() % 4;
+            coverage  = kind == 0 ? 0 : (kind == 1 ? 0xFF : rng() % 256);
+        }
+        // Mostly opaque like the text of the menu
+        mask.color = Color(rng(), rng(), rng(), rng() % 3 != 0 ? 0xFF : rng() % 256);
+        if (rng() % 3 == 0) {
+            uint32_t x = rng() % SCREEN_WIDTH;
+            uint32_t y = rng() % SCREEN_HEIGHT;
+            // May reach past the screen
+            uint32_t w = 1 + rng() % SCREEN_WIDTH;
+            uint32_t h = 1 + rng() % SCREEN_HEIGHT;
+            mask.clip  = {x, y, w, h};
+        }
+        return mask;
+    }
+
+    void TestScene(const char *name, uint32_t tvWidth, const std::vector<Rect> &rects, const std::vector<Mask> &masks) {
+        HostScreenBackend backend(tvWidth);
+        HostScreenBackend reference(tvWidth);
+        DrawScene(backend, rects, masks);
+        PresentReference(reference, DrawReference(rects, masks));
+
+        bool failed = false;
+        for (auto screen : {HostScreenBackend::SCREEN_TV, HostScreenBackend::SCREEN_DRC}) {
+            uint32_t differentPixels = backend.countDifferentPixels(reference, screen);
+            if (differentPixels != 0) {
+                printf("%s at TV width %u: %u pixels on the %s differ from the reference\n", name, tvWidth, differentPixels, screen == HostScreenBackend::SCREEN_TV ? "TV" : "DRC");
+                TestUtils::gFailedChecks++;
+                failed = true;
+            }
+        }
+        if (failed && sDumpDir) {
+            std::string prefix = std::string(sDumpDir) + "/" + name + "_" + std::to_string(tvWidth);
+            backend.savePNG(HostScreenBackend::SCREEN_TV, (prefix + "_tv.png").c_str());
+            backend.savePNG(HostScreenBackend::SCREEN_DRC, (prefix + "_drc.png").c_str());
+            reference.savePNG(HostScreenBackend::SCREEN_TV, (prefix + "_tv_reference.png").c_str());
+            reference.savePNG(HostScreenBackend::SCREEN_DRC, (prefix + "_drc_reference.png").c_str());
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            sDumpDir = argv[++i];
+        } else {
+            printf("Usage: %s [--dump DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(1);
+    // Rows of the menu the masks are blended onto
+    std::vector<Rect> rects;
+    for (uint32_t i = 0; i < 8; i++) {
+        rects.push_back({{16, 44 + i * 50, SCREEN_WIDTH - 32, 44}, Color(rng(), rng(), rng(), 0xFF)});
+    }
+
+    // Glyph sized masks, and masks bigger than a cell of the glyph cache
+    std::vector<Mask> glyphs;
+    std::vector<Mask> bigMasks;
+    for (uint32_t i = 0; i < 3000; i++) {
+        glyphs.push_back(CreateMask(rng, 40));
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        bigMasks.push_back(CreateMask(rng, 300));
+    }
+
+    for (uint32_t tvWidth : {1280, 1920, 854, 640}) {
+        TestScene("glyphs", tvWidth, rects, glyphs);
+        TestScene("big_masks", tvWidth, rects, bigMasks);
+    }
+
+    return TestUtils::Finish("draw_mask_test");
+}
@@ -0,0 +1,236 @@
+#include "../common/TestUtils.h"
+#include "HostScreenBackend.h"
+#include "utils/DrawUtils.h"
+#include "utils/config/ConfigDefines.h"
+#include "utils/schrift.h"
+
+#include <clocale>
+#include <coreinit/memory.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Measures the text of a config menu page per frame, with the glyph cache of DrawUtils and with the baseline that
+ * looks up, measures and renders every character of every string on every frame (like DrawUtils did before the cache).
+ * Both draw through DrawUtils::drawMask(), so only the glyph handling differs. The output has to be identical.
+ *
+ * Needs a TTF font (WUPS_TEST_FONT, set by the Makefile).
+ * glyph_cache_benchmark --frames N sets the number of measured frames.
+ */
+namespace {
+    /**
+     * DrawUtils::print() and DrawUtils::getTextWidth() without the cache.
+     */
+    class UncachedText {
+    public:
+        bool init() {
+            void *font    = nullptr;
+            uint32_t size = 0;
+            OSGetSharedData(OS_SHAREDDATATYPE_FONT_STANDARD, 0, &font, &size);
+            if (!font || !size) {
+                return false;
+            }
+            mFont.flags = SFT_DOWNWARD_Y;
+            mFont.font  = sft_loadmem(font, size);
+            setFontSize(20);
+            return mFont.font != nullptr;
+        }
+
+        ~UncachedText() {
+            sft_freefont(mFont.font);
+        }
+
+        void setFontSize(uint32_t size) {
+            mFont.xScale = size;
+            mFont.yScale = size;
+        }
+
+        void setFontColor(Color col) {
+            mColor = col;
+        }
+
+        void print(uint32_t x, uint32_t y, const char *string, bool alignRight = false) {
+            auto text = ToWide(string);
+            auto penX = (int32_t) x;
+            auto penY = (int32_t) y;
+            if (alignRight) {
+                penX -= getTextWidth(text.c_str());
+            }
+            for (const wchar_t *cur = text.c_str(); *cur; cur++) {
+                SFT_Glyph gid;
+                if (sft_lookup(&mFont, *cur, &gid) < 0) {
+                    continue;
+                }
+                SFT_GMetrics mtx;
+                if (sft_gmetrics(&mFont, gid, &mtx) < 0) {
+                    return;
+                }
+                if (*cur == '\n') {
+                    penY += mtx.minHeight;
+                    penX = x;
+                    continue;
+                }
+                uint16_t width  = (mtx.minWidth + 3) & ~3;
+                uint16_t height = mtx.minHeight;
+                if (width == 0) {
+                    width = 4;
+                }
+                if (height == 0) {
+                    height = 4;
+                }
+                // Zeroed like the atlas cells, sft_render doesn't touch the bitmap of empty glyphs
+                auto pixels = std::make_unique<uint8_t[]>((uint32_t) width * height);
+                if (sft_render(&mFont, gid, {.pixels = pixels.get(), .width = width, .height = height}) < 0) {
+                    return;
+                }
+                DrawUtils::drawMask((int32_t) (penX + mtx.leftSideBearing), (int32_t) (penY + mtx.yOffset), pixels.get(), width, height, mColor);
+                penX += (int32_t) mtx.advanceWidth;
+            }
+        }
+
+        uint32_t getTextWidth(const char *string) {
+            return getTextWidth(ToWide(string).c_str());
+        }
+
+    private:
+        static std::wstring ToWide(const char *string) {
+            std::wstring res(strlen(string), L'\0');
+            res.resize(mbstowcs(res.data(), string, res.size()));
+            return res;
+        }
+
+        uint32_t getTextWidth(const wchar_t *string) {
+            uint32_t width = 0;
+            for (; *string; string++) {
+                SFT_Glyph gid;
+                SFT_GMetrics mtx;
+                if (sft_lookup(&mFont, *string, &gid) >= 0 && sft_gmetrics(&mFont, gid, &mtx) >= 0) {
+                    width += (int32_t) mtx.advanceWidth;
+                }
+            }
+            return width;
+        }
+
+        SFT mFont{};
+        Color mColor = COLOR_TEXT;
+    };
+
+    /**
+     * Calls forwarded to DrawUtils.
+     */
+    class CachedText {
+    public:
+        void setFontSize(uint32_t size) {
+            DrawUtils::setFontSize(size);
+        }
+
+        void setFontColor(Color col) {
+            DrawUtils::setFontColor(col);
+        }
+
+        void print(uint32_t x, uint32_t y, const char *string, bool alignRight = false) {
+            DrawUtils::print(x, y, string, alignRight);
+        }
+
+        uint32_t getTextWidth(const char *string) {
+            return DrawUtils::getTextWidth(string);
+        }
+    };
+
+    /**
+     * The text of a page of the plugin list, see ConfigRenderer::RenderStateMain().
+     */
+    template<typename Text>
+    void DrawMenuText(Text &text) {
+        text.setFontColor(COLOR_TEXT);
+        text.setFontSize(24);
+        text.print(16, 6 + 24, "Wii U Plugin System Config Menu");
+        text.setFontSize(18);
+        text.print(SCREEN_WIDTH - 16, 8 + 24, "v0.3.4", true);
+
+        for (uint32_t i = 0; i < MAX_BUTTONS_ON_SCREEN; i++) {
+            uint32_t y       = ConfigLayout::GetRowRect(i).y;
+            std::string name = "Example Plugin " + std::to_string(i + 1);
+            text.setFontSize(24);
+            text.print(16 * 2, y + 8 + 24, name.c_str());
+            uint32_t width = text.getTextWidth(name.c_str());
+            text.setFontSize(12);
+            text.print(16 * 2 + width + 4, y + 8 + 24, "by Maschell and contributors");
+            text.print(SCREEN_WIDTH - 16 * 2, y + 8 + 24, "v1.2.3", true);
+        }
+
+        text.setFontSize(18);
+        text.print(16, SCREEN_HEIGHT - 10, "\ue07d Navigate ");
+        text.print(SCREEN_WIDTH - 16, SCREEN_HEIGHT - 10, "\ue000 Select", true);
+        const char *exitHint = "\ue044 Exit";
+        text.print(SCREEN_WIDTH / 2 + text.getTextWidth(exitHint) / 2, SCREEN_HEIGHT - 10, exitHint, true);
+    }
+
+    /**
+     * Draws the page into the backend and returns how long the text took.
+     */
+    template<typename Text>
+    uint64_t DrawFrame(HostScreenBackend &backend, Text &text) {
+        DrawUtils::initBackend(&backend);
+        DrawUtils::beginDraw();
+        DrawUtils::clear(COLOR_BACKGROUND);
+        TestUtils::Stopwatch watch;
+        DrawMenuText(text);
+        uint64_t duration = watch.elapsedNs();
+        DrawUtils::endDraw();
+        return duration;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t frames = 500;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtoul(argv[++i], nullptr, 10);
+        } else {
+            printf("Usage: %s [--frames N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // The texts are UTF-8, DrawUtils converts them with mbstowcs() which needs a UTF-8 locale on the host.
+    setlocale(LC_ALL, "C.UTF-8");
+
+    UncachedText uncached;
+    if (!DrawUtils::initFont() || !uncached.init()) {
+        printf("glyph_cache_benchmark: SKIPPED, no font (set WUPS_TEST_FONT to a TTF file)\n");
+        return 0;
+    }
+    CachedText cached;
+
+    HostScreenBackend cachedBackend;
+    HostScreenBackend uncachedBackend;
+
+    // The first frame fills the cache
+    uint64_t coldFrame = DrawFrame(cachedBackend, cached);
+    DrawFrame(uncachedBackend, uncached);
+    for (auto screen : {HostScreenBackend::SCREEN_TV, HostScreenBackend::SCREEN_DRC}) {
+        CHECK(cachedBackend.countDifferentPixels(uncachedBackend, screen) == 0);
+    }
+
+    TestUtils::LatencyStats cachedStats;
+    TestUtils::LatencyStats uncachedStats;
+    for (uint32_t i = 0; i < frames; i++) {
+        cachedStats.add(DrawFrame(cachedBackend, cached));
+        uncachedStats.add(DrawFrame(uncachedBackend, uncached));
+    }
+    for (auto screen : {HostScreenBackend::SCREEN_TV, HostScreenBackend::SCREEN_DRC}) {
+        CHECK(cachedBackend.countDifferentPixels(uncachedBackend, screen) == 0);
+    }
+
+    printf("Text of a plugin list page per frame\n");
+    printf("  %-28s %9.2f us\n", "glyph cache, first frame", (double) coldFrame / 1000.0);
+    cachedStats.print("glyph cache");
+    uncachedStats.print("baseline (no cache)");
+
+    DrawUtils::deinitFont();
+    return TestUtils::Finish("glyph_cache_benchmark");
+}
@@ -0,0 +1,129 @@
+#include "HostScreenBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <png.h>
+#include <vector>
+
+// buffer width, same as on the console
+#define DRC_WIDTH  0x380
+#define DRC_HEIGHT 480
+
+HostScreenBackend::HostScreenBackend(uint32_t tvWidth) {
+    uint32_t tvPitch  = tvWidth;
+    uint32_t tvHeight = 480;
+    switch (tvWidth) {
+        case 640:
+            mTVScale = 0.75f;
+            break;
+        case 854:
+            // The pitch needs to be a multiple of 32 pixels
+            tvPitch  = 896;
+            mTVScale = 1.0f;
+            break;
+        case 1280:
+            tvHeight = 720;
+            mTVScale = 1.5f;
+            break;
+        case 1920:
+            tvHeight = 1080;
+            mTVScale = 2.25f;
+            break;
+        default:
+            mTVScale = 1.0f;
+            break;
+    }
+    mVisibleTVWidth = tvWidth;
+
+    mSurfaces[SCREEN_TV]  = {.buffer = nullptr, .size = tvPitch * tvHeight * 4 * 2, .pitch = tvPitch, .height = tvHeight};
+    mSurfaces[SCREEN_DRC] = {.buffer = nullptr, .size = DRC_WIDTH * DRC_HEIGHT * 4 * 2, .pitch = DRC_WIDTH, .height = DRC_HEIGHT};
+    for (auto screen : {SCREEN_TV, SCREEN_DRC}) {
+        // Zero-initialized like the buffers of the console after OSScreenInit()
+        mBuffers[screen]         = std::make_unique<uint8_t[]>(mSurfaces[screen].size);
+        mPresented[screen]       = std::make_unique<uint8_t[]>(mSurfaces[screen].size);
+        mSurfaces[screen].buffer = mBuffers[screen].get();
+    }
+}
+
+void HostScreenBackend::clear(uint32_t color) {
+    for (auto screen : {SCREEN_TV, SCREEN_DRC}) {
+        auto *pixels = getRow(screen, getBackBufferIndex(), 0);
+        std::fill(pixels, pixels + mSurfaces[screen].size / 8, color);
+    }
+}
+
+void HostScreenBackend::present(RowRange tvRows, RowRange drcRows) {
+    uint32_t backBufferIndex = getBackBufferIndex();
+    for (auto screen : {SCREEN_TV, SCREEN_DRC}) {
+        const auto &surface = mSurfaces[screen];
+        auto rows           = screen == SCREEN_TV ? tvRows : drcRows;
+        uint32_t rowSize    = surface.pitch * 4;
+        uint8_t *presented  = mPresented[screen].get() + backBufferIndex * (surface.size / 2);
+        for (uint32_t y = 0; y < surface.height; y++) {
+            auto *row = (const uint8_t *) getRow(screen, backBufferIndex, y);
+            if (y >= rows.start && y < rows.end) {
+                memcpy(presented + y * rowSize, row, rowSize);
+            } else if (memcmp(presented + y * rowSize, row, rowSize) != 0) {
+                mUnpresentedRowCount++;
+            }
+        }
+        mLastPresentedRows[screen] = rows;
+    }
+    mFrontBufferIndex = backBufferIndex;
+    mPresentCount++;
+}
+
+uint64_t HostScreenBackend::getTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t HostScreenBackend::getWidth(Screen screen) const {
+    return screen == SCREEN_TV ? mVisibleTVWidth : 854;
+}
+
+const uint32_t *HostScreenBackend::getFrontRow(Screen screen, uint32_t y) const {
+    return getRow(screen, mFrontBufferIndex, y);
+}
+
+uint32_t HostScreenBackend::countDifferentPixels(const HostScreenBackend &other, Screen screen) const {
+    uint32_t width  = std::min(getWidth(screen), other.getWidth(screen));
+    uint32_t height = std::min(getHeight(screen), other.getHeight(screen));
+    uint32_t count  = 0;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint32_t *row      = getFrontRow(screen, y);
+        const uint32_t *otherRow = other.getFrontRow(screen, y);
+        for (uint32_t x = 0; x < width; x++) {
+            if (row[x] != otherRow[x]) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+bool HostScreenBackend::savePNG(Screen screen, const char *path) const {
+    uint32_t width  = getWidth(screen);
+    uint32_t height = getHeight(screen);
+
+    // The pixels are stored as R, G, B, A bytes, the alpha of the screen is ignored.
+    std::vector<uint8_t> rgb(width * height * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        auto *row = (const uint8_t *) getFrontRow(screen, y);
+        for (uint32_t x = 0; x < width; x++) {
+            memcpy(&rgb[(y * width + x) * 3], &row[x * 4], 3);
+        }
+    }
+
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+    image.width   = width;
+    image.height  = height;
+    image.format  = PNG_FORMAT_RGB;
+    if (!png_image_write_to_file(&image, path, 0, rgb.data(), (png_int_32) (width * 3), nullptr)) {
+        fprintf(stderr, "Failed to write %s: %s\n", path, image.message);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "utils/ScreenBackend.h"
+#include <cstdint>
+#include <memory>
+
+/**
+ * Renders into memory instead of OSScreen, so DrawUtils and the config menu can run on the host.
+ *
+ * Both screens are double buffered like with OSScreen, present() displays the back buffer. It also checks the promise
+ * of DrawUtils that rows outside of the presented ranges haven't been modified, on the console these rows would never
+ * be flushed.
+ */
+class HostScreenBackend : public ScreenBackend {
+public:
+    enum Screen {
+        SCREEN_TV  = 0,
+        SCREEN_DRC = 1,
+    };
+
+    /**
+     * tvWidth is the width of the TV scan buffer (640, 854, 1280 or 1920), the TV is set up like OSScreenBackend does for
+     * HDMI.
+     */
+    explicit HostScreenBackend(uint32_t tvWidth = 1280);
+
+    ~HostScreenBackend() override = default;
+
+    [[nodiscard]] Surface getTVSurface() const override {
+        return mSurfaces[SCREEN_TV];
+    }
+
+    [[nodiscard]] Surface getDRCSurface() const override {
+        return mSurfaces[SCREEN_DRC];
+    }
+
+    [[nodiscard]] float getTVScale() const override {
+        return mTVScale;
+    }
+
+    uint32_t getBackBufferIndex() override {
+        return mFrontBufferIndex ^ 1;
+    }
+
+    void clear(uint32_t color) override;
+
+    void present(RowRange tvRows, RowRange drcRows) override;
+
+    void waitForVSync() override {
+        mVSyncCount++;
+    }
+
+    uint64_t getTime() override;
+
+    [[nodiscard]] uint32_t getWidth(Screen screen) const;
+
+    [[nodiscard]] uint32_t getHeight(Screen screen) const {
+        return mSurfaces[screen].height;
+    }
+
+    /**
+     * Pixel of the frame that is currently displayed.
+     */
+    [[nodiscard]] uint32_t getPixel(Screen screen, uint32_t x, uint32_t y) const {
+        return getFrontRow(screen, y)[x];
+    }
+
+    [[nodiscard]] const uint32_t *getFrontRow(Screen screen, uint32_t y) const;
+
+    /**
+     * Number of visible pixels of the displayed frame that differ from the displayed frame of other.
+     */
+    [[nodiscard]] uint32_t countDifferentPixels(const HostScreenBackend &other, Screen screen) const;
+
+    /**
+     * Writes the displayed frame to a PNG file.
+     */
+    bool savePNG(Screen screen, const char *path) const;
+
+    [[nodiscard]] uint32_t getPresentCount() const {
+        return mPresentCount;
+    }
+
+    [[nodiscard]] uint32_t getVSyncCount() const {
+        return mVSyncCount;
+    }
+
+    /**
+     * Rows passed to the last present().
+     */
+    [[nodiscard]] RowRange getLastPresentedRows(Screen screen) const {
+        return mLastPresentedRows[screen];
+    }
+
+    /**
+     * Rows that have been modified outside of the ranges passed to present().
+     */
+    [[nodiscard]] uint32_t getUnpresentedRowCount() const {
+        return mUnpresentedRowCount;
+    }
+
+private:
+    [[nodiscard]] uint32_t *getRow(Screen screen, uint32_t bufferIndex, uint32_t y) const {
+        const auto &surface = mSurfaces[screen];
+        return (uint32_t *) (surface.buffer + bufferIndex * (surface.size / 2)) + y * surface.pitch;
+    }
+
+    std::unique_ptr<uint8_t[]> mBuffers[2];
+    // Copy of each buffer as it was when it has been presented
+    std::unique_ptr<uint8_t[]> mPresented[2];
+    Surface mSurfaces[2]{};
+    uint32_t mVisibleTVWidth   = 0;
+    float mTVScale             = 1.5f;
+    uint32_t mFrontBufferIndex = 1;
+
+    uint32_t mPresentCount        = 0;
+    uint32_t mVSyncCount          = 0;
+    uint32_t mUnpresentedRowCount = 0;
+    RowRange mLastPresentedRows[2]{};
+};
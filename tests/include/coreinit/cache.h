@@ -0,0 +1,13 @@
+#pragma once
+
+#include <wut_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void DCFlushRange(void *addr, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
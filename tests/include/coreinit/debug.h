@@ -0,0 +1,15 @@
+#pragma once
+
+#include <wut_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void OSReport(const char *fmt, ...);
+
+void OSFatal(const char *msg);
+
+#ifdef __cplusplus
+}
+#endif
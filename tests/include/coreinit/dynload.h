@@ -0,0 +1,12 @@
+#pragma once
+
+#include <coreinit/thread.h>
+#include <wut_types.h>
+
+typedef void *OSDynLoad_Module;
+
+typedef enum OSDynLoad_Error {
+    OS_DYNLOAD_OK                   = 0,
+    OS_DYNLOAD_OUT_OF_MEMORY        = 0xBAD10002,
+    OS_DYNLOAD_INVALID_ALLOCATOR_PTR = 0xBAD1001C,
+} OSDynLoad_Error;
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <wut_types.h>
+
+typedef void *MEMHeapHandle;
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <wut_types.h>
+
+typedef enum OSSharedDataType {
+    OS_SHAREDDATATYPE_FONT_CHINESE   = 0,
+    OS_SHAREDDATATYPE_FONT_KOREAN    = 1,
+    OS_SHAREDDATATYPE_FONT_STANDARD  = 2,
+    OS_SHAREDDATATYPE_FONT_TAIWANESE = 3,
+} OSSharedDataType;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only the standard font is available on the host, see common/HostStubs.cpp
+BOOL OSGetSharedData(OSSharedDataType type, uint32_t unk_r4, void **outPtr, uint32_t *outSize);
+
+void OSMemoryBarrier();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <coreinit/time.h>
+#include <wut_types.h>
+
+typedef struct OSThread OSThread;
+
+typedef int (*OSThreadEntryPointFn)(int argc, const char **argv);
+
+struct OSThread {
+    // Host std::thread, or the entry point until the thread has been resumed
+    void *hostThread;
+    bool started;
+};
+
+enum OSThreadAttributes {
+    OS_THREAD_ATTRIB_AFFINITY_CPU0 = 1,
+    OS_THREAD_ATTRIB_AFFINITY_CPU1 = 2,
+    OS_THREAD_ATTRIB_AFFINITY_CPU2 = 4,
+    OS_THREAD_ATTRIB_AFFINITY_ANY  = 7,
+    OS_THREAD_ATTRIB_DETACHED      = 8,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BOOL OSCreateThread(OSThread *thread, OSThreadEntryPointFn entry, int32_t argc, char *argv, void *stack, uint32_t stackSize, int32_t priority, int attributes);
+
+int32_t OSResumeThread(OSThread *thread);
+
+BOOL OSJoinThread(OSThread *thread, int *threadResult);
+
+void OSSetThreadName(OSThread *thread, const char *name);
+
+void OSSleepTicks(OSTime ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <wut_types.h>
+
+typedef int64_t OSTime;
+typedef int64_t OSTick;
+
+// Same timer clock as the Wii U (bus clock / 4)
+#define OSTimerClockSpeed        62156250ll
+
+#define OSTicksToMicroseconds(t) (((t) * 8) / (OSTimerClockSpeed / 125000))
+#define OSTicksToMilliseconds(t) ((t) / (OSTimerClockSpeed / 1000))
+#define OSMicrosecondsToTicks(t) (((t) * (OSTimerClockSpeed / 125000)) / 8)
+#define OSMillisecondsToTicks(t) ((t) * (OSTimerClockSpeed / 1000))
+#define OSSecondsToTicks(t)      ((t) * OSTimerClockSpeed)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSTime OSGetTime();
+
+OSTime OSGetSystemTime();
+
+#ifdef __cplusplus
+}
+#endif
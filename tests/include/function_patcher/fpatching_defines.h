@@ -0,0 +1,40 @@
+#pragma once
+
+#include <wut_types.h>
+
+#define FUNCTION_REPLACEMENT_DATA_STRUCT_VERSION 0x00000002
+
+typedef enum function_replacement_library_type_t {
+    LIBRARY_COREINIT = 1,
+    LIBRARY_OTHER    = 0x7F,
+} function_replacement_library_type_t;
+
+typedef enum FunctionPatcherTargetProcess {
+    FP_TARGET_PROCESS_ALL = 0xFF,
+} FunctionPatcherTargetProcess;
+
+typedef enum FunctionPatcherFunctionType {
+    FUNCTION_PATCHER_REPLACE_BY_LIB_OR_ADDRESS = 0,
+} FunctionPatcherFunctionType;
+
+typedef enum FunctionPatcherStatus {
+    FUNCTION_PATCHER_RESULT_SUCCESS       = 0,
+    FUNCTION_PATCHER_RESULT_UNKNOWN_ERROR = -0x100,
+} FunctionPatcherStatus;
+
+typedef uint32_t PatchedFunctionHandle;
+
+typedef struct function_replacement_data_t {
+    uint32_t version;
+    FunctionPatcherFunctionType type;
+    // uint32_t on the console, addresses don't fit into it on the host
+    uintptr_t physicalAddr;
+    uintptr_t virtualAddr;
+    uintptr_t replaceAddr;
+    uint32_t *replaceCall;
+    FunctionPatcherTargetProcess targetProcess;
+    struct {
+        const char *function_name;
+        function_replacement_library_type_t library;
+    } ReplaceInRPL;
+} function_replacement_data_t;
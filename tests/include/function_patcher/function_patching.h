@@ -0,0 +1,16 @@
+#pragma once
+
+#include <function_patcher/fpatching_defines.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Functions can't be patched on the host, both fail
+FunctionPatcherStatus FunctionPatcher_AddFunctionPatch(function_replacement_data_t *function_data, PatchedFunctionHandle *outHandle, bool *outHasBeenPatched);
+
+FunctionPatcherStatus FunctionPatcher_RemoveFunctionPatch(PatchedFunctionHandle handle);
+
+#ifdef __cplusplus
+}
+#endif
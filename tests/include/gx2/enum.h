@@ -0,0 +1,17 @@
+#pragma once
+
+typedef enum GX2TVRenderMode {
+    GX2_TV_RENDER_MODE_STANDARD_480P = 1,
+    GX2_TV_RENDER_MODE_WIDE_480P     = 2,
+    GX2_TV_RENDER_MODE_WIDE_720P     = 3,
+    GX2_TV_RENDER_MODE_WIDE_1080P    = 5,
+} GX2TVRenderMode;
+
+typedef enum GX2SurfaceFormat {
+    GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8 = 0x1A,
+} GX2SurfaceFormat;
+
+typedef enum GX2BufferingMode {
+    GX2_BUFFERING_MODE_SINGLE = 1,
+    GX2_BUFFERING_MODE_DOUBLE = 2,
+} GX2BufferingMode;
@@ -0,0 +1,3 @@
+#pragma once
+
+#include <gx2/enum.h>
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <wut_types.h>
+
+// Only passed through to the config items, the content doesn't matter on the host
+typedef struct KPADStatus {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+} KPADStatus;
+
+typedef enum KPADError {
+    KPAD_ERROR_OK = 0,
+} KPADError;
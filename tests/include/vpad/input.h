@@ -0,0 +1,21 @@
+#pragma once
+
+#include <wut_types.h>
+
+// Only passed through to the config items, the content doesn't matter on the host
+typedef struct VPADStatus {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+} VPADStatus;
+
+typedef struct VPADTouchCalibrationParam {
+    uint16_t adjustX;
+    uint16_t adjustY;
+    float scaleX;
+    float scaleY;
+} VPADTouchCalibrationParam;
+
+typedef enum VPADReadError {
+    VPAD_READ_SUCCESS = 0,
+} VPADReadError;
@@ -0,0 +1,13 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int WHBLogPrintf(const char *fmt, ...);
+
+int WHBLogWritef(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
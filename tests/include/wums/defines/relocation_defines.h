@@ -0,0 +1,9 @@
+#pragma once
+
+#include <wut_types.h>
+
+typedef struct relocation_trampoline_entry_t {
+    uint32_t id;
+    uint32_t trampoline[4];
+    uint32_t status;
+} relocation_trampoline_entry_t;
@@ -0,0 +1,6 @@
+#pragma once
+
+// The tests call the functions directly
+#define WUMS_EXPORT_FUNCTION(function)
+#define WUMS_EXPORT_FUNCTION_EX(function, name)
+#define WUMS_EXPORT_DATA(data)
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <padscore/kpad.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <vpad/input.h>
+
+typedef enum WUPSConfigAPIStatus {
+    WUPSCONFIG_API_RESULT_SUCCESS                   = 0,
+    WUPSCONFIG_API_RESULT_INVALID_ARGUMENT          = -0x01,
+    WUPSCONFIG_API_RESULT_OUT_OF_MEMORY             = -0x03,
+    WUPSCONFIG_API_RESULT_NOT_FOUND                 = -0x06,
+    WUPSCONFIG_API_RESULT_INVALID_PLUGIN_IDENTIFIER = -0x70,
+    WUPSCONFIG_API_RESULT_MISSING_CALLBACK          = -0x71,
+    WUPSCONFIG_API_RESULT_MODULE_NOT_FOUND          = -0x80,
+    WUPSCONFIG_API_RESULT_MODULE_MISSING_EXPORT     = -0x81,
+    WUPSCONFIG_API_RESULT_UNSUPPORTED_VERSION       = -0x82,
+    WUPSCONFIG_API_RESULT_UNSUPPORTED_COMMAND       = -0x83,
+    WUPSCONFIG_API_RESULT_LIB_UNINITIALIZED         = -0x84,
+    WUPSCONFIG_API_RESULT_UNKNOWN_ERROR             = -0x100,
+} WUPSConfigAPIStatus;
+
+typedef enum WUPSConfigAPICallbackStatus {
+    WUPSCONFIG_API_CALLBACK_RESULT_SUCCESS = 0,
+    WUPSCONFIG_API_CALLBACK_RESULT_ERROR   = -1,
+} WUPSConfigAPICallbackStatus;
+
+typedef enum WUPS_CONFIG_SIMPLE_INPUT {
+    WUPS_CONFIG_BUTTON_NONE    = 0,
+    WUPS_CONFIG_BUTTON_LEFT    = (1 << 0),
+    WUPS_CONFIG_BUTTON_RIGHT   = (1 << 1),
+    WUPS_CONFIG_BUTTON_UP      = (1 << 2),
+    WUPS_CONFIG_BUTTON_DOWN    = (1 << 3),
+    WUPS_CONFIG_BUTTON_A       = (1 << 4),
+    WUPS_CONFIG_BUTTON_B       = (1 << 5),
+    WUPS_CONFIG_BUTTON_ZL      = (1 << 6),
+    WUPS_CONFIG_BUTTON_ZR      = (1 << 7),
+    WUPS_CONFIG_BUTTON_L       = (1 << 8),
+    WUPS_CONFIG_BUTTON_R       = (1 << 9),
+    WUPS_CONFIG_BUTTON_X       = (1 << 10),
+    WUPS_CONFIG_BUTTON_Y       = (1 << 11),
+    WUPS_CONFIG_BUTTON_STICK_L = (1 << 12),
+    WUPS_CONFIG_BUTTON_STICK_R = (1 << 13),
+    WUPS_CONFIG_BUTTON_PLUS    = (1 << 14),
+    WUPS_CONFIG_BUTTON_MINUS   = (1 << 15),
+} WUPS_CONFIG_SIMPLE_INPUT;
+
+typedef int32_t WUPSConfigButtons;
+
+typedef struct WUPSConfigSimplePadData {
+    WUPS_CONFIG_SIMPLE_INPUT buttons_h;
+    WUPS_CONFIG_SIMPLE_INPUT buttons_d;
+    WUPS_CONFIG_SIMPLE_INPUT buttons_r;
+    bool validPointer;
+    bool touched;
+    float pointerAngle;
+    int32_t x;
+    int32_t y;
+} WUPSConfigSimplePadData;
+
+typedef struct WUPSConfigComplexPadData {
+    struct {
+        VPADStatus data;
+        VPADTouchCalibrationParam tpCalib;
+        VPADReadError vpadError;
+    } vpad;
+    struct {
+        KPADStatus data[7];
+        KPADError kpadError[7];
+    } kpad;
+} WUPSConfigComplexPadData;
+
+#define WUPS_CONFIG_HANDLE(name)                                       \
+    struct name {                                                      \
+        void *handle;                                                  \
+        name() : handle(nullptr) {}                                    \
+        explicit name(void *handle) : handle(handle) {}                \
+        bool operator==(const name &other) const {                     \
+            return handle == other.handle;                             \
+        }                                                              \
+        bool operator==(const void *other) const {                     \
+            return handle == other;                                    \
+        }                                                              \
+    }
+
+WUPS_CONFIG_HANDLE(WUPSConfigHandle);
+WUPS_CONFIG_HANDLE(WUPSConfigCategoryHandle);
+WUPS_CONFIG_HANDLE(WUPSConfigItemHandle);
+
+typedef struct WUPSConfigAPIItemCallbacksV1 {
+    int32_t (*getCurrentValueDisplay)(void *context, char *out_buf, int32_t out_size);
+    int32_t (*getCurrentValueSelectedDisplay)(void *context, char *out_buf, int32_t out_size);
+    void (*onSelected)(void *context, bool isSelected);
+    void (*restoreDefault)(void *context);
+    bool (*isMovementAllowed)(void *context);
+    bool (*callCallback)(void *context);
+    void (*onButtonPressed)(void *context, WUPSConfigButtons button);
+    void (*onDelete)(void *context);
+} WUPSConfigAPIItemCallbacksV1;
+
+typedef struct WUPSConfigAPIItemCallbacksV2 {
+    int32_t (*getCurrentValueDisplay)(void *context, char *out_buf, int32_t out_size);
+    int32_t (*getCurrentValueSelectedDisplay)(void *context, char *out_buf, int32_t out_size);
+    void (*onSelected)(void *context, bool isSelected);
+    void (*restoreDefault)(void *context);
+    bool (*isMovementAllowed)(void *context);
+    void (*onCloseCallback)(void *context);
+    void (*onInput)(void *context, WUPSConfigSimplePadData input);
+    void (*onInputEx)(void *context, WUPSConfigComplexPadData input);
+    void (*onDelete)(void *context);
+} WUPSConfigAPIItemCallbacksV2;
+
+#define WUPS_API_ITEM_OPTION_VERSION_V1     1
+#define WUPS_API_ITEM_OPTION_VERSION_V2     2
+#define WUPS_API_CATEGORY_OPTION_VERSION_V1 1
+
+typedef struct WUPSConfigAPIItemOptionsV1 {
+    const char *configId;
+    const char *displayName;
+    void *context;
+    WUPSConfigAPIItemCallbacksV1 callbacks;
+} WUPSConfigAPIItemOptionsV1;
+
+typedef struct WUPSConfigAPIItemOptionsV2 {
+    const char *displayName;
+    void *context;
+    WUPSConfigAPIItemCallbacksV2 callbacks;
+} WUPSConfigAPIItemOptionsV2;
+
+typedef struct WUPSConfigAPICreateItemOptions {
+    uint32_t version;
+    union {
+        WUPSConfigAPIItemOptionsV1 v1;
+        WUPSConfigAPIItemOptionsV2 v2;
+    } data;
+} WUPSConfigAPICreateItemOptions;
+
+typedef struct WUPSConfigAPICreateCategoryOptionsV1 {
+    const char *name;
+} WUPSConfigAPICreateCategoryOptionsV1;
+
+typedef struct WUPSConfigAPICreateCategoryOptions {
+    uint32_t version;
+    union {
+        WUPSConfigAPICreateCategoryOptionsV1 v1;
+    } data;
+} WUPSConfigAPICreateCategoryOptions;
+
+typedef uint32_t WUPSConfigAPIVersion;
+
+typedef struct WUPSConfigAPIOptionsV1 {
+    const char *name;
+} WUPSConfigAPIOptionsV1;
+
+typedef struct WUPSConfigAPIOptions {
+    uint32_t version;
+    union {
+        WUPSConfigAPIOptionsV1 v1;
+    } data;
+} WUPSConfigAPIOptions;
+
+typedef WUPSConfigAPICallbackStatus (*WUPSConfigAPI_MenuOpenedCallback)(WUPSConfigCategoryHandle root);
+
+typedef void (*WUPSConfigAPI_MenuClosedCallback)();
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *WUPSConfigAPI_GetStatusStr(WUPSConfigAPIStatus status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <wups/config.h>
+
+typedef struct wups_loader_init_config_args_t {
+    uint32_t arg_version;
+    // uint32_t on the console, the backend passes the address of the plugin which doesn't fit into it on the host
+    uintptr_t plugin_identifier;
+} wups_loader_init_config_args_t;
@@ -0,0 +1,32 @@
+#pragma once
+
+typedef enum wups_loader_hook_type_t {
+    WUPS_LOADER_HOOK_INIT_WUT_MALLOC,
+    WUPS_LOADER_HOOK_FINI_WUT_MALLOC,
+    WUPS_LOADER_HOOK_INIT_WUT_NEWLIB,
+    WUPS_LOADER_HOOK_FINI_WUT_NEWLIB,
+    WUPS_LOADER_HOOK_INIT_WUT_STDCPP,
+    WUPS_LOADER_HOOK_FINI_WUT_STDCPP,
+    WUPS_LOADER_HOOK_INIT_WUT_DEVOPTAB,
+    WUPS_LOADER_HOOK_FINI_WUT_DEVOPTAB,
+    WUPS_LOADER_HOOK_INIT_WUT_SOCKETS,
+    WUPS_LOADER_HOOK_FINI_WUT_SOCKETS,
+
+    WUPS_LOADER_HOOK_INIT_WRAPPER,
+    WUPS_LOADER_HOOK_FINI_WRAPPER,
+
+    WUPS_LOADER_HOOK_GET_CONFIG_DEPRECATED,
+    WUPS_LOADER_HOOK_CONFIG_CLOSED_DEPRECATED,
+
+    WUPS_LOADER_HOOK_INIT_STORAGE_DEPRECATED,
+
+    WUPS_LOADER_HOOK_INIT_PLUGIN,
+    WUPS_LOADER_HOOK_DEINIT_PLUGIN,
+    WUPS_LOADER_HOOK_APPLICATION_STARTS,
+    WUPS_LOADER_HOOK_RELEASE_FOREGROUND,
+    WUPS_LOADER_HOOK_ACQUIRED_FOREGROUND,
+    WUPS_LOADER_HOOK_APPLICATION_REQUESTS_EXIT,
+    WUPS_LOADER_HOOK_APPLICATION_ENDS,
+    WUPS_LOADER_HOOK_INIT_STORAGE,
+    WUPS_LOADER_HOOK_INIT_CONFIG,
+} wups_loader_hook_type_t;
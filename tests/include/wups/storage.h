@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    WUPS_STORAGE_ERROR_SUCCESS                  = 0,
+    WUPS_STORAGE_ERROR_INVALID_ARGS             = -0x01,
+    WUPS_STORAGE_ERROR_MALLOC_FAILED            = -0x02,
+    WUPS_STORAGE_ERROR_UNEXPECTED_DATA_TYPE     = -0x03,
+    WUPS_STORAGE_ERROR_BUFFER_TOO_SMALL         = -0x04,
+    WUPS_STORAGE_ERROR_ALREADY_EXISTS           = -0x05,
+    WUPS_STORAGE_ERROR_IO_ERROR                 = -0x06,
+    WUPS_STORAGE_ERROR_NOT_FOUND                = -0x10,
+    WUPS_STORAGE_ERROR_INTERNAL_NOT_INITIALIZED = -0xF0,
+    WUPS_STORAGE_ERROR_INTERNAL_INVALID_VERSION = -0xF1,
+    WUPS_STORAGE_ERROR_UNKNOWN_ERROR            = -0x100,
+} WUPSStorageError;
+typedef enum {
+    WUPS_STORAGE_ITEM_S32    = 0,
+    WUPS_STORAGE_ITEM_S64    = 1,
+    WUPS_STORAGE_ITEM_U32    = 2,
+    WUPS_STORAGE_ITEM_U64    = 3,
+    WUPS_STORAGE_ITEM_STRING = 4,
+    WUPS_STORAGE_ITEM_BINARY = 5,
+    WUPS_STORAGE_ITEM_BOOL   = 6,
+    WUPS_STORAGE_ITEM_FLOAT  = 7,
+    WUPS_STORAGE_ITEM_DOUBLE = 8,
+} WUPSStorageItemTypes;
+typedef uint32_t WUPSStorageItemType;
+typedef void *wups_storage_root_item;
+typedef void *wups_storage_item;
+typedef uint32_t WUPS_STORAGE_API_VERSION;
+#define WUPS_STORAGE_CUR_API_VERSION 0x02
+typedef WUPSStorageError (*WUPSStorage_SaveFunction)(wups_storage_root_item root, bool force);
+typedef WUPSStorageError (*WUPSStorage_ForceReloadFunction)(wups_storage_root_item root);
+typedef WUPSStorageError (*WUPSStorage_WipeStorageFunction)(wups_storage_root_item root);
+typedef WUPSStorageError (*WUPSStorage_DeleteItemFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key);
+typedef WUPSStorageError (*WUPSStorage_CreateSubItemFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key, wups_storage_item *outHandle);
+typedef WUPSStorageError (*WUPSStorage_GetSubItemFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key, wups_storage_item *outHandle);
+typedef WUPSStorageError (*WUPSStorage_StoreItemFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t length);
+typedef WUPSStorageError (*WUPSStorage_GetItemFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, void *data, uint32_t maxSize, uint32_t *outSize);
+typedef WUPSStorageError (*WUPSStorage_GetItemSizeFunction)(wups_storage_root_item root, wups_storage_item parent, const char *key, WUPSStorageItemType itemType, uint32_t *outSize);
+typedef struct wups_loader_init_storage_args_t_ {
+    WUPS_STORAGE_API_VERSION version;
+    wups_storage_root_item root_item;
+    WUPSStorage_SaveFunction save_function_ptr;
+    WUPSStorage_ForceReloadFunction force_reload_function_ptr;
+    WUPSStorage_WipeStorageFunction wipe_storage_function_ptr;
+    WUPSStorage_DeleteItemFunction delete_item_function_ptr;
+    WUPSStorage_CreateSubItemFunction create_sub_item_function_ptr;
+    WUPSStorage_GetSubItemFunction get_sub_item_function_ptr;
+    WUPSStorage_StoreItemFunction store_item_function_ptr;
+    WUPSStorage_GetItemFunction get_item_function_ptr;
+    WUPSStorage_GetItemSizeFunction get_item_size_function_ptr;
+} wups_loader_init_storage_args_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+const char *WUPSStorageAPI_GetStatusStr(WUPSStorageError status);
+#ifdef __cplusplus
+}
+#endif
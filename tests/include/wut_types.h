@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int32_t BOOL;
+
+#define WUT_PACKED __attribute__((__packed__))
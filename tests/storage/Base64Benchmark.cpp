@@ -0,0 +1,52 @@
+#include "../common/TestUtils.h"
+#include "Base64Reference.h"
+#include "utils/base64.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Measures the throughput of utils/base64.cpp for small, medium and big values, Base64Reference is the baseline.
+ */
+namespace {
+    template<typename Fn>
+    double GetMegabytesPerSecond(size_t bytes, Fn &&fn) {
+        // Repeat until enough time has passed to get a stable number
+        uint64_t iterations = 0;
+        TestUtils::Stopwatch watch;
+        do {
+            fn();
+            iterations++;
+        } while (watch.elapsedNs() < 200000000);
+        return (double) bytes * iterations / ((double) watch.elapsedNs() / 1e9) / (1024 * 1024);
+    }
+
+    void Run(size_t size, std::mt19937 &rng) {
+        std::vector<uint8_t> data(size);
+        for (auto &b : data) {
+            b = rng();
+        }
+        std::string encoded;
+        std::vector<uint8_t> decoded;
+        b64_encode(data.data(), data.size(), encoded);
+
+        double encode          = GetMegabytesPerSecond(size, [&]() { b64_encode(data.data(), data.size(), encoded); });
+        double encodeReference = GetMegabytesPerSecond(size, [&]() { encoded = Base64Reference::Encode(data.data(), data.size()); });
+        double decode          = GetMegabytesPerSecond(size, [&]() { CHECK(b64_decode(encoded, decoded)); });
+        double decodeReference = GetMegabytesPerSecond(size, [&]() { CHECK(Base64Reference::Decode(encoded).has_value()); });
+        CHECK(decoded == data);
+
+        printf("  %8zu bytes  encode: %8.1f MiB/s (baseline %7.1f MiB/s)  decode: %8.1f MiB/s (baseline %7.1f MiB/s)\n",
+               size, encode, encodeReference, decode, decodeReference);
+    }
+} // namespace
+
+int main() {
+    std::mt19937 rng(1);
+    printf("base64 throughput (of the binary data)\n");
+    for (size_t size : {64, 4 * 1024, 1024 * 1024}) {
+        Run(size, rng);
+    }
+    return TestUtils::Finish("base64_benchmark");
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Straightforward per-char base64 codec used as the reference for the tests and as the baseline for the benchmark.
+ * It works like the codec utils/base64.cpp used before it was made table driven: it's strict about the alphabet
+ * and the padding, but ignores the unused bits of the last char.
+ */
+namespace Base64Reference {
+    constexpr char CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    inline std::string Encode(const uint8_t *in, size_t len) {
+        std::string out;
+        for (size_t i = 0; i < len; i += 3) {
+            uint32_t v = in[i] << 16;
+            v |= i + 1 < len ? in[i + 1] << 8 : 0;
+            v |= i + 2 < len ? in[i + 2] : 0;
+            out += CHARS[(v >> 18) & 0x3F];
+            out += CHARS[(v >> 12) & 0x3F];
+            out += i + 1 < len ? CHARS[(v >> 6) & 0x3F] : '=';
+            out += i + 2 < len ? CHARS[v & 0x3F] : '=';
+        }
+        return out;
+    }
+
+    inline int GetCharValue(char c) {
+        const char *pos = c ? strchr(CHARS, c) : nullptr;
+        return pos ? (int) (pos - CHARS) : -1;
+    }
+
+    /**
+     * Returns std::nullopt if the input is not valid base64.
+     */
+    inline std::optional<std::vector<uint8_t>> Decode(std::string_view in) {
+        if (in.size() % 4 != 0) {
+            return std::nullopt;
+        }
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < in.size(); i += 4) {
+            bool lastGroup = i + 4 == in.size();
+            // Padding is only allowed at the end of the last group
+            size_t padding = 0;
+            if (lastGroup && in[i + 3] == '=') {
+                padding = in[i + 2] == '=' ? 2 : 1;
+            }
+            uint32_t v = 0;
+            for (size_t j = 0; j < 4; j++) {
+                int c = j < 4 - padding ? GetCharValue(in[i + j]) : 0;
+                if (c < 0) {
+                    return std::nullopt;
+                }
+                v = (v << 6) | c;
+            }
+            out.push_back(v >> 16);
+            if (padding < 2) {
+                out.push_back(v >> 8);
+            }
+            if (padding < 1) {
+                out.push_back(v);
+            }
+        }
+        return out;
+    }
+} // namespace Base64Reference
@@ -0,0 +1,165 @@
+#include "../common/TestUtils.h"
+#include "Base64Reference.h"
+#include "utils/base64.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Round-trip and fuzz tests for utils/base64.cpp, the results are compared with Base64Reference.
+ *
+ * Usage: base64_test [--iterations N]
+ */
+namespace {
+    constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=";
+
+    void TestKnownValues() {
+        // RFC 4648, section 10
+        const std::pair<const char *, const char *> values[] = {
+                {"f", "Zg=="},
+                {"fo", "Zm8="},
+                {"foo", "Zm9v"},
+                {"foob", "Zm9vYg=="},
+                {"fooba", "Zm9vYmE="},
+                {"foobar", "Zm9vYmFy"},
+        };
+        for (const auto &[plain, encoded] : values) {
+            std::string out;
+            CHECK(b64_encode((const uint8_t *) plain, strlen(plain), out));
+            CHECK(out == encoded);
+
+            std::vector<uint8_t> decoded;
+            CHECK(b64_decode(encoded, decoded));
+            CHECK(std::string(decoded.begin(), decoded.end()) == plain);
+        }
+
+        // Empty input can't be encoded and decodes to nothing
+        std::string out;
+        CHECK(!b64_encode((const uint8_t *) "", 0, out));
+        CHECK(b64_encode(nullptr, 0) == nullptr);
+        std::vector<uint8_t> decoded = {1, 2, 3};
+        CHECK(b64_decode("", decoded));
+        CHECK(decoded.empty());
+    }
+
+    void TestRoundTrip(std::mt19937 &rng) {
+        // All lengths around the group size and the word-at-a-time loops, plus some bigger ones
+        std::vector<size_t> lengths;
+        for (size_t len = 1; len <= 64; len++) {
+            lengths.push_back(len);
+        }
+        for (size_t len : {255, 256, 257, 4095, 4096, 4097, 65536 + 1}) {
+            lengths.push_back(len);
+        }
+
+        for (auto len : lengths) {
+            std::vector<uint8_t> data(len);
+            for (auto &b : data) {
+                b = rng();
+            }
+            auto expected = Base64Reference::Encode(data.data(), data.size());
+
+            std::string encoded;
+            CHECK(b64_encode(data.data(), data.size(), encoded));
+            CHECK(encoded == expected);
+            CHECK(encoded.size() == b64_encoded_size(len));
+
+            char *encodedC = b64_encode(data.data(), data.size());
+            CHECK(encodedC != nullptr && encoded == encodedC);
+            free(encodedC);
+
+            std::vector<uint8_t> decoded;
+            CHECK(b64_decode(encoded, decoded));
+            CHECK(decoded == data);
+
+            // The C API decodes into a buffer, it must not write past the decoded size
+            CHECK(b64_decoded_size(encoded.c_str()) == len);
+            std::vector<uint8_t> buffer(len + 4, 0xAB);
+            CHECK(b64_decode(encoded.c_str(), buffer.data(), len) == 1);
+            CHECK(memcmp(buffer.data(), data.data(), len) == 0);
+            CHECK(buffer[len] == 0xAB);
+            CHECK(b64_decode(encoded.c_str(), buffer.data(), len - 1) == 0);
+        }
+    }
+
+    /**
+     * Decodes random strings (mostly made of base64 chars) and mutated valid strings, the decoder has to accept exactly
+     * the strings the reference accepts and return the same data.
+     */
+    void TestFuzz(std::mt19937 &rng, uint32_t iterations) {
+        uint32_t accepted = 0;
+        for (uint32_t i = 0; i < iterations; i++) {
+            std::string input;
+            if (i % 2 == 0) {
+                size_t len = rng() % 24;
+                for (size_t j = 0; j < len; j++) {
+                    // Mostly valid chars, sometimes anything
+                    input += rng() % 16 ? ALPHABET[rng() % (sizeof(ALPHABET) - 1)] : (char) rng();
+                }
+            } else {
+                std::vector<uint8_t> data(1 + rng() % 32);
+                for (auto &b : data) {
+                    b = rng();
+                }
+                input = Base64Reference::Encode(data.data(), data.size());
+                for (uint32_t mutations = rng() % 3; mutations > 0; mutations--) {
+                    auto pos = rng() % input.size();
+                    switch (rng() % 3) {
+                        case 0:
+                            input[pos] = ALPHABET[rng() % (sizeof(ALPHABET) - 1)];
+                            break;
+                        case 1:
+                            input[pos] = (char) rng();
+                            break;
+                        default:
+                            input.erase(pos, 1);
+                            break;
+                    }
+                }
+            }
+
+            auto expected = Base64Reference::Decode(input);
+            std::vector<uint8_t> decoded;
+            bool res = b64_decode(input, decoded);
+            CHECK(res == expected.has_value());
+            if (res && expected) {
+                CHECK(decoded == *expected);
+                accepted++;
+            } else {
+                CHECK(decoded.empty());
+            }
+
+            // The C API stops at the first \0, only compare it for strings without one
+            if (input.find('\0') == std::string::npos) {
+                size_t size = b64_decoded_size(input.c_str());
+                std::vector<uint8_t> buffer(size + 1);
+                int resC = b64_decode(input.c_str(), buffer.data(), size);
+                CHECK((resC == 1) == expected.has_value());
+                if (resC && expected) {
+                    CHECK(size == expected->size() && memcmp(buffer.data(), expected->data(), size) == 0);
+                }
+            }
+        }
+        // Make sure the fuzzer actually produces valid input as well
+        CHECK(accepted > iterations / 8);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 200000;
+    if (argc == 3 && strcmp(argv[1], "--iterations") == 0) {
+        iterations = strtoul(argv[2], nullptr, 10);
+    } else if (argc != 1) {
+        printf("Usage: %s [--iterations N]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(1);
+    TestKnownValues();
+    TestRoundTrip(rng);
+    TestFuzz(rng, iterations);
+
+    return TestUtils::Finish("base64_test");
+}
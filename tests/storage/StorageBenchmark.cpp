@@ -0,0 +1,308 @@
+#include "../common/TestUtils.h"
+#include "utils/storage/StorageCache.h"
+#include "utils/storage/StorageUtils.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Benchmarks the StorageUtils::API on synthetic trees.
+ *
+ * Usage: storage_benchmark [--items N[,N...]] [--threads N] [--ops N]
+ *
+ * For every tree shape and item count the storage is created from scratch, saved, closed and opened again.
+ * Latency percentiles and operator new calls per operation are reported for every phase.
+ * With --threads, the threads additionally hammer a shared root and one root per thread with 90% gets / 10% stores.
+ */
+namespace {
+    using namespace StorageUtils::API;
+
+    // Deep trees spread their items over a chain of nested sub items
+    constexpr uint32_t DEEP_TREE_DEPTH = 64;
+    // Binary heavy trees store small binary values, every BLOB_INTERVAL-th item is big enough to become a blob file
+    constexpr uint32_t BINARY_ITEM_SIZE = 64;
+    constexpr uint32_t BLOB_ITEM_SIZE   = 8 * 1024;
+    constexpr uint32_t BLOB_INTERVAL    = 256;
+
+    enum TreeShape {
+        TREE_FLAT,
+        TREE_DEEP,
+        TREE_BINARY,
+    };
+
+    const char *GetShapeName(TreeShape shape) {
+        switch (shape) {
+            case TREE_FLAT:
+                return "flat";
+            case TREE_DEEP:
+                return "deep";
+            case TREE_BINARY:
+                return "binary-heavy";
+        }
+        return "unknown";
+    }
+
+    /**
+     * Latency and operator new calls of the operations of one benchmark phase.
+     */
+    class Phase {
+    public:
+        explicit Phase(const char *name) : mName(name) {
+        }
+
+        template<typename Fn>
+        void run(Fn &&fn) {
+            uint64_t allocations = TestUtils::GetAllocationCount();
+            TestUtils::Stopwatch watch;
+            fn();
+            mStats.add(watch.elapsedNs());
+            mAllocations += TestUtils::GetAllocationCount() - allocations;
+            mOps++;
+        }
+
+        void print() {
+            mStats.print(mName);
+            printf("  %-28s allocations: %.2f per op\n", "", mOps ? (double) mAllocations / (double) mOps : 0.0);
+        }
+
+    private:
+        const char *mName;
+        uint64_t mAllocations = 0;
+        uint64_t mOps         = 0;
+        TestUtils::LatencyStats mStats;
+    };
+
+    std::string GetKey(uint32_t index) {
+        return "item_" + std::to_string(index);
+    }
+
+    /**
+     * Returns the parent of every item index, for deep trees the chain of sub items is created on the first call.
+     */
+    std::vector<wups_storage_item> GetParents(wups_storage_root_item root, TreeShape shape, bool create) {
+        std::vector<wups_storage_item> parents = {nullptr};
+        if (shape != TREE_DEEP) {
+            return parents;
+        }
+        wups_storage_item parent = nullptr;
+        for (uint32_t depth = 0; depth < DEEP_TREE_DEPTH; depth++) {
+            wups_storage_item child = nullptr;
+            if (create) {
+                CHECK_STATUS(CreateSubItem(root, parent, "level", &child), WUPS_STORAGE_ERROR_SUCCESS);
+            } else {
+                CHECK_STATUS(GetSubItem(root, parent, "level", &child), WUPS_STORAGE_ERROR_SUCCESS);
+            }
+            parent = child;
+            parents.push_back(parent);
+        }
+        return parents;
+    }
+
+    WUPSStorageError StoreValue(wups_storage_root_item root, wups_storage_item parent, TreeShape shape, uint32_t index, uint32_t value, std::vector<uint8_t> &buffer) {
+        auto key = GetKey(index);
+        if (shape == TREE_BINARY) {
+            buffer.resize(index % BLOB_INTERVAL == 0 ? BLOB_ITEM_SIZE : BINARY_ITEM_SIZE);
+            memset(buffer.data(), (int) (value & 0xFF), buffer.size());
+            return StoreItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_BINARY, buffer.data(), buffer.size());
+        }
+        if (index % 2 == 0) {
+            return StoreItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value));
+        }
+        auto str = "value_" + std::to_string(value);
+        return StoreItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_STRING, str.data(), str.size());
+    }
+
+    WUPSStorageError GetValue(wups_storage_root_item root, wups_storage_item parent, TreeShape shape, uint32_t index, std::vector<uint8_t> &buffer) {
+        auto key = GetKey(index);
+        if (shape == TREE_BINARY) {
+            buffer.resize(BLOB_ITEM_SIZE);
+            uint32_t outSize = 0;
+            return GetItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_BINARY, buffer.data(), buffer.size(), &outSize);
+        }
+        if (index % 2 == 0) {
+            uint32_t value;
+            return GetItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value), nullptr);
+        }
+        char str[32];
+        return GetItem(root, parent, key.c_str(), WUPS_STORAGE_ITEM_STRING, str, sizeof(str), nullptr);
+    }
+
+    wups_storage_root_item Open(const std::string &pluginId, Phase &phase) {
+        wups_storage_root_item root = nullptr;
+        phase.run([&]() { CHECK_STATUS(Internal::OpenStorage(pluginId, root), WUPS_STORAGE_ERROR_SUCCESS); });
+        return root;
+    }
+
+    void Close(wups_storage_root_item root, Phase &phase) {
+        phase.run([&]() { CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS); });
+    }
+
+    void RunSingleThreaded(TreeShape shape, uint32_t itemCount, uint32_t opCount) {
+        printf("%s tree, %u items\n", GetShapeName(shape), itemCount);
+        std::string pluginId = std::string("bench_") + GetShapeName(shape) + "_" + std::to_string(itemCount);
+        std::mt19937 rng(itemCount);
+        std::vector<uint8_t> buffer;
+
+        Phase openEmpty("open (new)");
+        auto root = Open(pluginId, openEmpty);
+        CHECK_STATUS(WipeStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+        auto parents = GetParents(root, shape, true);
+
+        Phase storeNew("store (new item)");
+        for (uint32_t i = 0; i < itemCount; i++) {
+            storeNew.run([&]() { CHECK_STATUS(StoreValue(root, parents[i % parents.size()], shape, i, i, buffer), WUPS_STORAGE_ERROR_SUCCESS); });
+        }
+
+        Phase save("save");
+        save.run([&]() { CHECK_STATUS(SaveStorage(root, true), WUPS_STORAGE_ERROR_SUCCESS); });
+        Phase close("close");
+        Close(root, close);
+
+        // Make sure the next open has to parse the file
+        StorageCache::Take(pluginId);
+        Phase openFile("open (file)");
+        root    = Open(pluginId, openFile);
+        parents = GetParents(root, shape, false);
+
+        Phase get("get");
+        for (uint32_t i = 0; i < opCount; i++) {
+            uint32_t index = rng() % itemCount;
+            get.run([&]() { CHECK_STATUS(GetValue(root, parents[index % parents.size()], shape, index, buffer), WUPS_STORAGE_ERROR_SUCCESS); });
+        }
+
+        Phase storeUpdate("store (update)");
+        for (uint32_t i = 0; i < opCount; i++) {
+            uint32_t index = rng() % itemCount;
+            storeUpdate.run([&]() { CHECK_STATUS(StoreValue(root, parents[index % parents.size()], shape, index, i, buffer), WUPS_STORAGE_ERROR_SUCCESS); });
+        }
+
+        save.run([&]() { CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS); });
+        Close(root, close);
+
+        Phase openCache("open (cache)");
+        root = Open(pluginId, openCache);
+        Close(root, close);
+
+        openEmpty.print();
+        storeNew.print();
+        save.print();
+        close.print();
+        openFile.print();
+        get.print();
+        storeUpdate.print();
+        openCache.print();
+    }
+
+    /**
+     * Every thread runs opCount operations with 90% gets / 10% stores on the given roots.
+     */
+    void RunContention(uint32_t threadCount, uint32_t itemCount, uint32_t opCount, bool sharedRoot) {
+        std::vector<wups_storage_root_item> roots(sharedRoot ? 1 : threadCount);
+        for (uint32_t i = 0; i < roots.size(); i++) {
+            CHECK_STATUS(Internal::OpenStorage("bench_mt_" + std::to_string(i), roots[i]), WUPS_STORAGE_ERROR_SUCCESS);
+            CHECK_STATUS(WipeStorage(roots[i]), WUPS_STORAGE_ERROR_SUCCESS);
+            std::vector<uint8_t> buffer;
+            for (uint32_t j = 0; j < itemCount; j++) {
+                CHECK_STATUS(StoreValue(roots[i], nullptr, TREE_FLAT, j, j, buffer), WUPS_STORAGE_ERROR_SUCCESS);
+            }
+        }
+
+        std::vector<TestUtils::LatencyStats> getStats(threadCount);
+        std::vector<TestUtils::LatencyStats> storeStats(threadCount);
+        TestUtils::Stopwatch total;
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t]() {
+                auto root = roots[sharedRoot ? 0 : t];
+                std::mt19937 rng(t);
+                std::vector<uint8_t> buffer;
+                for (uint32_t i = 0; i < opCount; i++) {
+                    uint32_t index = rng() % itemCount;
+                    TestUtils::Stopwatch watch;
+                    if (rng() % 10 == 0) {
+                        CHECK_STATUS(StoreValue(root, nullptr, TREE_FLAT, index, i, buffer), WUPS_STORAGE_ERROR_SUCCESS);
+                        storeStats[t].add(watch.elapsedNs());
+                    } else {
+                        CHECK_STATUS(GetValue(root, nullptr, TREE_FLAT, index, buffer), WUPS_STORAGE_ERROR_SUCCESS);
+                        getStats[t].add(watch.elapsedNs());
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double seconds = (double) total.elapsedNs() / 1e9;
+
+        printf("%u threads, %s, %u items per root\n", threadCount, sharedRoot ? "one shared root" : "one root per thread", itemCount);
+        printf("  %-28s %.0f ops/s\n", "throughput", (double) threadCount * opCount / seconds);
+        TestUtils::LatencyStats gets;
+        TestUtils::LatencyStats stores;
+        // Merge the per thread stats, the threads are done
+        for (uint32_t t = 0; t < threadCount; t++) {
+            gets.merge(getStats[t]);
+            stores.merge(storeStats[t]);
+        }
+        gets.print("get");
+        stores.print("store (update)");
+
+        for (auto root : roots) {
+            CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+        }
+    }
+
+    std::vector<uint32_t> ParseList(const char *arg) {
+        std::vector<uint32_t> res;
+        const char *cur = arg;
+        while (*cur) {
+            char *end = nullptr;
+            auto val  = strtoul(cur, &end, 10);
+            if (end == cur) {
+                break;
+            }
+            res.push_back(val);
+            cur = *end == ',' ? end + 1 : end;
+        }
+        return res;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<uint32_t> itemCounts = {1000, 10000, 100000};
+    uint32_t threadCount             = 0;
+    uint32_t opCount                 = 20000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--items") == 0) {
+            itemCounts = ParseList(argv[i + 1]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            threadCount = strtoul(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--ops") == 0) {
+            opCount = strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            printf("Usage: %s [--items N[,N...]] [--threads N] [--ops N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TestUtils::CreateTempPluginPath();
+    // The quotas are meant for plugins, not for 100k item trees
+    Internal::SetQuotas(0, 0);
+
+    for (auto itemCount : itemCounts) {
+        for (auto shape : {TREE_FLAT, TREE_DEEP, TREE_BINARY}) {
+            RunSingleThreaded(shape, itemCount, opCount);
+        }
+    }
+    if (threadCount > 0) {
+        for (uint32_t threads = 1; threads <= threadCount; threads *= 2) {
+            RunContention(threads, itemCounts.front(), opCount, true);
+            RunContention(threads, itemCounts.front(), opCount, false);
+        }
+    }
+
+    TestUtils::RemoveTempPluginPath();
+    return TestUtils::Finish("storage_benchmark");
+}
@@ -0,0 +1,211 @@
+#include "../common/TestUtils.h"
+#include "utils/storage/StorageSubItem.h"
+
+#include <cstring>
+#include <forward_list>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Benchmarks the StorageItemMap based children of StorageSubItem on wide (many keys in one sub item) and deep
+ * (long chains of nested sub items) trees.
+ *
+ * Usage: storage_item_map_benchmark [--keys N] [--depth N]
+ *
+ * The wide benchmark also runs the same lookups on the containers StorageSubItem used before (a std::map<std::string, ...>
+ * for items and a std::forward_list searched by key for sub items) as a baseline.
+ */
+namespace {
+    constexpr uint32_t ITEMS_PER_LEVEL = 10;
+    constexpr uint32_t DELETE_COUNT    = 1000;
+
+    template<typename Fn>
+    void Measure(const char *name, uint32_t opCount, Fn &&fn) {
+        uint64_t allocations = TestUtils::GetAllocationCount();
+        TestUtils::Stopwatch watch;
+        fn();
+        uint64_t durationNs = watch.elapsedNs();
+        allocations         = TestUtils::GetAllocationCount() - allocations;
+        printf("  %-36s %9.1f ns/op %7.2f allocations/op\n", name, (double) durationNs / opCount, (double) allocations / opCount);
+    }
+
+    std::vector<std::string> GetKeys(const char *prefix, uint32_t count) {
+        std::vector<std::string> res;
+        res.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            res.push_back(prefix + std::to_string(i));
+        }
+        return res;
+    }
+
+    std::vector<uint32_t> GetRandomIndices(uint32_t count, uint32_t seed) {
+        std::vector<uint32_t> res(count);
+        std::mt19937 rng(seed);
+        for (auto &index : res) {
+            index = rng() % count;
+        }
+        return res;
+    }
+
+    void RunWide(uint32_t keyCount) {
+        printf("wide: %u items and %u sub items in one sub item\n", keyCount, keyCount);
+        auto itemKeys    = GetKeys("item_", keyCount);
+        auto subItemKeys = GetKeys("sub_item_", keyCount);
+        auto missingKeys = GetKeys("missing_", keyCount);
+        auto indices     = GetRandomIndices(keyCount, 1);
+        StorageSubItem root("root");
+        StorageSubItem::StorageSubItemError error = StorageSubItem::STORAGE_SUB_ITEM_ERROR_NONE;
+        uint32_t found                            = 0;
+
+        Measure("createItem", keyCount, [&]() {
+            for (const auto &key : itemKeys) {
+                CHECK(root.createItem(key, error) != nullptr);
+            }
+        });
+        Measure("createSubItem", keyCount, [&]() {
+            for (const auto &key : subItemKeys) {
+                CHECK(root.createSubItem(key, error) != nullptr);
+            }
+        });
+        Measure("getItem (hit)", keyCount, [&]() {
+            for (auto index : indices) {
+                found += root.getItem(itemKeys[index].c_str()) != nullptr;
+            }
+        });
+        Measure("getItem (miss)", keyCount, [&]() {
+            for (const auto &key : missingKeys) {
+                found += root.getItem(key.c_str()) != nullptr;
+            }
+        });
+        Measure("getSubItem by key (hit)", keyCount, [&]() {
+            for (auto index : indices) {
+                found += root.getSubItem(std::string_view(subItemKeys[index])) != nullptr;
+            }
+        });
+        CHECK(found == keyCount * 2);
+
+        // Children have to keep the insertion order, the storage file is written in this order.
+        uint32_t i = 0;
+        for (const auto &item : root.getItems()) {
+            CHECK(i < keyCount && item.getKey() == itemKeys[i]);
+            i++;
+        }
+        CHECK(i == keyCount);
+
+        Measure("deleteItem", DELETE_COUNT, [&]() {
+            for (uint32_t j = 0; j < DELETE_COUNT; j++) {
+                CHECK(root.deleteItem(itemKeys[j * (keyCount / DELETE_COUNT)]));
+            }
+        });
+        CHECK(root.getItems().size() == keyCount - DELETE_COUNT);
+
+        // Baseline: the containers StorageSubItem used before, looked up by const char * like the storage API does.
+        std::map<std::string, StorageItem> oldItems;
+        std::forward_list<StorageSubItem> oldSubItems;
+        Measure("baseline: std::map insert", keyCount, [&]() {
+            for (const auto &key : itemKeys) {
+                oldItems.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(key));
+            }
+        });
+        Measure("baseline: std::forward_list insert", keyCount, [&]() {
+            for (const auto &key : subItemKeys) {
+                oldSubItems.emplace_front(key);
+            }
+        });
+        found = 0;
+        Measure("baseline: std::map find (hit)", keyCount, [&]() {
+            for (auto index : indices) {
+                found += oldItems.find(itemKeys[index].c_str()) != oldItems.end();
+            }
+        });
+        Measure("baseline: std::map find (miss)", keyCount, [&]() {
+            for (const auto &key : missingKeys) {
+                found += oldItems.find(key.c_str()) != oldItems.end();
+            }
+        });
+        Measure("baseline: std::forward_list search", keyCount, [&]() {
+            for (auto index : indices) {
+                const char *key = subItemKeys[index].c_str();
+                for (const auto &cur : oldSubItems) {
+                    if (cur.getKey() == key) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        });
+        CHECK(found == keyCount * 2);
+    }
+
+    void RunDeep(uint32_t depth) {
+        printf("deep: chain of %u nested sub items with %u items each\n", depth, ITEMS_PER_LEVEL);
+        auto itemKeys = GetKeys("item_", ITEMS_PER_LEVEL);
+        StorageSubItem root("root");
+        StorageSubItem::StorageSubItemError error = StorageSubItem::STORAGE_SUB_ITEM_ERROR_NONE;
+
+        StorageSubItem *leaf = nullptr;
+        Measure("build (per level)", depth, [&]() {
+            StorageSubItem *cur = &root;
+            for (uint32_t level = 0; level < depth; level++) {
+                for (const auto &key : itemKeys) {
+                    CHECK(cur->createItem(key, error) != nullptr);
+                }
+                cur = cur->createSubItem("child", error);
+                CHECK(cur != nullptr);
+                if (!cur) {
+                    return;
+                }
+            }
+            leaf = cur;
+        });
+        if (!leaf) {
+            return;
+        }
+
+        constexpr uint32_t WALKS = 100;
+        Measure("walk root to leaf (per level)", WALKS * depth, [&]() {
+            for (uint32_t walk = 0; walk < WALKS; walk++) {
+                StorageSubItem *cur = &root;
+                for (uint32_t level = 0; level < depth && cur; level++) {
+                    CHECK(cur->getItem(itemKeys[level % ITEMS_PER_LEVEL]) != nullptr);
+                    cur = cur->getSubItem(std::string_view("child"));
+                }
+                CHECK(cur == leaf);
+            }
+        });
+
+        // Handles are resolved by searching the whole tree, the leaf is the worst case.
+        Measure("getSubItem by handle (leaf)", 10, [&]() {
+            for (uint32_t i = 0; i < 10; i++) {
+                CHECK(root.getSubItem((wups_storage_item) leaf->getHandle()) == leaf);
+            }
+        });
+        Measure("getTreeMemoryUsage", 10, [&]() {
+            for (uint32_t i = 0; i < 10; i++) {
+                CHECK(root.getTreeMemoryUsage() > 0);
+            }
+        });
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t keyCount = 10000;
+    uint32_t depth    = 1000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--keys") == 0) {
+            keyCount = std::max<uint32_t>(strtoul(argv[i + 1], nullptr, 10), DELETE_COUNT);
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            depth = strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            printf("Usage: %s [--keys N] [--depth N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    RunWide(keyCount);
+    RunDeep(depth);
+
+    return TestUtils::Finish("storage_item_map_benchmark");
+}
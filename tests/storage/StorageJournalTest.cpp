@@ -0,0 +1,307 @@
+#include "../common/TestUtils.h"
+#include "utils/storage/StorageCache.h"
+#include "utils/storage/StorageUtils.h"
+#include "utils/utils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Recovery tests for the storage journal.
+ *
+ * A crash is simulated by copying the snapshot and the journal of an open storage to a new plugin id, the storage is
+ * never closed, so the journal never gets compacted. Opening the copy has to replay the journal.
+ *
+ * The first line of a journal is its header, every save after it appends one line per record.
+ */
+namespace {
+    using namespace StorageUtils::API;
+
+    constexpr uint32_t VALUE_MISSING = 0xFFFFFFFF;
+
+    std::string GetFilePath(const std::string &pluginId, const char *extension) {
+        return getPluginPath() + "/config/" + pluginId + extension;
+    }
+
+    uintmax_t GetFileSize(const std::string &path) {
+        std::error_code ec;
+        auto res = std::filesystem::file_size(path, ec);
+        return ec ? 0 : res;
+    }
+
+    std::string ReadFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream res;
+        res << file.rdbuf();
+        return res.str();
+    }
+
+    void WriteFile(const std::string &path, const std::string &data) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << data;
+    }
+
+    /**
+     * Copies the files of the (still open) storage to a new plugin id, like they would be found after a crash.
+     */
+    void SimulateCrash(const std::string &pluginId, const std::string &crashedId) {
+        std::filesystem::copy_file(GetFilePath(pluginId, ".json"), GetFilePath(crashedId, ".json"), std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::copy_file(GetFilePath(pluginId, ".journal"), GetFilePath(crashedId, ".journal"), std::filesystem::copy_options::overwrite_existing);
+    }
+
+    uint32_t GetU32(wups_storage_root_item root, wups_storage_item parent, const char *key) {
+        uint32_t value = VALUE_MISSING;
+        if (GetItem(root, parent, key, WUPS_STORAGE_ITEM_U32, &value, sizeof(value), nullptr) != WUPS_STORAGE_ERROR_SUCCESS) {
+            return VALUE_MISSING;
+        }
+        return value;
+    }
+
+    void StoreU32(wups_storage_root_item root, wups_storage_item parent, const char *key, uint32_t value) {
+        CHECK_STATUS(StoreItem(root, parent, key, WUPS_STORAGE_ITEM_U32, &value, sizeof(value)), WUPS_STORAGE_ERROR_SUCCESS);
+    }
+
+    /**
+     * Opens a storage with a snapshot containing "value" = 0. Each of the following saves stores "value" = 1, 2, ...
+     * and appends one record to the journal (after the header).
+     */
+    wups_storage_root_item CreateJournal(const std::string &pluginId, uint32_t recordCount) {
+        wups_storage_root_item root = nullptr;
+        CHECK_STATUS(Internal::OpenStorage(pluginId, root), WUPS_STORAGE_ERROR_SUCCESS);
+        StoreU32(root, nullptr, "value", 0);
+        CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath(pluginId, ".journal")) == 0);
+        for (uint32_t i = 1; i <= recordCount; i++) {
+            StoreU32(root, nullptr, "value", i);
+            CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+        }
+        return root;
+    }
+
+    std::vector<std::string> SplitLines(const std::string &data) {
+        std::vector<std::string> res;
+        size_t start = 0;
+        while (start < data.size()) {
+            auto end = data.find('\n', start);
+            end      = end == std::string::npos ? data.size() : end + 1;
+            res.push_back(data.substr(start, end - start));
+            start = end;
+        }
+        return res;
+    }
+
+    /**
+     * Opens the crashed storage, checks "value", saves it and checks that the broken journal has been compacted.
+     */
+    void CheckRecovered(const std::string &crashedId, uint32_t expectedValue) {
+        wups_storage_root_item root = nullptr;
+        CHECK_STATUS(Internal::OpenStorage(crashedId, root), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(root, nullptr, "value") == expectedValue);
+
+        // Records appended after a broken one would never be replayed, so the next save has to write a snapshot.
+        StoreU32(root, nullptr, "after", 1);
+        CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath(crashedId, ".journal")) == 0);
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take(crashedId);
+
+        CHECK_STATUS(Internal::OpenStorage(crashedId, root), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(root, nullptr, "value") == expectedValue);
+        CHECK(GetU32(root, nullptr, "after") == 1);
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take(crashedId);
+    }
+
+    void TestReplayAfterCrash() {
+        wups_storage_root_item root = CreateJournal("replay", 0);
+
+        // Every kind of record: stores of all types, created sub items and deletions
+        wups_storage_item sub  = nullptr;
+        wups_storage_item deep = nullptr;
+        CHECK_STATUS(CreateSubItem(root, nullptr, "sub", &sub), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK_STATUS(CreateSubItem(root, sub, "deep", &deep), WUPS_STORAGE_ERROR_SUCCESS);
+        StoreU32(root, sub, "u32", 1234);
+        int64_t s64 = -5;
+        CHECK_STATUS(StoreItem(root, deep, "s64", WUPS_STORAGE_ITEM_S64, &s64, sizeof(s64)), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK_STATUS(StoreItem(root, deep, "string", WUPS_STORAGE_ITEM_STRING, (void *) "text", 4), WUPS_STORAGE_ERROR_SUCCESS);
+        uint8_t binary[] = {0, 1, 2, 3, 0xFF};
+        CHECK_STATUS(StoreItem(root, deep, "binary", WUPS_STORAGE_ITEM_BINARY, binary, sizeof(binary)), WUPS_STORAGE_ERROR_SUCCESS);
+        StoreU32(root, nullptr, "deleted", 1);
+        CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK_STATUS(DeleteItem(root, nullptr, "deleted"), WUPS_STORAGE_ERROR_SUCCESS);
+        StoreU32(root, nullptr, "value", 2);
+        CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+
+        // The snapshot must not have been rewritten
+        auto journalSize = GetFileSize(GetFilePath("replay", ".journal"));
+        CHECK(journalSize > 0);
+        SimulateCrash("replay", "replay_crashed");
+
+        wups_storage_root_item crashed = nullptr;
+        CHECK_STATUS(Internal::OpenStorage("replay_crashed", crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, nullptr, "value") == 2);
+        CHECK(GetU32(crashed, nullptr, "deleted") == VALUE_MISSING);
+        CHECK_STATUS(GetSubItem(crashed, nullptr, "sub", &sub), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK_STATUS(GetSubItem(crashed, sub, "deep", &deep), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, sub, "u32") == 1234);
+        int64_t s64Read = 0;
+        CHECK_STATUS(GetItem(crashed, deep, "s64", WUPS_STORAGE_ITEM_S64, &s64Read, sizeof(s64Read), nullptr), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(s64Read == s64);
+        char string[16] = {};
+        CHECK_STATUS(GetItem(crashed, deep, "string", WUPS_STORAGE_ITEM_STRING, string, sizeof(string), nullptr), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(strcmp(string, "text") == 0);
+        uint8_t binaryRead[sizeof(binary)] = {};
+        uint32_t binarySize                = 0;
+        CHECK_STATUS(GetItem(crashed, deep, "binary", WUPS_STORAGE_ITEM_BINARY, binaryRead, sizeof(binaryRead), &binarySize), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(binarySize == sizeof(binary) && memcmp(binary, binaryRead, sizeof(binary)) == 0);
+
+        // A valid journal is kept until the storage gets closed, the next save just appends to it
+        CHECK(GetFileSize(GetFilePath("replay_crashed", ".journal")) == journalSize);
+        StoreU32(crashed, nullptr, "value", 3);
+        CHECK_STATUS(SaveStorage(crashed, false), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath("replay_crashed", ".journal")) > journalSize);
+
+        // Closing compacts the journal into the snapshot
+        CHECK_STATUS(Internal::CloseStorage(crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath("replay_crashed", ".journal")) == 0);
+        StorageCache::Take("replay_crashed");
+        CHECK_STATUS(Internal::OpenStorage("replay_crashed", crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, nullptr, "value") == 3);
+        CHECK_STATUS(GetSubItem(crashed, nullptr, "sub", &sub), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, sub, "u32") == 1234);
+        CHECK_STATUS(Internal::CloseStorage(crashed), WUPS_STORAGE_ERROR_SUCCESS);
+
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+    }
+
+    void TestTornFinalRecord() {
+        wups_storage_root_item root = CreateJournal("torn", 3);
+        auto journal                = ReadFile(GetFilePath("torn", ".journal"));
+        auto lines                  = SplitLines(journal);
+        CHECK(lines.size() == 4);
+        if (lines.size() != 4) {
+            CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+            return;
+        }
+
+        // Cut the last record at every possible position, including right before its line break.
+        size_t lastRecordStart = journal.size() - lines.back().size();
+        for (size_t cut = lastRecordStart + 1; cut < journal.size(); cut++) {
+            SimulateCrash("torn", "torn_crashed");
+            WriteFile(GetFilePath("torn_crashed", ".journal"), journal.substr(0, cut));
+            CheckRecovered("torn_crashed", 2);
+        }
+
+        // A garbage line without line break at the end is a torn record as well
+        SimulateCrash("torn", "torn_crashed");
+        WriteFile(GetFilePath("torn_crashed", ".journal"), journal + "DEADBEEF [\"s\",[],\"value\",7");
+        CheckRecovered("torn_crashed", 3);
+
+        // Cutting the journal between two records loses nothing but the missing records
+        SimulateCrash("torn", "torn_crashed");
+        WriteFile(GetFilePath("torn_crashed", ".journal"), journal.substr(0, lastRecordStart));
+        wups_storage_root_item crashed = nullptr;
+        CHECK_STATUS(Internal::OpenStorage("torn_crashed", crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, nullptr, "value") == 2);
+        CHECK_STATUS(Internal::CloseStorage(crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take("torn_crashed");
+
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+    }
+
+    void TestBadChecksumMidLog() {
+        wups_storage_root_item root = CreateJournal("checksum", 3);
+        auto journal                = ReadFile(GetFilePath("checksum", ".journal"));
+        auto lines                  = SplitLines(journal);
+        CHECK(lines.size() == 4);
+        if (lines.size() != 4) {
+            CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+            return;
+        }
+
+        // Flip one bit in every byte of the second record (checksum, separator and json). Replaying has to stop before
+        // it, the third record must not be applied either.
+        for (size_t pos = 0; pos + 1 < lines[2].size(); pos++) {
+            auto corrupted = lines;
+            corrupted[2][pos] ^= 0x01;
+            SimulateCrash("checksum", "checksum_crashed");
+            WriteFile(GetFilePath("checksum_crashed", ".journal"), corrupted[0] + corrupted[1] + corrupted[2] + corrupted[3]);
+            CheckRecovered("checksum_crashed", 1);
+        }
+
+        // Nothing is replayed without a valid header
+        for (size_t pos = 0; pos + 1 < lines[0].size(); pos++) {
+            auto corrupted = lines;
+            corrupted[0][pos] ^= 0x01;
+            SimulateCrash("checksum", "checksum_crashed");
+            WriteFile(GetFilePath("checksum_crashed", ".journal"), corrupted[0] + corrupted[1] + corrupted[2] + corrupted[3]);
+            CheckRecovered("checksum_crashed", 0);
+        }
+
+        // A record with a correct checksum over json that doesn't fit the tree is skipped, the rest still gets replayed
+        SimulateCrash("checksum", "checksum_crashed");
+        std::string unknownRecord = "[\"s\",[\"missing\"],\"value\",9]";
+        uint32_t checksum         = 0x811C9DC5;
+        for (auto c : unknownRecord) {
+            checksum = (checksum ^ (uint8_t) c) * 0x01000193;
+        }
+        char checksumString[10];
+        snprintf(checksumString, sizeof(checksumString), "%08X ", checksum);
+        WriteFile(GetFilePath("checksum_crashed", ".journal"), lines[0] + lines[1] + checksumString + unknownRecord + "\n" + lines[2] + lines[3]);
+        wups_storage_root_item crashed = nullptr;
+        CHECK_STATUS(Internal::OpenStorage("checksum_crashed", crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashed, nullptr, "value") == 3);
+        CHECK_STATUS(Internal::CloseStorage(crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take("checksum_crashed");
+
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+    }
+
+    void TestJournalOfOlderSnapshot() {
+        // The journal stores "value" = 1, the snapshot written afterwards "value" = 2 without a journal record
+        wups_storage_root_item root = CreateJournal("stale", 1);
+        auto journal                = ReadFile(GetFilePath("stale", ".journal"));
+        StoreU32(root, nullptr, "value", 2);
+        CHECK_STATUS(SaveStorage(root, true), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath("stale", ".journal")) == 0);
+
+        // Crash after writing the snapshot but before removing the journal, the journal must not roll back "value"
+        std::filesystem::copy_file(GetFilePath("stale", ".json"), GetFilePath("stale_crashed", ".json"), std::filesystem::copy_options::overwrite_existing);
+        WriteFile(GetFilePath("stale_crashed", ".journal"), journal);
+        CheckRecovered("stale_crashed", 2);
+
+        // A leftover journal which couldn't be removed gets replaced by the next journal
+        wups_storage_root_item crashed = nullptr;
+        CHECK_STATUS(Internal::OpenStorage("stale_crashed", crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        WriteFile(GetFilePath("stale_crashed", ".journal"), journal);
+        StoreU32(crashed, nullptr, "value", 3);
+        CHECK_STATUS(SaveStorage(crashed, false), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetFileSize(GetFilePath("stale_crashed", ".journal")) > 0);
+        SimulateCrash("stale_crashed", "stale_crashed_again");
+        wups_storage_root_item crashedAgain = nullptr;
+        CHECK_STATUS(Internal::OpenStorage("stale_crashed_again", crashedAgain), WUPS_STORAGE_ERROR_SUCCESS);
+        CHECK(GetU32(crashedAgain, nullptr, "value") == 3);
+        CHECK_STATUS(Internal::CloseStorage(crashedAgain), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take("stale_crashed_again");
+        CHECK_STATUS(Internal::CloseStorage(crashed), WUPS_STORAGE_ERROR_SUCCESS);
+        StorageCache::Take("stale_crashed");
+
+        CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+    }
+} // namespace
+
+int main() {
+    TestUtils::CreateTempPluginPath();
+
+    TestReplayAfterCrash();
+    TestTornFinalRecord();
+    TestBadChecksumMidLog();
+    TestJournalOfOlderSnapshot();
+
+    TestUtils::RemoveTempPluginPath();
+    return TestUtils::Finish("storage_journal_test");
+}
@@ -0,0 +1,178 @@
+#include "../common/TestUtils.h"
+#include "utils/storage/StorageCache.h"
+#include "utils/storage/StorageUtils.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Hammers multiple storage roots from multiple threads and checks that no update gets lost.
+ *
+ * Usage: storage_stress_test [--threads N] [--ops N]
+ *
+ * Every thread owns a sub item in one of the roots and keeps a model of the values it stored there. Besides
+ * getting, storing and deleting its own items, it reads the items of the other threads of the same root, saves the
+ * root and opens and closes a storage of its own. At the end every model is compared with the storage, before and
+ * after closing and reopening the roots from the files.
+ * The run is repeated with 1, 2, 4, ... threads on their own roots to show how the throughput scales, and with
+ * twice as many threads as roots for contention on the same root.
+ */
+namespace {
+    using namespace StorageUtils::API;
+
+    constexpr uint32_t KEYS_PER_THREAD = 64;
+    constexpr uint32_t NOT_STORED      = 0xFFFFFFFF;
+
+    std::string GetThreadKey(uint32_t thread) {
+        return "thread_" + std::to_string(thread);
+    }
+
+    std::string GetItemKey(uint32_t index) {
+        return "key_" + std::to_string(index);
+    }
+
+    // The owner is stored in the upper bits, so readers of other threads can check that they got a consistent value.
+    uint32_t GetValue(uint32_t thread, uint32_t counter) {
+        return (thread << 24) | (counter & 0xFFFFFF);
+    }
+
+    void CheckModel(wups_storage_root_item root, uint32_t thread, const std::vector<uint32_t> &model) {
+        wups_storage_item subItem = nullptr;
+        CHECK_STATUS(GetSubItem(root, nullptr, GetThreadKey(thread).c_str(), &subItem), WUPS_STORAGE_ERROR_SUCCESS);
+        for (uint32_t i = 0; i < KEYS_PER_THREAD; i++) {
+            uint32_t value = 0;
+            auto res       = GetItem(root, subItem, GetItemKey(i).c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value), nullptr);
+            if (model[i] == NOT_STORED) {
+                CHECK_STATUS(res, WUPS_STORAGE_ERROR_NOT_FOUND);
+            } else {
+                CHECK_STATUS(res, WUPS_STORAGE_ERROR_SUCCESS);
+                CHECK(value == model[i]);
+            }
+        }
+    }
+
+    void Worker(wups_storage_root_item root, uint32_t thread, uint32_t rootCount, uint32_t threadCount, uint32_t opCount, std::vector<uint32_t> &model) {
+        std::mt19937 rng(thread);
+        wups_storage_item subItem = nullptr;
+        CHECK_STATUS(CreateSubItem(root, nullptr, GetThreadKey(thread).c_str(), &subItem), WUPS_STORAGE_ERROR_SUCCESS);
+
+        for (uint32_t op = 0; op < opCount; op++) {
+            uint32_t index = rng() % KEYS_PER_THREAD;
+            auto key       = GetItemKey(index);
+            uint32_t kind  = rng() % 100;
+            if (kind < 50) {
+                uint32_t value = 0;
+                auto res       = GetItem(root, subItem, key.c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value), nullptr);
+                CHECK_STATUS(res, model[index] == NOT_STORED ? WUPS_STORAGE_ERROR_NOT_FOUND : WUPS_STORAGE_ERROR_SUCCESS);
+                CHECK(res != WUPS_STORAGE_ERROR_SUCCESS || value == model[index]);
+            } else if (kind < 80) {
+                uint32_t value = GetValue(thread, op);
+                CHECK_STATUS(StoreItem(root, subItem, key.c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value)), WUPS_STORAGE_ERROR_SUCCESS);
+                model[index] = value;
+            } else if (kind < 85) {
+                CHECK_STATUS(DeleteItem(root, subItem, key.c_str()), model[index] == NOT_STORED ? WUPS_STORAGE_ERROR_NOT_FOUND : WUPS_STORAGE_ERROR_SUCCESS);
+                model[index] = NOT_STORED;
+            } else if (kind < 95) {
+                // Threads with the same thread % rootCount share the root
+                uint32_t other              = rng() % threadCount;
+                wups_storage_item otherItem = nullptr;
+                uint32_t value              = 0;
+                if (other != thread && other % rootCount == thread % rootCount &&
+                    GetSubItem(root, nullptr, GetThreadKey(other).c_str(), &otherItem) == WUPS_STORAGE_ERROR_SUCCESS &&
+                    GetItem(root, otherItem, key.c_str(), WUPS_STORAGE_ITEM_U32, &value, sizeof(value), nullptr) == WUPS_STORAGE_ERROR_SUCCESS) {
+                    CHECK((value >> 24) == other);
+                }
+            } else if (kind < 99) {
+                CHECK_STATUS(SaveStorage(root, false), WUPS_STORAGE_ERROR_SUCCESS);
+            } else {
+                // Opening and closing roots takes the global lock
+                wups_storage_root_item scratch = nullptr;
+                CHECK_STATUS(Internal::OpenStorage("scratch_" + std::to_string(thread), scratch), WUPS_STORAGE_ERROR_SUCCESS);
+                uint32_t value = op;
+                CHECK_STATUS(StoreItem(scratch, nullptr, "op", WUPS_STORAGE_ITEM_U32, &value, sizeof(value)), WUPS_STORAGE_ERROR_SUCCESS);
+                CHECK_STATUS(Internal::CloseStorage(scratch), WUPS_STORAGE_ERROR_SUCCESS);
+            }
+        }
+    }
+
+    /**
+     * Returns the operations per second of the workers.
+     */
+    double RunStress(uint32_t threadCount, uint32_t rootCount, uint32_t opCount) {
+        std::vector<wups_storage_root_item> roots(rootCount);
+        std::vector<std::string> rootIds(rootCount);
+        static uint32_t sRun = 0;
+        sRun++;
+        for (uint32_t i = 0; i < rootCount; i++) {
+            rootIds[i] = "stress_" + std::to_string(sRun) + "_" + std::to_string(i);
+            CHECK_STATUS(Internal::OpenStorage(rootIds[i], roots[i]), WUPS_STORAGE_ERROR_SUCCESS);
+        }
+
+        std::vector<std::vector<uint32_t>> models(threadCount, std::vector<uint32_t>(KEYS_PER_THREAD, NOT_STORED));
+        TestUtils::Stopwatch watch;
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++) {
+            threads.emplace_back(Worker, roots[t % rootCount], t, rootCount, threadCount, opCount, std::ref(models[t]));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double opsPerSecond = (double) threadCount * opCount / ((double) watch.elapsedNs() / 1e9);
+
+        for (uint32_t t = 0; t < threadCount; t++) {
+            CheckModel(roots[t % rootCount], t, models[t]);
+        }
+
+        // Everything has to survive closing and loading the roots from the files again
+        for (uint32_t i = 0; i < rootCount; i++) {
+            CHECK_STATUS(Internal::CloseStorage(roots[i]), WUPS_STORAGE_ERROR_SUCCESS);
+            StorageCache::Take(rootIds[i]);
+            CHECK_STATUS(Internal::OpenStorage(rootIds[i], roots[i]), WUPS_STORAGE_ERROR_SUCCESS);
+        }
+        for (uint32_t t = 0; t < threadCount; t++) {
+            CheckModel(roots[t % rootCount], t, models[t]);
+        }
+        for (auto root : roots) {
+            CHECK_STATUS(Internal::CloseStorage(root), WUPS_STORAGE_ERROR_SUCCESS);
+        }
+        return opsPerSecond;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    uint32_t maxThreads = 8;
+    uint32_t opCount    = 20000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--threads") == 0) {
+            maxThreads = std::max<uint32_t>(strtoul(argv[i + 1], nullptr, 10), 2);
+        } else if (strcmp(argv[i], "--ops") == 0) {
+            opCount = strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            printf("Usage: %s [--threads N] [--ops N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TestUtils::CreateTempPluginPath();
+
+    // Warm up the allocator and the file system cache
+    RunStress(1, 1, opCount / 10);
+
+    printf("one root per thread (%u hardware threads)\n", std::thread::hardware_concurrency());
+    double base = 0;
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double opsPerSecond = RunStress(threads, threads, opCount);
+        if (threads == 1) {
+            base = opsPerSecond;
+        }
+        printf("  %2u threads: %10.0f ops/s (%.2fx)\n", threads, opsPerSecond, opsPerSecond / base);
+    }
+    printf("two threads per root\n");
+    printf("  %2u threads: %10.0f ops/s\n", maxThreads, RunStress(maxThreads, maxThreads / 2, opCount));
+
+    TestUtils::RemoveTempPluginPath();
+    return TestUtils::Finish("storage_stress_test");
+}